@@ -35,6 +35,13 @@
 #define IS_COMMAND() (get_mods() == MOD_MASK_CTRL)
 
 #define ACHORDION_STREAK
+// Estimate the streak timeout from recent typing speed.
+#define ACHORDION_STREAK_ADAPTIVE
+// Count Achordion decisions per key, for tools/achordion_heatmap.py.
+// #define ACHORDION_STATS
+
+// Track how late scheduled tasks run, printed to the console once a minute.
+// #define SCHEDULER_STATS
 
 // Activate UPPER CASE WORD by double tapping Left Shift
 #define DOUBLE_TAP_SHIFT_TURNS_ON_CAPS_WORD
@@ -42,6 +49,16 @@
 // #define CAPS_WORD_INVERT_ON_SHIFT
 // When idle, turn off Caps Word after 5 seconds.
 #define CAPS_WORD_IDLE_TIMEOUT 3000
+// Caps Word shifts letters and continues on digits, Backspace, Delete, and _,
+// but - ends the word. Macros are classified in getreuer.c.
+// clang-format off
+#define CAPS_WORD_KEY_CLASSES                                              \
+  [KC_A ... KC_Z] = CAPS_WORD_CLASS(CAPS_WORD_SHIFT, CAPS_WORD_SHIFT),     \
+  [KC_1 ... KC_0] = CAPS_WORD_CLASS(CAPS_WORD_CONTINUE, CAPS_WORD_STOP),   \
+  [KC_MINS]       = CAPS_WORD_CLASS(CAPS_WORD_STOP, CAPS_WORD_CONTINUE),   \
+  [KC_BSPC]       = CAPS_WORD_CLASS(CAPS_WORD_CONTINUE, CAPS_WORD_STOP),   \
+  [KC_DEL]        = CAPS_WORD_CLASS(CAPS_WORD_CONTINUE, CAPS_WORD_STOP)
+// clang-format on
 
 // Don't apply custom shift keys with mods other than Shift.
 // #define CUSTOM_SHIFT_KEYS_NEGMODS ~MOD_MASK_SHIFT
@@ -54,6 +71,20 @@
 
 // When idle, turn off Sentence Case after 2 seconds.
 #define SENTENCE_CASE_TIMEOUT 2000
+// clang-format off
+#define SENTENCE_CASE_KEY_CLASSES                                          \
+  [KC_A ... KC_Z]       = SENTENCE_CASE_CLASS('a', 'a'),  /* Letters. */   \
+  /* Both . and Shift . punctuate sentence endings, as do ! ? and Shift , */ \
+  [KC_DOT]              = SENTENCE_CASE_CLASS('.', '.'),                   \
+  [KC_1]                = SENTENCE_CASE_CLASS('#', '.'),                   \
+  [KC_SLSH]             = SENTENCE_CASE_CLASS('#', '.'),                   \
+  [KC_COMM]             = SENTENCE_CASE_CLASS('#', '.'),                   \
+  [KC_2 ... KC_0]       = SENTENCE_CASE_CLASS('#', '#'),  /* 2-0 @-) */    \
+  [KC_MINS ... KC_SCLN] = SENTENCE_CASE_CLASS('#', '#'),  /* - = [ ] ; */  \
+  [KC_GRV]              = SENTENCE_CASE_CLASS('#', '#'),  /* ` ~ */        \
+  [KC_SPC]              = SENTENCE_CASE_CLASS(' ', ' '),                   \
+  [KC_QUOT]             = SENTENCE_CASE_CLASS('\'', '\''), /* ' " */
+// clang-format on
 
 // Enable all effects and palettes in PaletteFx.
 #define PALETTEFX_ENABLE_ALL_EFFECTS
@@ -22,6 +22,10 @@
 
 #include "achordion.h"
 
+#ifdef SCHEDULER_ENABLE
+#include "scheduler.h"
+#endif  // SCHEDULER_ENABLE
+
 #if !defined(IS_QK_MOD_TAP)
 // Attempt to detect out-of-date QMK installation, which would fail with
 // implicit-function-declaration errors in the code below.
@@ -39,8 +43,24 @@ static uint8_t eager_mods = 0;
 static bool pressed_another_key_before_release = false;
 
 #ifdef ACHORDION_STREAK
+#define MAX_STREAK_TIMEOUT 800
 // Timer for typing streak
 static uint16_t streak_timer = 0;
+
+#ifdef ACHORDION_STREAK_ADAPTIVE
+#if ACHORDION_STREAK_ADAPTIVE_MAX_MS > MAX_STREAK_TIMEOUT
+#error "ACHORDION_STREAK_ADAPTIVE_MAX_MS must be at most 800 ms."
+#endif
+// Ring buffer of recent spans in ms from a key press to the press after next,
+// which is what the streak timeout bounds: from the key before a tap-hold key
+// to the key after it.
+static uint16_t typing_intervals[ACHORDION_STREAK_ADAPTIVE_SAMPLES];
+static uint8_t typing_intervals_len = 0;
+static uint8_t typing_intervals_next = 0;
+// Times of the last two key presses, 0 when unset.
+static uint16_t last_press_time = 0;
+static uint16_t prev_press_time = 0;
+#endif  // ACHORDION_STREAK_ADAPTIVE
 #else
 // When disabled, is_streak is never true
 #define is_streak false
@@ -56,24 +76,192 @@ enum {
   STATE_TAPPING,
   // Active tap-hold key has been settled as held.
   STATE_HOLDING,
-  // This state is set while calling `process_record()`, which will recursively
-  // call `process_achordion()`. This state is checked so that we don't process
-  // events generated by Achordion and potentially create an infinite loop.
-  STATE_RECURSING,
 };
 static uint8_t achordion_state = STATE_RELEASED;
 
+#ifdef ACHORDION_STATS
+// Decision counters for one tap-hold key position.
+typedef struct {
+  keypos_t key;
+  uint16_t counts[ACHORDION_NUM_STATS];
+} stats_entry_t;
+static stats_entry_t stats[ACHORDION_STATS_SIZE];
+static uint8_t stats_len = 0;
+// Position of the last hold and, once the hold key is released, the time until
+// which a Backspace counts the hold as a likely misfire. While the hold is
+// active, the timer is unset, so that Backspace with the mod (e.g. Ctrl +
+// Backspace) isn't mistaken for one.
+static keypos_t last_hold_key;
+static uint16_t last_hold_timer = 0;
+
+// Increments counter `stat` for the key at `key`. The counter saturates rather
+// than wraps. If the table is full, keys not already in it are not counted.
+static void stats_count(keypos_t key, uint8_t stat) {
+  stats_entry_t* entry = NULL;
+  for (uint8_t i = 0; i < stats_len; ++i) {
+    if (stats[i].key.row == key.row && stats[i].key.col == key.col) {
+      entry = &stats[i];
+      break;
+    }
+  }
+  if (entry == NULL) {
+    if (stats_len >= ACHORDION_STATS_SIZE) {
+      return;  // Table is full.
+    }
+    entry = &stats[stats_len++];
+    memset(entry, 0, sizeof(stats_entry_t));
+    entry->key = key;
+  }
+  if (entry->counts[stat] < UINT16_MAX) {
+    ++entry->counts[stat];
+  }
+}
+
+// Tap keycode of mod-tap or layer-tap key `keycode`.
+static uint16_t tap_hold_tap_keycode(uint16_t keycode) {
+  return IS_QK_LAYER_TAP(keycode) ? QK_LAYER_TAP_GET_TAP_KEYCODE(keycode)
+                                  : QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+}
+
+// Called when the hold key at `key` is released. Starts the window in which a
+// Backspace counts the hold as a misfire.
+static void stats_arm_misfire(keypos_t key, uint16_t time) {
+  if (last_hold_key.row == key.row && last_hold_key.col == key.col) {
+    // We use 0 to represent an unset timer, so `| 1` to force a nonzero value.
+    last_hold_timer = (time + ACHORDION_STATS_MISFIRE_MS) | 1;
+  }
+}
+
+// Called on presses. If `tap_keycode` is Backspace and soon after the release
+// of the last hold, the hold is counted as a misfire.
+static void stats_check_misfire(uint16_t tap_keycode, uint16_t time) {
+  if (last_hold_timer && tap_keycode == KC_BSPC) {
+    if (!timer_expired(time, last_hold_timer)) {
+      dprintln("Achordion: Backspace after hold, counting as misfire.");
+      stats_count(last_hold_key, ACHORDION_STAT_MISFIRE);
+    }
+    last_hold_timer = 0;
+  }
+}
+#else
+#define stats_count(key, stat)
+#define stats_arm_misfire(key, time)
+#define stats_check_misfire(tap_keycode, time)
+#endif  // ACHORDION_STATS
+
+#ifdef SCHEDULER_ENABLE
+// Wakes `achordion_task()` by the earliest of the running timers.
+static void schedule_task(void) {
+  if (achordion_state == STATE_UNSETTLED) {
+    scheduler_wake_at(SCHEDULER_TASK_ACHORDION, achordion_task, hold_timer);
+  }
+#ifdef ACHORDION_STATS
+  if (last_hold_timer) {
+    scheduler_wake_at(SCHEDULER_TASK_ACHORDION, achordion_task,
+                      last_hold_timer);
+  }
+#endif  // ACHORDION_STATS
+#ifdef ACHORDION_STREAK
+  if (streak_timer) {
+    scheduler_wake_at(SCHEDULER_TASK_ACHORDION, achordion_task,
+                      streak_timer + MAX_STREAK_TIMEOUT);
+  }
+#endif  // ACHORDION_STREAK
+}
+#else
+#define schedule_task()
+#endif  // SCHEDULER_ENABLE
+
 #ifdef ACHORDION_STREAK
 static void update_streak_timer(uint16_t keycode, keyrecord_t* record) {
   if (achordion_streak_continue(keycode)) {
     // We use 0 to represent an unset timer, so `| 1` to force a nonzero value.
     streak_timer = record->event.time | 1;
+    schedule_task();
   } else {
     streak_timer = 0;
   }
 }
+
+#ifdef ACHORDION_STREAK_ADAPTIVE
+// Records the span since the press before the previous one. Spans longer than
+// MAX_STREAK_TIMEOUT include a pause rather than typing, and are not recorded.
+static void update_typing_intervals(uint16_t keycode, keyrecord_t* record) {
+  if (!achordion_streak_continue(keycode)) {
+    last_press_time = prev_press_time = 0;
+    return;
+  }
+
+  const uint16_t time = record->event.time;
+  if (prev_press_time) {
+    const uint16_t interval = time - prev_press_time;
+    if (interval < MAX_STREAK_TIMEOUT) {
+      typing_intervals[typing_intervals_next] = interval;
+      typing_intervals_next =
+          (typing_intervals_next + 1) % ACHORDION_STREAK_ADAPTIVE_SAMPLES;
+      if (typing_intervals_len < ACHORDION_STREAK_ADAPTIVE_SAMPLES) {
+        ++typing_intervals_len;
+      }
+    }
+  }
+  prev_press_time = last_press_time;
+  // We use 0 to represent an unset timer, so `| 1` to force a nonzero value.
+  last_press_time = time | 1;
+}
+
+// Sorts a small array in place with insertion sort.
+static void sort_intervals(uint16_t* values, uint8_t len) {
+  for (uint8_t i = 1; i < len; ++i) {
+    const uint16_t value = values[i];
+    uint8_t j = i;
+    for (; j > 0 && values[j - 1] > value; --j) {
+      values[j] = values[j - 1];
+    }
+    values[j] = value;
+  }
+}
+
+// Estimates the longest span from a press to the press after next that is
+// still "typing" as the median span plus a multiple of the median absolute
+// deviation (MAD), which unlike the mean and standard deviation are not thrown
+// off by the odd hesitation, clamped to [ACHORDION_STREAK_ADAPTIVE_MIN_MS,
+// ACHORDION_STREAK_ADAPTIVE_MAX_MS]. Returns 0 if there are too few samples
+// for an estimate.
+static uint16_t typing_interval_bound(void) {
+  if (typing_intervals_len < ACHORDION_STREAK_ADAPTIVE_MIN_SAMPLES) {
+    return 0;
+  }
+
+  uint16_t values[ACHORDION_STREAK_ADAPTIVE_SAMPLES];
+  const uint8_t len = typing_intervals_len;
+  memcpy(values, typing_intervals, len * sizeof(uint16_t));
+  sort_intervals(values, len);
+  const uint16_t median = values[len / 2];
+
+  for (uint8_t i = 0; i < len; ++i) {
+    values[i] = (values[i] > median) ? values[i] - median : median - values[i];
+  }
+  sort_intervals(values, len);
+  const uint16_t mad = values[len / 2];
+
+  uint16_t bound = median + ACHORDION_STREAK_ADAPTIVE_MAD_SCALE * mad;
+  if (bound < ACHORDION_STREAK_ADAPTIVE_MIN_MS) {
+    bound = ACHORDION_STREAK_ADAPTIVE_MIN_MS;
+  } else if (bound > ACHORDION_STREAK_ADAPTIVE_MAX_MS) {
+    bound = ACHORDION_STREAK_ADAPTIVE_MAX_MS;
+  }
+  return bound;
+}
+#endif  // ACHORDION_STREAK_ADAPTIVE
 #endif
 
+// Converts a 5-bit mod mask, as used in mod-tap keycodes and `MOD_*` values,
+// to the 8-bit mod bits of get_mods(). In the 5-bit form, bit 4 means that the
+// mods in bits 0-3 are the right-hand ones, which in 8 bits sit 4 bits higher.
+static uint8_t mod_mask_to_bits(uint8_t mods) {
+  return (mods & 0x10) ? (mods & 0x0f) << 4 : mods;
+}
+
 // Presses or releases eager_mods through process_action(), which skips the
 // usual event handling pipeline. The action is considered as a mod-tap hold or
 // release, with Retro Tapping if enabled.
@@ -84,21 +272,20 @@ static void process_eager_mods_action(void) {
   process_action(&tap_hold_record, action);
 }
 
-// Calls `process_record()` with state set to RECURSING.
-static void recursively_process_record(keyrecord_t* record, uint8_t state) {
-  achordion_state = STATE_RECURSING;
-#if defined(POINTING_DEVICE_ENABLE) && defined(POINTING_DEVICE_AUTO_MOUSE_ENABLE)
-  int8_t mouse_key_tracker = get_auto_mouse_key_tracker();
-#endif
-  process_record(record);
-#if defined(POINTING_DEVICE_ENABLE) && defined(POINTING_DEVICE_AUTO_MOUSE_ENABLE)
-  set_auto_mouse_key_tracker(mouse_key_tracker);
-#endif
-  achordion_state = state;
+// Queues `record` to be plumbed through `process_record()` once the current
+// event is done. The event is queued with source ACHORDION so that
+// `process_achordion()` lets it pass.
+static bool plumb_record(const keyrecord_t* record, uint8_t delay_ms) {
+  return event_queue_push(record, EVENT_QUEUE_SOURCE_ACHORDION, 0, 0,
+                          delay_ms);
 }
 
 // Sends hold press event and settles the active tap-hold key as held.
 static void settle_as_hold(void) {
+#ifdef ACHORDION_STATS
+  last_hold_key = tap_hold_record.event.key;
+  last_hold_timer = 0;  // Armed on release, by `stats_arm_misfire()`.
+#endif  // ACHORDION_STATS
   if (eager_mods) {
     // If eager mods are being applied, nothing needs to be done besides
     // updating the state.
@@ -107,48 +294,59 @@ static void settle_as_hold(void) {
   } else {
     // Create hold press event.
     dprintln("Achordion: Plumbing hold press.");
-    recursively_process_record(&tap_hold_record, STATE_HOLDING);
+    plumb_record(&tap_hold_record, 0);
+    achordion_state = STATE_HOLDING;
   }
 }
 
 // Sends tap press and release and settles the active tap-hold key as tapped.
 static void settle_as_tap(void) {
   if (eager_mods) {  // Clear eager mods if set.
+    if ((eager_mods & (MOD_LALT | MOD_LGUI)) == 0 &&
+        QK_MOD_TAP_GET_TAP_KEYCODE(tap_hold_keycode) != KC_NO) {
+      // Fast path: Shift and Ctrl don't need neutralizing, so clear the mods
+      // without sending a report. The tap press report that follows carries
+      // the mods release, saving a report.
+      dprintln("Achordion: Clearing eager mods with tap press.");
+      del_mods(mod_mask_to_bits(eager_mods));
+    } else {
 #if defined(RETRO_TAPPING) || defined(RETRO_TAPPING_PER_KEY)
 #ifdef DUMMY_MOD_NEUTRALIZER_KEYCODE
-    neutralize_flashing_modifiers(get_mods());
+      neutralize_flashing_modifiers(get_mods());
 #endif  // DUMMY_MOD_NEUTRALIZER_KEYCODE
 #endif  // defined(RETRO_TAPPING) || defined(RETRO_TAPPING_PER_KEY)
-    tap_hold_record.event.pressed = false;
-    // To avoid falsely triggering Retro Tapping, process eager mods release as
-    // a regular mods release rather than a mod-tap release.
-    action_t action;
-    action.code = ACTION_MODS(eager_mods);
-    process_action(&tap_hold_record, action);
+      tap_hold_record.event.pressed = false;
+      // To avoid falsely triggering Retro Tapping, process eager mods release
+      // as a regular mods release rather than a mod-tap release.
+      action_t action;
+      action.code = ACTION_MODS(eager_mods);
+      process_action(&tap_hold_record, action);
+    }
     eager_mods = 0;
   }
 
   dprintln("Achordion: Plumbing tap press.");
+  stats_check_misfire(tap_hold_tap_keycode(tap_hold_keycode), timer_read());
   tap_hold_record.event.pressed = true;
   tap_hold_record.tap.count = 1;  // Revise event as a tap.
   tap_hold_record.tap.interrupted = true;
-  // Plumb tap press event.
-  recursively_process_record(&tap_hold_record, STATE_TAPPING);
-
-  send_keyboard_report();
-#if TAP_CODE_DELAY > 0
-  wait_ms(TAP_CODE_DELAY);
-#endif  // TAP_CODE_DELAY > 0
+  // Plumb tap press event. If the queue has no room for it, the tap is lost,
+  // and the release is skipped with it.
+  const bool queued = plumb_record(&tap_hold_record, 0);
 
-  dprintln("Achordion: Plumbing tap release.");
   tap_hold_record.event.pressed = false;
-  // Plumb tap release event.
-  recursively_process_record(&tap_hold_record, STATE_TAPPING);
+  if (queued) {
+    dprintln("Achordion: Plumbing tap release.");
+    // Plumb tap release event, delayed so that the press is sent in its own
+    // report rather than blocking in `wait_ms()`.
+    plumb_record(&tap_hold_record, TAP_CODE_DELAY);
+  }
+  achordion_state = STATE_TAPPING;
 }
 
 bool process_achordion(uint16_t keycode, keyrecord_t* record) {
   // Don't process events that Achordion generated.
-  if (achordion_state == STATE_RECURSING) {
+  if (event_queue_source() == EVENT_QUEUE_SOURCE_ACHORDION) {
     return true;
   }
 
@@ -158,6 +356,22 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
   // Check that this is a normal key event, don't act on combos.
   const bool is_key_event = IS_KEYEVENT(record->event);
 
+#ifdef ACHORDION_STATS
+  // Tap-hold keys that are not yet settled as tapped are checked later, when
+  // they are settled as tapped in `settle_as_tap()`.
+  if (record->event.pressed && (!is_tap_hold || record->tap.count)) {
+    stats_check_misfire(
+        is_tap_hold ? tap_hold_tap_keycode(keycode) : keycode,
+        record->event.time);
+  }
+#endif  // ACHORDION_STATS
+
+#ifdef ACHORDION_STREAK_ADAPTIVE
+  if (record->event.pressed && is_key_event) {
+    update_typing_intervals(keycode, record);
+  }
+#endif  // ACHORDION_STREAK_ADAPTIVE
+
   // Event while no tap-hold key is active.
   if (achordion_state == STATE_RELEASED) {
     if (is_tap_hold && record->tap.count == 0 && record->event.pressed &&
@@ -170,6 +384,7 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
         tap_hold_keycode = keycode;
         tap_hold_record = *record;
         hold_timer = record->event.time + timeout;
+        schedule_task();
         pressed_another_key_before_release = false;
         eager_mods = 0;
 
@@ -185,6 +400,7 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
               achordion_eager_mod(mod)) {
             eager_mods = mod;
             process_eager_mods_action();
+            stats_count(record->event.key, ACHORDION_STAT_EAGER);
           }
         }
 
@@ -205,6 +421,10 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
 
   // Release of the active tap-hold key.
   if (keycode == tap_hold_keycode && !record->event.pressed) {
+    if (achordion_state == STATE_HOLDING) {
+      stats_arm_misfire(record->event.key, record->event.time);
+      schedule_task();
+    }
     if (eager_mods) {
       dprintln("Achordion: Key released. Clearing eager mods.");
       tap_hold_record.event.pressed = false;
@@ -213,14 +433,14 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
       dprintln("Achordion: Key released. Plumbing hold release.");
       tap_hold_record.event.pressed = false;
       // Plumb hold release event.
-      recursively_process_record(&tap_hold_record, STATE_RELEASED);
+      plumb_record(&tap_hold_record, 0);
     } else if (!pressed_another_key_before_release) {
       // No other key was pressed between the press and release of the tap-hold
       // key, plumb a hold press and then a release.
       dprintln("Achordion: Key released. Plumbing hold press and release.");
-      recursively_process_record(&tap_hold_record, STATE_HOLDING);
+      plumb_record(&tap_hold_record, 0);
       tap_hold_record.event.pressed = false;
-      recursively_process_record(&tap_hold_record, STATE_RELEASED);
+      plumb_record(&tap_hold_record, 0);
     } else {
       dprintln("Achordion: Key released.");
     }
@@ -232,8 +452,17 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
 
   if (achordion_state == STATE_UNSETTLED && record->event.pressed) {
 #ifdef ACHORDION_STREAK
-    const uint16_t s_timeout =
+    uint16_t s_timeout =
         achordion_streak_chord_timeout(tap_hold_keycode, keycode);
+#ifdef ACHORDION_STREAK_ADAPTIVE
+    // With enough samples, use the typical span of recent typing instead,
+    // shorter or longer than configured. A zero timeout still disables the
+    // streak.
+    const uint16_t bound = typing_interval_bound();
+    if (bound && s_timeout) {
+      s_timeout = bound;
+    }
+#endif  // ACHORDION_STREAK_ADAPTIVE
     const bool is_streak =
         streak_timer && s_timeout &&
         !timer_expired(record->event.time, (streak_timer + s_timeout));
@@ -241,6 +470,19 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
 
     // Press event occurred on a key other than the active tap-hold key.
 
+    if (!is_streak && !is_key_event) {
+      // A combo was triggered while the tap-hold key is unsettled. QMK's combo
+      // engine has already resolved the combo from its own buffer of keys, so
+      // there is nothing left to decide: settle as held. The hold press is
+      // queued first, then the combo event behind it. When this event is
+      // itself being dispatched from the queue, both go in front of the
+      // pending events, so nothing gets between the hold and the combo.
+      stats_count(tap_hold_record.event.key, ACHORDION_STAT_HOLD_COMBO);
+      settle_as_hold();
+      plumb_record(record, 0);
+      return false;
+    }
+
     // If the other key is *also* a tap-hold key and considered by QMK to be
     // held, then we settle the active key as held. This way, things like
     // chording multiple home row modifiers will work, but let's our logic
@@ -252,9 +494,10 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
     // user code can see them. This is done by calling `process_record()`, which
     // in turn calls most handlers including `process_record_user()`.
     if (!is_streak &&
-        (!is_key_event || (is_tap_hold && record->tap.count == 0) ||
+        ((is_tap_hold && record->tap.count == 0) ||
          achordion_chord(tap_hold_keycode, &tap_hold_record, keycode,
                          record))) {
+      stats_count(tap_hold_record.event.key, ACHORDION_STAT_HOLD_CHORD);
       settle_as_hold();
 
 #ifdef REPEAT_KEY_ENABLE
@@ -268,6 +511,9 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
       }
 #endif  // REPEAT_KEY_ENABLE
     } else {
+      stats_count(tap_hold_record.event.key,
+                  is_streak ? ACHORDION_STAT_TAP_STREAK
+                            : ACHORDION_STAT_TAP_CHORD);
       settle_as_tap();
 
 #ifdef ACHORDION_STREAK
@@ -281,13 +527,14 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
         tap_hold_record = *record;
         hold_timer = record->event.time + timeout;
         achordion_state = STATE_UNSETTLED;
+        schedule_task();
         pressed_another_key_before_release = false;
         return false;
       }
 #endif
     }
 
-    recursively_process_record(record, achordion_state);  // Re-process event.
+    plumb_record(record, 0);  // Re-process event.
     return false;  // Block the original event.
   }
 
@@ -301,17 +548,52 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
 void achordion_task(void) {
   if (achordion_state == STATE_UNSETTLED &&
       timer_expired(timer_read(), hold_timer)) {
+    stats_count(tap_hold_record.event.key, ACHORDION_STAT_HOLD_TIMEOUT);
     settle_as_hold();  // Timeout expired, settle the key as held.
   }
 
+#ifdef ACHORDION_STATS
+  if (last_hold_timer && timer_expired(timer_read(), last_hold_timer)) {
+    last_hold_timer = 0;  // Expired.
+  }
+#endif  // ACHORDION_STATS
+
 #ifdef ACHORDION_STREAK
-#define MAX_STREAK_TIMEOUT 800
   if (streak_timer &&
       timer_expired(timer_read(), (streak_timer + MAX_STREAK_TIMEOUT))) {
     streak_timer = 0;  // Expired.
   }
 #endif
+
+  schedule_task();  // Wake again for timers still running.
+}
+
+#ifdef ACHORDION_STATS
+bool achordion_stats_get(uint8_t index, keypos_t* key, uint16_t* counts) {
+  if (index >= stats_len) {
+    return false;
+  }
+  *key = stats[index].key;
+  memcpy(counts, stats[index].counts, sizeof(stats[index].counts));
+  return true;
+}
+
+void achordion_stats_clear(void) {
+  stats_len = 0;
+  last_hold_timer = 0;
+}
+
+void achordion_stats_print(void) {
+  for (uint8_t i = 0; i < stats_len; ++i) {
+    const stats_entry_t* entry = &stats[i];
+    dprintf("achordion_stats %u %u", entry->key.row, entry->key.col);
+    for (uint8_t j = 0; j < ACHORDION_NUM_STATS; ++j) {
+      dprintf(" %u", entry->counts[j]);
+    }
+    dprint("\n");
+  }
 }
+#endif  // ACHORDION_STATS
 
 // Returns true if `pos` on the left hand of the keyboard, false if right.
 static bool on_left_hand(keypos_t pos) {
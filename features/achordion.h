@@ -44,6 +44,10 @@
  * still possible to use these features and Achordion in your keymap, but beware
  * they might behave poorly when used simultaneously with tap-hold keys.
  *
+ * Achordion plumbs its events through the event queue (features/event_queue.c)
+ * rather than by recursively calling `process_record()`. The queue must be
+ * enabled, and its handler and task must be called as shown below.
+ *
  *
  * For full documentation, see
  * <https://getreuer.info/posts/keyboards/achordion>
@@ -52,6 +56,7 @@
 #pragma once
 
 #include "quantum.h"
+#include "event_queue.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -65,6 +70,7 @@ extern "C" {
  *     #include "features/achordion.h"
  *
  *     bool process_record_user(uint16_t keycode, keyrecord_t* record) {
+ *       if (!process_event_queue(keycode, record)) { return false; }
  *       if (!process_achordion(keycode, record)) { return false; }
  *       // Your macros...
  *       return true;
@@ -79,7 +85,11 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record);
  *
  *     void housekeeping_task_user(void) {
  *       achordion_task();
+ *       event_queue_task();
  *     }
+ *
+ * With `SCHEDULER_ENABLE`, call `scheduler_task()` instead, which calls this
+ * only when one of Achordion's timers is due (see scheduler.h).
  */
 void achordion_task(void);
 
@@ -188,6 +198,114 @@ bool achordion_streak_continue(uint16_t keycode);
 uint16_t achordion_streak_timeout(uint16_t tap_hold_keycode);
 #endif
 
+/**
+ * Additionally define ACHORDION_STREAK_ADAPTIVE to estimate the streak timeout
+ * from your own recent typing rather than fixed timeouts:
+ *
+ *    #define ACHORDION_STREAK
+ *    #define ACHORDION_STREAK_ADAPTIVE
+ *
+ * The streak timeout bounds the time from the key pressed before a tap-hold key
+ * to the key pressed after it. Achordion keeps the last
+ * ACHORDION_STREAK_ADAPTIVE_SAMPLES such spans from recent typing, skipping
+ * pauses, and estimates a bound as the median span plus
+ * ACHORDION_STREAK_ADAPTIVE_MAD_SCALE times the median absolute deviation,
+ * clamped to between ACHORDION_STREAK_ADAPTIVE_MIN_MS and
+ * ACHORDION_STREAK_ADAPTIVE_MAX_MS (at most 800).
+ *
+ * The estimate replaces the timeout from `achordion_streak_chord_timeout()`
+ * in both directions: a fast typist gets a shorter timeout, and a slower one
+ * a longer timeout, for all keys alike. Returning 0 from the callback still
+ * disables streak detection for that pair of keys. Until there are
+ * ACHORDION_STREAK_ADAPTIVE_MIN_SAMPLES samples, the configured timeout is
+ * used.
+ */
+#ifdef ACHORDION_STREAK_ADAPTIVE
+#ifndef ACHORDION_STREAK_ADAPTIVE_SAMPLES
+#define ACHORDION_STREAK_ADAPTIVE_SAMPLES 8
+#endif  // ACHORDION_STREAK_ADAPTIVE_SAMPLES
+#ifndef ACHORDION_STREAK_ADAPTIVE_MIN_SAMPLES
+#define ACHORDION_STREAK_ADAPTIVE_MIN_SAMPLES 4
+#endif  // ACHORDION_STREAK_ADAPTIVE_MIN_SAMPLES
+#ifndef ACHORDION_STREAK_ADAPTIVE_MAD_SCALE
+#define ACHORDION_STREAK_ADAPTIVE_MAD_SCALE 3
+#endif  // ACHORDION_STREAK_ADAPTIVE_MAD_SCALE
+#ifndef ACHORDION_STREAK_ADAPTIVE_MIN_MS
+#define ACHORDION_STREAK_ADAPTIVE_MIN_MS 60
+#endif  // ACHORDION_STREAK_ADAPTIVE_MIN_MS
+#ifndef ACHORDION_STREAK_ADAPTIVE_MAX_MS
+#define ACHORDION_STREAK_ADAPTIVE_MAX_MS 400
+#endif  // ACHORDION_STREAK_ADAPTIVE_MAX_MS
+#endif  // ACHORDION_STREAK_ADAPTIVE
+
+/**
+ * Count Achordion's decisions per key by defining ACHORDION_STATS. This gives
+ * data for tuning timeouts and chord rules.
+ *
+ * Enable with:
+ *
+ *    #define ACHORDION_STATS
+ *
+ * For up to ACHORDION_STATS_SIZE tap-hold key positions, Achordion counts how
+ * often the key was settled as held by timeout or chord, as tapped by chord or
+ * streak, how often eager mods were applied, how often the release of a hold
+ * was followed within ACHORDION_STATS_MISFIRE_MS by Backspace, as a proxy for
+ * misfires, and how often the key was settled as held by a combo. Combos are
+ * counted apart from chords, since QMK resolves them before Achordion decides
+ * anything.
+ *
+ * Read the counts with `achordion_stats_get()`, or print them to the console
+ * with `achordion_stats_print()` and render them as a heatmap with
+ * tools/achordion_heatmap.py.
+ */
+#ifdef ACHORDION_STATS
+// Max number of tap-hold key positions counted.
+#ifndef ACHORDION_STATS_SIZE
+#define ACHORDION_STATS_SIZE 16
+#endif  // ACHORDION_STATS_SIZE
+
+// Backspace within this many ms of releasing a hold counts as a misfire.
+// Backspace while the hold is active, as in Ctrl + Backspace, doesn't.
+#ifndef ACHORDION_STATS_MISFIRE_MS
+#define ACHORDION_STATS_MISFIRE_MS 600
+#endif  // ACHORDION_STATS_MISFIRE_MS
+
+/** Decision counters, in the order they are reported. */
+enum {
+  ACHORDION_STAT_HOLD_TIMEOUT,
+  ACHORDION_STAT_HOLD_CHORD,
+  ACHORDION_STAT_TAP_CHORD,
+  ACHORDION_STAT_TAP_STREAK,
+  ACHORDION_STAT_EAGER,
+  ACHORDION_STAT_MISFIRE,
+  ACHORDION_STAT_HOLD_COMBO,
+  ACHORDION_NUM_STATS,
+};
+
+/**
+ * Gets the counters for the `index`th key position in the table.
+ *
+ * @param index   Table index, starting from 0.
+ * @param key     Output, the key position.
+ * @param counts  Output, array of ACHORDION_NUM_STATS counters.
+ * @return False if `index` is past the end of the table.
+ */
+bool achordion_stats_get(uint8_t index, keypos_t* key, uint16_t* counts);
+
+/** Clears all counters. */
+void achordion_stats_clear(void);
+
+/**
+ * Prints the counters to the console, one line per key position, as
+ *
+ *     achordion_stats <row> <col> <hold_timeout> <hold_chord> <tap_chord>
+ *         <tap_streak> <eager> <misfire> <hold_combo>
+ *
+ * @note Printing happens only while debug is enabled.
+ */
+void achordion_stats_print(void);
+#endif  // ACHORDION_STATS
+
 #ifdef __cplusplus
 }
 #endif
@@ -22,6 +22,10 @@
 
 #include "caps_word.h"
 
+#ifdef SCHEDULER_ENABLE
+#include "scheduler.h"
+#endif  // SCHEDULER_ENABLE
+
 #pragma message \
     "Caps Word is now a core QMK feature! To use it, update your QMK set up and see https://docs.qmk.fm/features/caps_word"
 
@@ -40,6 +44,13 @@
     "Caps Word and Command should not be enabled at the same time, since both use the Left Shift + Right Shift key combination. Please disable Command, or ensure that `IS_COMMAND` is not set to (get_mods() == MOD_MASK_SHIFT)."
 #endif  // defined(COMMAND_ENABLE) && !defined(IS_COMMAND)
 
+#ifndef CAPS_WORD_KEY_CLASSES
+#define CAPS_WORD_KEY_CLASSES CAPS_WORD_DEFAULT_KEY_CLASSES
+#endif  // CAPS_WORD_KEY_CLASSES
+
+/** Key classes indexed by keycode, see caps_word_class.h. */
+static const uint8_t key_classes[] PROGMEM = {CAPS_WORD_KEY_CLASSES};
+
 static bool caps_word_active = false;
 
 #if CAPS_WORD_IDLE_TIMEOUT > 0
@@ -51,9 +62,21 @@ static bool caps_word_active = false;
 
 static uint16_t idle_timer = 0;
 
+#ifdef SCHEDULER_ENABLE
+// Wakes `caps_word_task()` when the idle timer expires.
+#define schedule_task() \
+  scheduler_wake_at(SCHEDULER_TASK_CAPS_WORD, caps_word_task, idle_timer)
+#else
+#define schedule_task()
+#endif  // SCHEDULER_ENABLE
+
 void caps_word_task(void) {
-  if (caps_word_active && timer_expired(timer_read(), idle_timer)) {
-    caps_word_off();
+  if (caps_word_active) {
+    if (timer_expired(timer_read(), idle_timer)) {
+      caps_word_off();
+    } else {
+      schedule_task();  // The timer was extended since the last wake up.
+    }
   }
 }
 #endif  // CAPS_WORD_IDLE_TIMEOUT > 0
@@ -130,6 +153,7 @@ bool process_caps_word(uint16_t keycode, keyrecord_t* record) {
   } else {
 #if CAPS_WORD_IDLE_TIMEOUT > 0
     idle_timer = record->event.time + CAPS_WORD_IDLE_TIMEOUT;
+    schedule_task();
 #endif  // CAPS_WORD_IDLE_TIMEOUT > 0
   }
 
@@ -145,8 +169,7 @@ bool process_caps_word(uint16_t keycode, keyrecord_t* record) {
       case QK_TOGGLE_LAYER ... QK_TOGGLE_LAYER_MAX:
       case QK_LAYER_TAP_TOGGLE ... QK_LAYER_TAP_TOGGLE_MAX:
       case QK_ONE_SHOT_LAYER ... QK_ONE_SHOT_LAYER_MAX:
-      // Ignore AltGr.
-      case KC_RALT:
+      // Ignore one-shot AltGr. AltGr itself is ignored by its key class.
       case OSM(MOD_RALT):
         return true;
 
@@ -204,6 +227,10 @@ bool process_caps_word(uint16_t keycode, keyrecord_t* record) {
 #endif  // SWAP_HANDS_ENABLE
     }
 
+    if (caps_word_key_class(keycode) == CAPS_WORD_IGNORE) {
+      return true;
+    }
+
     clear_weak_mods();
     if (caps_word_press_user(keycode)) {
 #ifdef CAPS_WORD_INVERT_ON_SHIFT
@@ -234,6 +261,7 @@ void caps_word_on(void) {
 #endif  // NO_ACTION_ONESHOT
 #if CAPS_WORD_IDLE_TIMEOUT > 0
   idle_timer = timer_read() + CAPS_WORD_IDLE_TIMEOUT;
+  schedule_task();
 #endif  // CAPS_WORD_IDLE_TIMEOUT > 0
 
   caps_word_active = true;
@@ -262,23 +290,11 @@ bool is_caps_word_on(void) { return caps_word_active; }
 
 __attribute__((weak)) void caps_word_set_user(bool active) {}
 
-__attribute__((weak)) bool caps_word_press_user(uint16_t keycode) {
-  switch (keycode) {
-    // Keycodes that continue Caps Word, with shift applied.
-    case KC_A ... KC_Z:
-    case KC_MINS:
-      add_weak_mods(MOD_BIT(KC_LSFT));  // Apply shift to the next key.
-      return true;
-
-    // Keycodes that continue Caps Word, without shifting.
-    case KC_1 ... KC_0:
-    case KC_BSPC:
-    case KC_DEL:
-    case KC_UNDS:
-      return true;
+uint8_t caps_word_key_class(uint16_t keycode) {
+  return caps_word_class_lookup(key_classes, sizeof(key_classes), keycode);
+}
 
-    default:
-      return false;  // Deactivate Caps Word.
-  }
+__attribute__((weak)) bool caps_word_press_user(uint16_t keycode) {
+  return caps_word_apply_class(caps_word_key_class(keycode));
 }
 #endif  // version check
@@ -38,8 +38,17 @@
  * -------------
  *
  * Word-breaking keys:
- * Use the `caps_word_press_user()` callback to define whether a key should
- * continue Caps Word or "break the word" and stop Caps Word.
+ * Whether a key continues Caps Word or "breaks the word" and stops Caps Word
+ * is looked up in a table of key classes (see caps_word_class.h). To change
+ * the classes, define `CAPS_WORD_KEY_CLASSES` in config.h, for instance to also
+ * continue on shifted digits like ! and @:
+ *
+ *     #define CAPS_WORD_KEY_CLASSES CAPS_WORD_DEFAULT_KEY_CLASSES, \
+ *       [KC_1 ... KC_0] = CAPS_WORD_CLASS(CAPS_WORD_CONTINUE,      \
+ *                                         CAPS_WORD_CONTINUE)
+ *
+ * For exceptions that the table can't express, override the
+ * `caps_word_press_user()` callback.
  *
  * Representing state:
  * Use `caps_word_set_user()` callback to know when Caps Word turns on and off,
@@ -60,6 +69,9 @@
  *       // Other tasks...
  *     }
  *
+ * If your keymap uses features/scheduler.h, call `scheduler_task()` there
+ * instead, and Caps Word is woken up only once the timeout expires.
+ *
  * For full documentation, see
  * <https://getreuer.info/posts/keyboards/caps-word>
  */
@@ -67,6 +79,7 @@
 #pragma once
 
 #include "quantum.h"
+#include "caps_word_class.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -142,36 +155,24 @@ void caps_word_set_user(bool active);
  * call `add_weak_mods(MOD_BIT(KC_LSFT))` to shift the key. The callback also
  * determines whether the key should continue Caps Word. Returning true
  * continues the current "word", while returning false is "word breaking" and
- * deactivates Caps Word. The default callback is
+ * deactivates Caps Word. The default callback acts on the key's class from
+ * `CAPS_WORD_KEY_CLASSES`:
  *
  *     bool caps_word_press_user(uint16_t keycode) {
- *       switch (keycode) {
- *         // Keycodes that continue Caps Word, with shift applied.
- *         case KC_A ... KC_Z:
- *         case KC_MINS:
- *           add_weak_mods(MOD_BIT(KC_LSFT));  // Apply shift to the next key.
- *           return true;
- *
- *         // Keycodes that continue Caps Word, without shifting.
- *         case KC_1 ... KC_0:
- *         case KC_BSPC:
- *         case KC_DEL:
- *         case KC_UNDS:
- *           return true;
- *
- *         default:
- *           return false;  // Deactivate Caps Word.
- *       }
+ *       return caps_word_apply_class(caps_word_key_class(keycode));
  *     }
  *
- * To customize, copy the above function into your keymap and add/remove
- * keycodes to the above cases.
+ * To handle exceptions, define this callback in your keymap, check for the
+ * exceptional keys, and otherwise fall back to the above.
  *
  * @note Outside of this callback, you can use `caps_word_off()` to deactivate
  * Caps Word.
  */
 bool caps_word_press_user(uint16_t keycode);
 
+/** Gets the `CAPS_WORD_*` class of `keycode` from `CAPS_WORD_KEY_CLASSES`. */
+uint8_t caps_word_key_class(uint16_t keycode);
+
 // Deprecated APIs.
 
 /** @deprecated Use `caps_word_on()` and `caps_word_off()` instead. */
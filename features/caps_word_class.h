@@ -0,0 +1,130 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file caps_word_class.h
+ * @brief Key class tables for deciding whether a key continues Caps Word.
+ *
+ * Instead of a `switch` over keycode ranges, Caps Word can look up the class
+ * of each key in a PROGMEM table, one byte per keycode, holding the key's class
+ * and that of the key with Shift. The table covers basic keycodes, indexed by
+ * keycode, followed by custom keycodes from `SAFE_RANGE`, indexed by
+ * `CAPS_WORD_USER(keycode)`. Entries are written with designated initializers,
+ * so that ranges of keys are assigned at once and any key not listed stops
+ * Caps Word:
+ *
+ *     static const uint8_t my_classes[] PROGMEM = {
+ *       CAPS_WORD_DEFAULT_KEY_CLASSES,
+ *       [CAPS_WORD_USER(MYMACRO)] = CAPS_WORD_CLASS(CAPS_WORD_CONTINUE,
+ *                                                   CAPS_WORD_STOP),
+ *     };
+ *
+ *     bool caps_word_press_user(uint16_t keycode) {
+ *       return caps_word_apply_class(
+ *           caps_word_class_lookup(my_classes, sizeof(my_classes), keycode));
+ *     }
+ *
+ * This header has no dependencies on features/caps_word.c, so it may be used
+ * with either this repo's Caps Word or the core QMK feature.
+ */
+
+#pragma once
+
+#include "quantum.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Classes of keys while Caps Word is active. */
+enum {
+  /** Stops Caps Word. This is the class of any key not in the table. */
+  CAPS_WORD_STOP,
+  /** Continues Caps Word, with Shift applied. */
+  CAPS_WORD_SHIFT,
+  /** Continues Caps Word, without shifting. */
+  CAPS_WORD_CONTINUE,
+  /** Passes through without affecting Caps Word, like AltGr. */
+  CAPS_WORD_IGNORE,
+};
+
+/** Table entry for a key and the key with Shift, each a `CAPS_WORD_*` class. */
+#define CAPS_WORD_CLASS(unshifted, shifted) ((unshifted) | ((shifted) << 2))
+
+/** Table index of custom keycode `kc` at or after `SAFE_RANGE`. */
+#define CAPS_WORD_USER(kc) (256 + (kc) - QK_USER)
+
+// clang-format off
+/**
+ * Default key classes, which shift letters and -, and continue on digits,
+ * Backspace, Delete, and _ (Shift + -).
+ */
+#define CAPS_WORD_DEFAULT_KEY_CLASSES                                       \
+  [KC_A ... KC_Z] = CAPS_WORD_CLASS(CAPS_WORD_SHIFT, CAPS_WORD_SHIFT),      \
+  [KC_1 ... KC_0] = CAPS_WORD_CLASS(CAPS_WORD_CONTINUE, CAPS_WORD_STOP),    \
+  [KC_MINS]       = CAPS_WORD_CLASS(CAPS_WORD_SHIFT, CAPS_WORD_CONTINUE),   \
+  [KC_BSPC]       = CAPS_WORD_CLASS(CAPS_WORD_CONTINUE, CAPS_WORD_STOP),    \
+  [KC_DEL]        = CAPS_WORD_CLASS(CAPS_WORD_CONTINUE, CAPS_WORD_STOP),    \
+  [KC_RALT]       = CAPS_WORD_CLASS(CAPS_WORD_IGNORE, CAPS_WORD_IGNORE)
+// clang-format on
+
+/**
+ * Gets the class of `keycode` from a key class table.
+ *
+ * Shifted keycodes like `KC_UNDS` are looked up as the basic keycode with
+ * Shift. Keycodes outside the table are `CAPS_WORD_STOP`.
+ *
+ * @param table    PROGMEM table, as described above.
+ * @param size     Size of the table in bytes.
+ * @param keycode  QMK keycode.
+ * @return         One of `CAPS_WORD_*`.
+ */
+static inline uint8_t caps_word_class_lookup(const uint8_t* table,
+                                             uint16_t size, uint16_t keycode) {
+  bool shifted = false;
+  if (IS_QK_MODS(keycode) && (QK_MODS_GET_MODS(keycode) & 0x0f) == MOD_LSFT) {
+    keycode = QK_MODS_GET_BASIC_KEYCODE(keycode);
+    shifted = true;
+  }
+
+  uint16_t i;
+  if (keycode <= 0xff) {
+    i = keycode;
+  } else if (keycode >= QK_USER) {
+    i = CAPS_WORD_USER(keycode);
+  } else {
+    return CAPS_WORD_STOP;
+  }
+  if (i >= size) {
+    return CAPS_WORD_STOP;
+  }
+
+  const uint8_t classes = pgm_read_byte(table + i);
+  return shifted ? (classes >> 2) & 3 : classes & 3;
+}
+
+/**
+ * Acts on a key class from `caps_word_press_user()`: applies Shift for
+ * `CAPS_WORD_SHIFT`, and returns whether Caps Word continues.
+ */
+static inline bool caps_word_apply_class(uint8_t key_class) {
+  if (key_class == CAPS_WORD_SHIFT) {
+    add_weak_mods(MOD_BIT(KC_LSFT));  // Apply shift to the next key.
+  }
+  return key_class != CAPS_WORD_STOP;
+}
+
+#ifdef __cplusplus
+}
+#endif
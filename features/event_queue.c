@@ -0,0 +1,192 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file event_queue.c
+ * @brief Event queue implementation
+ */
+
+#include "event_queue.h"
+
+#ifdef SCHEDULER_ENABLE
+#include "scheduler.h"
+#endif  // SCHEDULER_ENABLE
+
+#if !defined(IS_QK_MOD_TAP)
+// Attempt to detect out-of-date QMK installation, which would fail with
+// implicit-function-declaration errors in the code below.
+#error "event_queue: QMK version is too old to build. Please update QMK."
+#elif !defined(COMBO_ENABLE) && !defined(REPEAT_KEY_ENABLE)
+// Deferred events are queued with their resolved keycode in keyrecord_t's
+// `.keycode` field, which is only present when Combos or Repeat Key are
+// enabled. Enable Combos in your rules.mk by setting:
+//   COMBO_ENABLE = yes
+#error "event_queue: Please set `COMBO_ENABLE = yes` in rules.mk."
+#elif EVENT_QUEUE_RESERVED >= EVENT_QUEUE_SIZE
+#error "event_queue: EVENT_QUEUE_RESERVED must be less than EVENT_QUEUE_SIZE."
+#else
+
+typedef struct {
+  keyrecord_t record;
+  uint8_t source;
+  int8_t arg;
+  uint8_t weak_mods;
+  uint8_t delay_ms;
+} event_queue_entry_t;
+
+static event_queue_entry_t queue[EVENT_QUEUE_SIZE];
+static uint8_t queue_len = 0;
+// Index where the next pushed event is inserted. This is queue_len, except
+// while dispatching, where it is the front of the queue plus the number of
+// events already pushed by the event being dispatched.
+static uint8_t insert_at = 0;
+// Timer for delaying the event at the head of the queue, 0 when unset.
+static uint16_t delay_timer = 0;
+// Source and arg of the event being dispatched.
+static uint8_t dispatching_source = EVENT_QUEUE_SOURCE_NONE;
+static int8_t dispatching_arg = 0;
+
+#ifdef SCHEDULER_ENABLE
+// Wakes `event_queue_task()` by `time`.
+static void schedule_task(uint16_t time) {
+  scheduler_wake_at(SCHEDULER_TASK_EVENT_QUEUE, event_queue_task, time);
+}
+#else
+#define schedule_task(time)
+#endif  // SCHEDULER_ENABLE
+
+static void dispatch(const event_queue_entry_t* entry) {
+  keyrecord_t record = entry->record;
+  const uint8_t saved_source = dispatching_source;
+  const int8_t saved_arg = dispatching_arg;
+  dispatching_source = entry->source;
+  dispatching_arg = entry->arg;
+#if defined(POINTING_DEVICE_ENABLE) && defined(POINTING_DEVICE_AUTO_MOUSE_ENABLE)
+  int8_t mouse_key_tracker = get_auto_mouse_key_tracker();
+#endif
+
+  if (entry->weak_mods && record.event.pressed) {
+    register_weak_mods(entry->weak_mods);
+  }
+  process_record(&record);
+  if (entry->weak_mods && !record.event.pressed) {
+    unregister_weak_mods(entry->weak_mods);
+  }
+
+#if defined(POINTING_DEVICE_ENABLE) && defined(POINTING_DEVICE_AUTO_MOUSE_ENABLE)
+  set_auto_mouse_key_tracker(mouse_key_tracker);
+#endif
+  dispatching_source = saved_source;
+  dispatching_arg = saved_arg;
+}
+
+bool event_queue_push(const keyrecord_t* record, uint8_t source, int8_t arg,
+                      uint8_t weak_mods, uint8_t delay_ms) {
+  const event_queue_entry_t entry = {
+      .record = *record,
+      .source = source,
+      .arg = arg,
+      .weak_mods = weak_mods,
+      .delay_ms = delay_ms,
+  };
+
+  // Processing the event now would put it ahead of the events already queued,
+  // possibly a release ahead of its press, so it is dropped instead. Synthetic
+  // presses are held to the unreserved slots.
+  const bool reserved_ok = !record->event.pressed ||
+                           source == EVENT_QUEUE_SOURCE_DEFERRED;
+  if (queue_len >= EVENT_QUEUE_SIZE ||
+      (!reserved_ok && !event_queue_free())) {
+    dprintf("Event queue: Full, dropping %s from source %u.\n",
+            record->event.pressed ? "press" : "release", source);
+    return false;
+  }
+
+  memmove(queue + insert_at + 1, queue + insert_at,
+          (queue_len - insert_at) * sizeof(event_queue_entry_t));
+  queue[insert_at] = entry;
+  ++insert_at;
+  ++queue_len;
+  schedule_task(timer_read());
+  return true;
+}
+
+// Pops and dispatches the head event. Events it pushes are inserted at the
+// front.
+static void dispatch_head(void) {
+  const event_queue_entry_t entry = queue[0];
+  --queue_len;
+  memmove(queue, queue + 1, queue_len * sizeof(event_queue_entry_t));
+  insert_at = 0;
+  dispatch(&entry);
+  insert_at = queue_len;
+}
+
+bool process_event_queue(uint16_t keycode, keyrecord_t* record) {
+  if (dispatching_source != EVENT_QUEUE_SOURCE_NONE || queue_len == 0) {
+    return true;
+  }
+
+  // Synthetic events are pending. Defer the current event behind them, saving
+  // its keycode so that it is processed the same when it is dispatched.
+  keyrecord_t deferred = *record;
+  deferred.keycode = keycode;
+  if (event_queue_push(&deferred, EVENT_QUEUE_SOURCE_DEFERRED, 0, 0, 0)) {
+    return false;
+  }
+
+  // The queue is full. A real event must not be lost, since a lost release
+  // leaves its key stuck, so the pending events are dispatched now, ignoring
+  // their delays, and the current event is processed after them.
+  dprintf("Event queue: Full, flushing %u events.\n", queue_len);
+  delay_timer = 0;
+  while (queue_len > 0) {
+    dispatch_head();
+  }
+  return true;
+}
+
+void event_queue_task(void) {
+  while (queue_len > 0) {
+    if (queue[0].delay_ms) {
+      if (!delay_timer) {
+        // We use 0 to represent an unset timer, so `| 1` to force a nonzero
+        // value.
+        delay_timer = (timer_read() + queue[0].delay_ms) | 1;
+        schedule_task(delay_timer);
+        return;
+      } else if (!timer_expired(timer_read(), delay_timer)) {
+        schedule_task(delay_timer);
+        return;  // Head event is still waiting.
+      }
+      delay_timer = 0;
+    }
+
+    dispatch_head();
+  }
+}
+
+uint8_t event_queue_source(void) { return dispatching_source; }
+
+int8_t event_queue_arg(void) { return dispatching_arg; }
+
+uint8_t event_queue_free(void) {
+  return (queue_len + EVENT_QUEUE_RESERVED < EVENT_QUEUE_SIZE)
+             ? EVENT_QUEUE_SIZE - EVENT_QUEUE_RESERVED - queue_len
+             : 0;
+}
+
+bool event_queue_is_empty(void) { return queue_len == 0; }
+
+#endif  // version check
@@ -0,0 +1,157 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file event_queue.h
+ * @brief Event queue: non-recursive injection of synthetic key events.
+ *
+ * Overview
+ * --------
+ *
+ * Achordion and Repeat Key work by generating synthetic key events and
+ * plumbing them back into the event handling pipeline. Calling
+ * `process_record()` from within `process_record_user()` does that, but each
+ * injected event then nests another full pass of the pipeline on the stack,
+ * and the handlers need state flags to recognize their own events. On an
+ * ATmega32U4 with 2.5 KB of SRAM, the stack depth is a real concern.
+ *
+ * Instead, handlers push synthetic events with `event_queue_push()`. Queued
+ * events are dispatched one at a time from `event_queue_task()` after the
+ * current event has finished, so `process_record()` is never reentered. During
+ * dispatch, `event_queue_source()` tells which handler queued the event, which
+ * replaces the reentrancy flags.
+ *
+ * While the queue is nonempty, real key events are queued behind the pending
+ * synthetic events so that the order of events is preserved. Events pushed
+ * while an event is being dispatched go in front of the rest of the queue, so
+ * that they happen as an immediate consequence of that event.
+ *
+ * An event may have a delay, which is how tap press and release are spaced by
+ * `TAP_CODE_DELAY` without blocking the main loop in `wait_ms()`.
+ *
+ * The queue never dispatches out of order. If it is full, a pushed synthetic
+ * event is dropped and logged. To keep a press from being queued without room
+ * for its release, the last `EVENT_QUEUE_RESERVED` slots are kept for releases
+ * and deferred real key events; synthetic presses are refused once only those
+ * slots remain. Handlers queuing several events at once check
+ * `event_queue_free()` first. Real key events are never dropped: if one
+ * arrives while the queue is full, the pending events are dispatched at once,
+ * ignoring their delays, and then the real event is processed.
+ */
+
+#pragma once
+
+#include "quantum.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum number of pending events.
+#ifndef EVENT_QUEUE_SIZE
+#define EVENT_QUEUE_SIZE 8
+#endif  // EVENT_QUEUE_SIZE
+
+// Number of slots that synthetic presses may not use, kept for releases and
+// deferred real key events.
+#ifndef EVENT_QUEUE_RESERVED
+#define EVENT_QUEUE_RESERVED 2
+#endif  // EVENT_QUEUE_RESERVED
+
+/** Identifies which handler queued an event. */
+enum {
+  /** Not dispatching a queued event. */
+  EVENT_QUEUE_SOURCE_NONE,
+  /** Real key event, deferred behind pending synthetic events. */
+  EVENT_QUEUE_SOURCE_DEFERRED,
+  /** Tap or hold event generated by Achordion. */
+  EVENT_QUEUE_SOURCE_ACHORDION,
+  /** Repeated or alternate-repeated key generated by Repeat Key. */
+  EVENT_QUEUE_SOURCE_REPEAT_KEY,
+};
+
+/**
+ * Handler function for the event queue.
+ *
+ * Call this function from `process_record_user()` before any other handler:
+ *
+ *     #include "features/event_queue.h"
+ *
+ *     bool process_record_user(uint16_t keycode, keyrecord_t* record) {
+ *       if (!process_event_queue(keycode, record)) { return false; }
+ *       if (!process_achordion(keycode, record)) { return false; }
+ *       // Your macros...
+ *       return true;
+ *     }
+ *
+ * If synthetic events are pending, the current event is deferred behind them.
+ * If there is no room to defer it, the pending events are flushed first.
+ */
+bool process_event_queue(uint16_t keycode, keyrecord_t* record);
+
+/**
+ * Matrix task function for the event queue.
+ *
+ * Call this function from `housekeeping_task_user()`, after the task functions
+ * of any features that push events:
+ *
+ *     void housekeeping_task_user(void) {
+ *       achordion_task();
+ *       event_queue_task();
+ *     }
+ *
+ * The task dispatches all pending events whose delays have elapsed. When built
+ * with `SCHEDULER_ENABLE`, pushing an event wakes the task through scheduler.h,
+ * so `scheduler_task()` is called in its place.
+ */
+void event_queue_task(void);
+
+/**
+ * Pushes a synthetic event to be processed by `process_record()`.
+ *
+ * @param record     Event to process. It is copied into the queue.
+ * @param source     `EVENT_QUEUE_SOURCE_*` identifying the caller.
+ * @param arg        Caller-defined value, see `event_queue_arg()`.
+ * @param weak_mods  Weak mods that apply with the event. They are registered
+ *                   before a press is processed and unregistered after a
+ *                   release is processed.
+ * @param delay_ms   Minimum time in ms after the previous queued event before
+ *                   this event is processed.
+ * @return True if the event was queued, false if it was dropped for lack of
+ *         room, see `event_queue_free()`.
+ */
+bool event_queue_push(const keyrecord_t* record, uint8_t source, int8_t arg,
+                      uint8_t weak_mods, uint8_t delay_ms);
+
+/** Source of the event being dispatched, or EVENT_QUEUE_SOURCE_NONE. */
+uint8_t event_queue_source(void);
+
+/** The `arg` passed with the event being dispatched, or 0. */
+int8_t event_queue_arg(void);
+
+/**
+ * Number of synthetic presses that can be queued now, not counting the
+ * `EVENT_QUEUE_RESERVED` slots. A handler queuing `n` taps, each a press then
+ * a release, should check that this is at least `2 * n - 1` before pushing any
+ * of them. Only the presses are held to these slots, so the last release may
+ * take a reserved one.
+ */
+uint8_t event_queue_free(void);
+
+/** Returns true if no events are pending. */
+bool event_queue_is_empty(void);
+
+#ifdef __cplusplus
+}
+#endif
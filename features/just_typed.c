@@ -0,0 +1,207 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file just_typed.c
+ * @brief Just typed implementation
+ *
+ * Tokens are basic keycodes, or'd with QK_LSFT if typed with Shift, except
+ * that letters never have QK_LSFT. The generated automaton is a uint16_t array
+ * of nodes. Each node is
+ *
+ *     fail, mask_lo, mask_hi, num_children, token_1, child_1, ...
+ *
+ * where `fail` is the offset of the node for the longest proper suffix of the
+ * node's path that is also in the trie, `mask_hi:mask_lo` is the mask of
+ * patterns that are suffixes of the path, and `child_i` is the offset of the
+ * child node for `token_i`. The root node is at offset 0.
+ */
+
+#include "just_typed.h"
+
+#include <string.h>
+
+#if !defined(IS_QK_MOD_TAP)
+// Attempt to detect out-of-date QMK installation, which would fail with
+// implicit-function-declaration errors in the code below.
+#error "just_typed: QMK version is too old to build. Please update QMK."
+#else
+
+// States after each of the last few tracked keys, most recent last.
+static uint16_t history[JUST_TYPED_HISTORY_SIZE] = {0};
+static uint8_t history_len = 0;
+static uint32_t last_matches = 0;
+
+// Gets the token for basic `keycode`, or KC_NO if it isn't a typing key.
+static uint16_t get_token(uint16_t keycode, bool shifted) {
+  switch (keycode) {
+    case KC_A ... KC_Z:
+      return keycode;
+
+    case KC_1 ... KC_0:
+    case KC_ENT:
+    case KC_TAB:
+    case KC_SPC ... KC_SLSH:
+      return keycode | (shifted ? QK_LSFT : 0);
+  }
+  return KC_NO;
+}
+
+// Returns the offset of `node`'s child for `token`, or 0 if there is none.
+static uint16_t find_child(const uint16_t* data, uint16_t node,
+                           uint16_t token) {
+  const uint16_t num_children = pgm_read_word(data + node + 3);
+  const uint16_t* children = data + node + 4;
+  for (uint16_t i = 0; i < num_children; ++i) {
+    if (pgm_read_word(children + 2 * i) == token) {
+      return pgm_read_word(children + 2 * i + 1);
+    }
+  }
+  return 0;
+}
+
+uint16_t just_typed_next(const uint16_t* data, uint16_t state,
+                         uint16_t keycode, bool shifted) {
+  const uint16_t token = get_token(keycode, shifted);
+  if (token == KC_NO) {
+    return 0;
+  }
+
+  for (;;) {
+    const uint16_t child = find_child(data, state, token);
+    if (child || !state) {
+      return child;
+    }
+    state = pgm_read_word(data + state);  // Follow the failure link.
+  }
+}
+
+uint32_t just_typed_state_matches(const uint16_t* data, uint16_t state) {
+  return (uint32_t)pgm_read_word(data + state + 1) |
+         ((uint32_t)pgm_read_word(data + state + 2) << 16);
+}
+
+uint32_t just_typed_scan(const uint16_t* data, const uint16_t* keycodes,
+                         uint8_t len) {
+  uint16_t state = 0;
+  for (uint8_t i = 0; i < len; ++i) {
+    uint16_t keycode = keycodes[i];
+    bool shifted = false;
+    if (IS_QK_MODS(keycode)) {
+      if ((QK_MODS_GET_MODS(keycode) & 0x0f) != MOD_LSFT) {
+        state = 0;
+        continue;
+      }
+      keycode = QK_MODS_GET_BASIC_KEYCODE(keycode);
+      shifted = true;
+    }
+    state = just_typed_next(data, state, keycode, shifted);
+  }
+  return just_typed_state_matches(data, state);
+}
+
+void just_typed_clear(void) {
+  history_len = 0;
+  last_matches = 0;
+}
+
+uint32_t just_typed_get_matches(void) { return last_matches; }
+
+bool process_just_typed(uint16_t keycode, keyrecord_t* record,
+                        const uint16_t* data) {
+  if (!record->event.pressed) {
+    return true;
+  }
+
+  // Unpack tapping keycode for tap-hold keys. Holds are ignored.
+  switch (keycode) {
+#ifndef NO_ACTION_TAPPING
+    case QK_MOD_TAP ... QK_MOD_TAP_MAX:
+      if (record->tap.count == 0) {
+        return true;
+      }
+      keycode = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+      break;
+#ifndef NO_ACTION_LAYER
+    case QK_LAYER_TAP ... QK_LAYER_TAP_MAX:
+      if (record->tap.count == 0) {
+        return true;
+      }
+      keycode = QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+      break;
+#endif  // NO_ACTION_LAYER
+#endif  // NO_ACTION_TAPPING
+  }
+
+  uint8_t mods = get_mods() | get_weak_mods();
+#ifndef NO_ACTION_ONESHOT
+  mods |= get_oneshot_mods();
+#endif  // NO_ACTION_ONESHOT
+  if (IS_QK_MODS(keycode)) {  // Unpack modifier + basic key.
+    const uint8_t key_mods = QK_MODS_GET_MODS(keycode);
+    if ((key_mods & ~MOD_RSFT) != 0) {
+      mods |= MOD_BIT(KC_LCTL);  // Mods other than Shift make a hotkey.
+    } else if ((key_mods & MOD_LSFT) != 0) {
+      mods |= MOD_BIT(KC_LSFT);
+    }
+    keycode = QK_MODS_GET_BASIC_KEYCODE(keycode);
+  }
+
+  if ((mods & ~MOD_MASK_SHIFT) != 0) {
+    just_typed_clear();  // Hotkeys reset the state.
+    return true;
+  }
+
+  switch (keycode) {
+    case KC_BSPC:
+      if (history_len > 0) {
+        --history_len;
+      }
+      last_matches = 0;
+      return true;
+
+    case KC_LCTL ... KC_RGUI:  // Mod keys.
+    case QK_REP:
+    case QK_AREP:
+    case QK_USER ... QK_USER_MAX:  // Macros.
+      return true;
+
+    default:
+      if (get_token(keycode, false) == KC_NO) {
+        just_typed_clear();  // Not a typing key.
+        return true;
+      }
+  }
+
+  const uint16_t state = just_typed_next(
+      data, history_len ? history[history_len - 1] : 0, keycode,
+      (mods & MOD_MASK_SHIFT) != 0);
+
+  if (history_len >= JUST_TYPED_HISTORY_SIZE) {
+    memmove(history, history + 1,
+            (JUST_TYPED_HISTORY_SIZE - 1) * sizeof(uint16_t));
+    history_len = JUST_TYPED_HISTORY_SIZE - 1;
+  }
+  history[history_len++] = state;
+
+  last_matches = just_typed_state_matches(data, state);
+  if (last_matches) {
+    just_typed_user(last_matches);
+  }
+  return true;
+}
+
+__attribute__((weak)) void just_typed_user(uint32_t matches) {}
+
+#endif  // version check
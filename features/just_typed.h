@@ -0,0 +1,150 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file just_typed.h
+ * @brief Just typed: match many "just typed" patterns in one step per key.
+ *
+ * Overview
+ * --------
+ *
+ * Features like Sentence Case need to know whether a pattern such as " vs."
+ * was just typed. Comparing the recent keys against each pattern in turn costs
+ * one scan per pattern per key. This library instead compiles all patterns
+ * into one Aho-Corasick automaton over keycodes. Each key advances the
+ * automaton by one state, and the state tells which patterns were completed by
+ * that key, as a bit mask.
+ *
+ * The automaton is generated from a pattern file with make_just_typed_data.py,
+ * in the same way as the Magic key's rules. Each line has the syntax
+ * "pattern -> NAME", for instance:
+ *
+ *     \svs.   -> ABBREV
+ *     \setc.  -> ABBREV
+ *     \sbtw   -> BTW
+ *
+ * The generated just_typed_data.h defines the bits `JUST_TYPED_ABBREV` and
+ * `JUST_TYPED_BTW` and the table `just_typed_data`, which is passed to the
+ * functions below. There are two ways to use it:
+ *
+ * 1. Track typing in `process_record_user()` and react to completed patterns
+ *    in a callback:
+ *
+ *     #include "features/just_typed.h"
+ *     #include "features/just_typed_data.h"
+ *
+ *     bool process_record_user(uint16_t keycode, keyrecord_t* record) {
+ *       if (!process_just_typed(keycode, record, just_typed_data)) {
+ *         return false;
+ *       }
+ *       // Your macros...
+ *       return true;
+ *     }
+ *
+ *     void just_typed_user(uint32_t matches) {
+ *       if (matches & JUST_TYPED_BTW) {
+ *         SEND_STRING(SS_TAP(X_BSPC) SS_TAP(X_BSPC) "y the way");
+ *       }
+ *     }
+ *
+ * 2. Run the automaton over a buffer of keycodes that a feature already keeps,
+ *    like the buffer passed to `sentence_case_check_ending()`:
+ *
+ *     bool sentence_case_check_ending(const uint16_t* buffer) {
+ *       return !(just_typed_scan(just_typed_data, buffer,
+ *                                SENTENCE_CASE_BUFFER_SIZE) &
+ *                JUST_TYPED_ABBREV);
+ *     }
+ *
+ * Letters match regardless of Shift. Other keys match with or without Shift as
+ * written in the pattern, e.g. "!" is Shift + KC_1.
+ */
+
+#pragma once
+
+#include "quantum.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of automaton states kept for rewinding with Backspace.
+#ifndef JUST_TYPED_HISTORY_SIZE
+#define JUST_TYPED_HISTORY_SIZE 8
+#endif  // JUST_TYPED_HISTORY_SIZE
+
+/**
+ * Handler function for tracking typed patterns.
+ *
+ * Call this function from `process_record_user()`. It observes events and
+ * always returns true. On each typing key (letters, digits, space, enter, tab,
+ * and punctuation), the automaton advances one step, and if any patterns were
+ * completed, `just_typed_user()` is called with their mask. Backspace rewinds
+ * one step. Keys in the user range (macros) are ignored. Other keys, or
+ * pressing with Ctrl, Alt, or GUI, reset the automaton.
+ *
+ * @param data  Generated table, `just_typed_data` from just_typed_data.h.
+ */
+bool process_just_typed(uint16_t keycode, keyrecord_t* record,
+                        const uint16_t* data);
+
+/** Gets the mask of patterns completed by the last key tracked. */
+uint32_t just_typed_get_matches(void);
+
+/** Resets the tracked state. */
+void just_typed_clear(void);
+
+/**
+ * Optional callback, called by `process_just_typed()` when a key completes one
+ * or more patterns.
+ *
+ * @param matches  Mask of the completed patterns.
+ */
+void just_typed_user(uint32_t matches);
+
+/**
+ * Runs the automaton over a buffer of keycodes, oldest first.
+ *
+ * Keycodes may be basic keycodes or basic keycodes with Shift, like S(KC_1).
+ * Other keycodes, including KC_NO, reset the automaton.
+ *
+ * @param data  Generated table, `just_typed_data` from just_typed_data.h.
+ * @param keycodes  Buffer of keycodes.
+ * @param len  Length of the buffer.
+ * @return Mask of the patterns that end at the last keycode in the buffer.
+ */
+uint32_t just_typed_scan(const uint16_t* data, const uint16_t* keycodes,
+                         uint8_t len);
+
+/**
+ * Advances the automaton from `state` by one key.
+ *
+ * This is the step used by `process_just_typed()` and `just_typed_scan()`, for
+ * features that keep their own state. The initial state is 0.
+ *
+ * @param data  Generated table, `just_typed_data` from just_typed_data.h.
+ * @param state  Current state.
+ * @param keycode  Basic keycode typed.
+ * @param shifted  Whether the key was typed with Shift.
+ * @return The next state.
+ */
+uint16_t just_typed_next(const uint16_t* data, uint16_t state,
+                         uint16_t keycode, bool shifted);
+
+/** Gets the mask of patterns that end at `state`. */
+uint32_t just_typed_state_matches(const uint16_t* data, uint16_t state);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,61 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Generated code.
+
+// Just typed patterns (14 entries):
+//   \sapprox. -> ABBREV
+//   \scf.     -> ABBREV
+//   \sdept.   -> ABBREV
+//   \sdr.     -> ABBREV
+//   \seq.     -> ABBREV
+//   \setc.    -> ABBREV
+//   \sincl.   -> ABBREV
+//   \sjr.     -> ABBREV
+//   \smr.     -> ABBREV
+//   \smrs.    -> ABBREV
+//   \sms.     -> ABBREV
+//   \sprof.   -> ABBREV
+//   \ssr.     -> ABBREV
+//   \svs.     -> ABBREV
+
+#define JUST_TYPED_ABBREV (UINT32_C(1) << 0)
+
+#define JUST_TYPED_DATA_MAX_PATTERN 8
+
+static const uint16_t just_typed_data[304] PROGMEM = {0, 0x0000, 0x0000, 1,
+    0x002C, 6, 0, 0x0000, 0x0000, 10, 0x0004, 30, 0x0006, 36, 0x0007, 42,
+    0x0008, 50, 0x000C, 58, 0x000D, 64, 0x0010, 70, 0x0013, 78, 0x0016, 84,
+    0x0019, 90, 0, 0x0000, 0x0000, 1, 0x0013, 96, 0, 0x0000, 0x0000, 1, 0x0009,
+    102, 0, 0x0000, 0x0000, 2, 0x0008, 108, 0x0015, 114, 0, 0x0000, 0x0000, 2,
+    0x0014, 120, 0x0017, 126, 0, 0x0000, 0x0000, 1, 0x0011, 132, 0, 0x0000,
+    0x0000, 1, 0x0015, 138, 0, 0x0000, 0x0000, 2, 0x0015, 144, 0x0016, 152, 0,
+    0x0000, 0x0000, 1, 0x0015, 158, 0, 0x0000, 0x0000, 1, 0x0015, 164, 0,
+    0x0000, 0x0000, 1, 0x0016, 170, 0, 0x0000, 0x0000, 1, 0x0013, 176, 0,
+    0x0000, 0x0000, 1, 0x0037, 182, 0, 0x0000, 0x0000, 1, 0x0013, 186, 0,
+    0x0000, 0x0000, 1, 0x0037, 192, 0, 0x0000, 0x0000, 1, 0x0037, 196, 0,
+    0x0000, 0x0000, 1, 0x0006, 200, 0, 0x0000, 0x0000, 1, 0x0006, 206, 0,
+    0x0000, 0x0000, 1, 0x0037, 212, 0, 0x0000, 0x0000, 2, 0x0016, 216, 0x0037,
+    222, 0, 0x0000, 0x0000, 1, 0x0037, 226, 0, 0x0000, 0x0000, 1, 0x0012, 230,
+    0, 0x0000, 0x0000, 1, 0x0037, 236, 0, 0x0000, 0x0000, 1, 0x0037, 240, 0,
+    0x0000, 0x0000, 1, 0x0015, 244, 0, 0x0001, 0x0000, 0, 0, 0x0000, 0x0000, 1,
+    0x0017, 250, 0, 0x0001, 0x0000, 0, 0, 0x0001, 0x0000, 0, 0, 0x0000, 0x0000,
+    1, 0x0037, 256, 0, 0x0000, 0x0000, 1, 0x000F, 260, 0, 0x0001, 0x0000, 0, 0,
+    0x0000, 0x0000, 1, 0x0037, 266, 0, 0x0001, 0x0000, 0, 0, 0x0001, 0x0000, 0,
+    0, 0x0000, 0x0000, 1, 0x0009, 270, 0, 0x0001, 0x0000, 0, 0, 0x0001, 0x0000,
+    0, 0, 0x0000, 0x0000, 1, 0x0012, 276, 0, 0x0000, 0x0000, 1, 0x0037, 282, 0,
+    0x0001, 0x0000, 0, 0, 0x0000, 0x0000, 1, 0x0037, 286, 0, 0x0001, 0x0000, 0,
+    0, 0x0000, 0x0000, 1, 0x0037, 290, 0, 0x0000, 0x0000, 1, 0x001B, 294, 0,
+    0x0001, 0x0000, 0, 0, 0x0001, 0x0000, 0, 0, 0x0001, 0x0000, 0, 0, 0x0000,
+    0x0000, 1, 0x0037, 300, 0, 0x0001, 0x0000, 0};
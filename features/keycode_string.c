@@ -33,50 +33,48 @@
 typedef int_fast8_t index_t;
 
 // clang-format off
-/** Names of some common keycodes. */
-static const keycode_string_name_t keycode_names[] = {
-  KEYCODE_STRING_NAME(KC_ENT),
-  KEYCODE_STRING_NAME(KC_ESC),
-  KEYCODE_STRING_NAME(KC_BSPC),
-  KEYCODE_STRING_NAME(KC_TAB),
-  KEYCODE_STRING_NAME(KC_SPC),
-  KEYCODE_STRING_NAME(KC_MINS),
-  KEYCODE_STRING_NAME(KC_EQL),
-  KEYCODE_STRING_NAME(KC_LBRC),
-  KEYCODE_STRING_NAME(KC_RBRC),
-  KEYCODE_STRING_NAME(KC_BSLS),
-  KEYCODE_STRING_NAME(KC_SCLN),
-  KEYCODE_STRING_NAME(KC_QUOT),
-  KEYCODE_STRING_NAME(KC_GRV),
-  KEYCODE_STRING_NAME(KC_COMM),
-  KEYCODE_STRING_NAME(KC_DOT),
-  KEYCODE_STRING_NAME(KC_SLSH),
-  KEYCODE_STRING_NAME(KC_INS),
-  KEYCODE_STRING_NAME(KC_HOME),
-  KEYCODE_STRING_NAME(KC_PGUP),
-  KEYCODE_STRING_NAME(KC_DEL),
-  KEYCODE_STRING_NAME(KC_END),
-  KEYCODE_STRING_NAME(KC_PGDN),
-  KEYCODE_STRING_NAME(KC_RGHT),
-  KEYCODE_STRING_NAME(KC_LEFT),
-  KEYCODE_STRING_NAME(KC_DOWN),
-  KEYCODE_STRING_NAME(KC_UP),
-#ifdef TRI_LAYER_ENABLE
-  KEYCODE_STRING_NAME(TL_LOWR),
-  KEYCODE_STRING_NAME(TL_UPPR),
-#endif // TRI_LAYER_ENABLE
+// Names of some common keycodes, as X-macro lists. Names are found by binary
+// search, so entries must be sorted by keycode, which is checked at compile
+// time. Entries for optional features are in separate lists to leave them out.
+#define BASIC_KEYCODE_NAMES(X)                                      \
+  X(KC_ENT) X(KC_ESC) X(KC_BSPC) X(KC_TAB) X(KC_SPC) X(KC_MINS)     \
+  X(KC_EQL) X(KC_LBRC) X(KC_RBRC) X(KC_BSLS) X(KC_SCLN) X(KC_QUOT)  \
+  X(KC_GRV) X(KC_COMM) X(KC_DOT) X(KC_SLSH) X(KC_INS) X(KC_HOME)    \
+  X(KC_PGUP) X(KC_DEL) X(KC_END) X(KC_PGDN) X(KC_RGHT) X(KC_LEFT)   \
+  X(KC_DOWN) X(KC_UP) X(DB_TOGG)
 #ifdef GRAVE_ESC_ENABLE
-  KEYCODE_STRING_NAME(QK_GESC),
+#define GRAVE_ESC_KEYCODE_NAMES(X) X(QK_GESC)
+#else
+#define GRAVE_ESC_KEYCODE_NAMES(X)
 #endif // GRAVE_ESC_ENABLE
 #ifdef CAPS_WORD_ENABLE
-  KEYCODE_STRING_NAME(CW_TOGG),
+#define CAPS_WORD_KEYCODE_NAMES(X) X(CW_TOGG)
+#else
+#define CAPS_WORD_KEYCODE_NAMES(X)
 #endif // CAPS_WORD_ENABLE
+#ifdef TRI_LAYER_ENABLE
+#define TRI_LAYER_KEYCODE_NAMES(X) X(TL_LOWR) X(TL_UPPR)
+#else
+#define TRI_LAYER_KEYCODE_NAMES(X)
+#endif // TRI_LAYER_ENABLE
 #ifdef LAYER_LOCK_ENABLE
-  KEYCODE_STRING_NAME(QK_LLCK),
+#define LAYER_LOCK_KEYCODE_NAMES(X) X(QK_LLCK)
+#else
+#define LAYER_LOCK_KEYCODE_NAMES(X)
 #endif // LAYER_LOCK_ENABLE
-  KEYCODE_STRING_NAME(DB_TOGG),
-  KEYCODE_STRING_NAMES_END
+
+#define BUILTIN_KEYCODE_NAMES(X) \
+  BASIC_KEYCODE_NAMES(X)         \
+  GRAVE_ESC_KEYCODE_NAMES(X)     \
+  CAPS_WORD_KEYCODE_NAMES(X)     \
+  TRI_LAYER_KEYCODE_NAMES(X)     \
+  LAYER_LOCK_KEYCODE_NAMES(X)
+
+/** Names of some common keycodes, sorted by keycode. */
+static const keycode_string_name_t keycode_names[] = {
+  BUILTIN_KEYCODE_NAMES(KEYCODE_STRING_NAME_ENTRY)
 };
+KEYCODE_STRING_CHECK_SORTED(BUILTIN_KEYCODE_NAMES)
 // clang-format on
 /** Users can override this to define names of additional keycodes. */
 __attribute__((weak))
@@ -84,21 +82,52 @@ const keycode_string_name_t custom_keycode_names[] = {KEYCODE_STRING_NAMES_END};
 /** Names of the 4 mods on each hand. */
 static const char* mod_names[4] = {PSTR("CTL"), PSTR("SFT"), PSTR("ALT"),
                                    PSTR("GUI")};
-/** Internal buffer for holding a stringified keycode. */
-static char buffer[32];
-#define BUFFER_MAX_LEN (sizeof(buffer) - 1)
-static index_t buffer_len;
+/** Internal buffer for `keycode_string()`. */
+static char buffer[KEYCODE_STRING_BUFFER_SIZE];
+/**
+ * Number of entries in `custom_keycode_names` if it is sorted by keycode, 0 if
+ * it is unsorted or empty and is scanned linearly, or -1 if not checked yet.
+ */
+static int16_t num_custom_keycode_names = -1;
+
+/** Destination of the formatted string. */
+typedef struct {
+  char* buffer;
+  uint8_t len;
+  uint8_t max_len;  // Buffer size minus 1 for the null terminator.
+} writer_t;
 
 /**
  * @brief Finds the name of a keycode in `table` or returns NULL.
  *
- * The last entry of the table must be `KEYCODE_STRING_NAMES_END`.
+ * Uses binary search, so the table must be sorted by keycode.
  *
  * @param table   A table of keycode_string_name_t to be searched.
+ * @param size    Number of entries in the table.
  * @return Name string for the keycode, or NULL if not found.
  */
 static const char* find_keycode_name(const keycode_string_name_t* table,
-                                     uint16_t keycode) {
+                                     int16_t size, uint16_t keycode) {
+  int16_t lo = 0;
+  int16_t hi = size;
+  while (lo < hi) {
+    const int16_t mid = lo + (hi - lo) / 2;
+    if (table[mid].keycode < keycode) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return (lo < size && table[lo].keycode == keycode) ? table[lo].name : NULL;
+}
+
+/**
+ * @brief Finds the name of a keycode in unsorted `table` or returns NULL.
+ *
+ * The last entry of the table must be `KEYCODE_STRING_NAMES_END`.
+ */
+static const char* find_keycode_name_linear(const keycode_string_name_t* table,
+                                            uint16_t keycode) {
   for (; table->keycode; ++table) {
     if (table->keycode == keycode) {
       return table->name;
@@ -107,101 +136,117 @@ static const char* find_keycode_name(const keycode_string_name_t* table,
   return NULL;
 }
 
-/** Formats `number` in `base`, either 10 or 16. */
-static char* number_string(uint16_t number, int8_t base) {
-  static char result[7];
-  result[sizeof(result) - 1] = '\0';
-  index_t i = sizeof(result) - 1;
-  do {
-    const uint8_t digit = number % base;
-    number /= base;
-    result[--i] = (digit < 10) ? (char)(digit + UINT8_C('0'))
-                               : (char)(digit + (UINT8_C('A') - 10));
-  } while (number > 0 && i > 0);
-
-  if (base == 16 && i >= 2) {
-    result[--i] = 'x';
-    result[--i] = '0';
-  }
-  return result + i;
-}
-
-/** Appends `str` to `buffer`, truncating if the result would overflow. */
-static void append(const char* str) {
-  char* dest = buffer + buffer_len;
-  index_t i;
-  for (i = 0; buffer_len + i < BUFFER_MAX_LEN && str[i]; ++i) {
+/** Appends `str` to the buffer, truncating if the result would overflow. */
+static void append(writer_t* w, const char* str) {
+  char* dest = w->buffer + w->len;
+  uint8_t i;
+  for (i = 0; w->len + i < w->max_len && str[i]; ++i) {
     dest[i] = str[i];
   }
-  buffer_len += i;
-  buffer[buffer_len] = '\0';
+  w->len += i;
+  w->buffer[w->len] = '\0';
 }
 
 /** Same as append(), but where `str` is a PROGMEM string. */
-static void append_P(const char* str) {
-  char* dest = buffer + buffer_len;
-  index_t i;
-  for (i = 0; buffer_len + i < BUFFER_MAX_LEN; ++i) {
+static void append_P(writer_t* w, const char* str) {
+  char* dest = w->buffer + w->len;
+  uint8_t i;
+  for (i = 0; w->len + i < w->max_len; ++i) {
     const char c = pgm_read_byte(&str[i]);
     if (c == '\0') {
       break;
     }
     dest[i] = c;
   }
-  buffer_len += i;
-  buffer[buffer_len] = '\0';
+  w->len += i;
+  w->buffer[w->len] = '\0';
 }
 
-/** Appends a single char to `buffer` if there is space. */
-static void append_char(char c) {
-  if (buffer_len < BUFFER_MAX_LEN) {
-    buffer[buffer_len] = c;
-    buffer[++buffer_len] = '\0';
+/** Appends a single char to the buffer if there is space. */
+static void append_char(writer_t* w, char c) {
+  if (w->len < w->max_len) {
+    w->buffer[w->len] = c;
+    w->buffer[++w->len] = '\0';
   }
 }
 
-/** Formats `number` in `base`, either 10 or 16, and appends it to `buffer`. */
-static void append_number(uint16_t number, int8_t base) {
-  append(number_string(number, base));
+/** Formats `number` in `base`, either 10 or 16, and appends it. */
+static void append_number(writer_t* w, uint16_t number, int8_t base) {
+  char result[7];
+  result[sizeof(result) - 1] = '\0';
+  index_t i = sizeof(result) - 1;
+  do {
+    const uint8_t digit = number % base;
+    number /= base;
+    result[--i] = (digit < 10) ? (char)(digit + UINT8_C('0'))
+                               : (char)(digit + (UINT8_C('A') - 10));
+  } while (number > 0 && i > 0);
+
+  if (base == 16 && i >= 2) {
+    result[--i] = 'x';
+    result[--i] = '0';
+  }
+  append(w, result + i);
 }
 
-/** Stringifies 5-bit mods and appends it to `buffer`. */
-static void append_5_bit_mods(uint8_t mods) {
+/** Stringifies 5-bit mods and appends it to the buffer. */
+static void append_5_bit_mods(writer_t* w, uint8_t mods) {
   const bool is_rhs = mods > 15;
   mods &= 15;
   if (mods != 0 && (mods & (mods - 1)) == 0) {  // One mod is set.
-    append_P(PSTR("MOD_"));
-    append_char(is_rhs ? 'R' : 'L');
-    append_P(mod_names[biton(mods)]);
+    append_P(w, PSTR("MOD_"));
+    append_char(w, is_rhs ? 'R' : 'L');
+    append_P(w, mod_names[biton(mods)]);
   } else {  // Fallback: write the mod as a hex value.
-    append_number(mods, 16);
+    append_number(w, mods, 16);
   }
 }
 
 /**
- * @brief Writes a keycode of the format `name` + "(" + `param` + ")".
- * @note `name` is a PROGMEM string, `param` is not.
+ * @brief Writes a keycode of the format `name` + "(" + `param` + ")", where
+ * `param` is formatted in `base`, either 10 or 16.
+ * @note `name` is a PROGMEM string.
  */
-static void append_unary_keycode(const char* name, const char* param) {
-  append_P(name);
-  append_char('(');
-  append(param);
-  append_char(')');
+static void append_unary_keycode(writer_t* w, const char* name, uint16_t param,
+                                 int8_t base) {
+  append_P(w, name);
+  append_char(w, '(');
+  append_number(w, param, base);
+  append_char(w, ')');
 }
 
-/** Stringifies `keycode` and appends it to `buffer`. */
-static void append_keycode(uint16_t keycode) {
+/** Stringifies `keycode` and appends it to the buffer. */
+static void append_keycode(writer_t* w, uint16_t keycode) {
   // Search the `custom_keycode_names` table first so that it is possible to
   // override how any keycode would be formatted otherwise.
-  const char* keycode_name = find_keycode_name(custom_keycode_names, keycode);
+  if (num_custom_keycode_names < 0) {
+    // On first use, count the entries and check that they are sorted. Tables
+    // written before sorting was needed may be in any order, and are scanned
+    // linearly instead of being searched wrongly.
+    int16_t n = 0;
+    bool sorted = true;
+    for (; custom_keycode_names[n].keycode; ++n) {
+      if (n > 0 && custom_keycode_names[n].keycode <=
+                       custom_keycode_names[n - 1].keycode) {
+        sorted = false;
+      }
+    }
+    num_custom_keycode_names = sorted ? n : 0;
+  }
+  const char* keycode_name =
+      num_custom_keycode_names
+          ? find_keycode_name(custom_keycode_names, num_custom_keycode_names,
+                              keycode)
+          : find_keycode_name_linear(custom_keycode_names, keycode);
   if (keycode_name) {
-    append_P(keycode_name);
+    append_P(w, keycode_name);
     return;
   }
   // Search the `keycode_names` table.
-  keycode_name = find_keycode_name(keycode_names, keycode);
+  keycode_name = find_keycode_name(
+      keycode_names, sizeof(keycode_names) / sizeof(*keycode_names), keycode);
   if (keycode_name) {
-    append_P(keycode_name);
+    append_P(w, keycode_name);
     return;
   }
 
@@ -211,39 +256,39 @@ static void append_keycode(uint16_t keycode) {
       case MODIFIER_KEYCODE_RANGE: {
         const uint8_t i = keycode - KC_LCTL;
         const bool is_rhs = i > 3;
-        append_P(PSTR("KC_"));
-        append_char(is_rhs ? 'R' : 'L');
-        append_P(mod_names[i & 3]);
+        append_P(w, PSTR("KC_"));
+        append_char(w, is_rhs ? 'R' : 'L');
+        append_P(w, mod_names[i & 3]);
       }
         return;
 
       // Letters A-Z.
       case KC_A ... KC_Z:
-        append_P(PSTR("KC_"));
-        append_char((char)(keycode + (UINT8_C('A') - KC_A)));
+        append_P(w, PSTR("KC_"));
+        append_char(w, (char)(keycode + (UINT8_C('A') - KC_A)));
         return;
 
       // Digits 0-9 (NOTE: Unlike the ASCII order, KC_0 comes *after* KC_9.)
       case KC_1 ... KC_0:
-        append_P(PSTR("KC_"));
-        append_char('0' + (char)((keycode - (KC_1 - 1)) % 10));
+        append_P(w, PSTR("KC_"));
+        append_char(w, '0' + (char)((keycode - (KC_1 - 1)) % 10));
         return;
 
       // Keypad digits.
       case KC_KP_1 ... KC_KP_0:
-        append_P(PSTR("KC_KP_"));
-        append_char('0' + (char)((keycode - (KC_KP_1 - 1)) % 10));
+        append_P(w, PSTR("KC_KP_"));
+        append_char(w, '0' + (char)((keycode - (KC_KP_1 - 1)) % 10));
         return;
 
       // Function keys. F1-F12 and F13-F24 are coded in separate ranges.
       case KC_F1 ... KC_F12:
-        append_P(PSTR("KC_F"));
-        append_number(keycode - (KC_F1 - 1), 10);
+        append_P(w, PSTR("KC_F"));
+        append_number(w, keycode - (KC_F1 - 1), 10);
         return;
 
       case KC_F13 ... KC_F24:
-        append_P(PSTR("KC_F"));
-        append_number(keycode - (KC_F13 - 13), 10);
+        append_P(w, PSTR("KC_F"));
+        append_number(w, keycode - (KC_F13 - 13), 10);
         return;
     }
   }
@@ -259,78 +304,75 @@ static void append_keycode(uint16_t keycode) {
       if (mods != 0 && (mods & (mods - 1)) == 0) {  // One mod is set.
         const char* name = mod_names[biton(mods)];
         if (is_rhs) {
-          append_char('R');
-          append_P(name);
+          append_char(w, 'R');
+          append_P(w, name);
         } else {
-          append_char(pgm_read_byte(&name[0]));
+          append_char(w, pgm_read_byte(&name[0]));
         }
-        append_char('(');
-        append_keycode(QK_MODS_GET_BASIC_KEYCODE(keycode));
-        append_char(')');
+        append_char(w, '(');
+        append_keycode(w, QK_MODS_GET_BASIC_KEYCODE(keycode));
+        append_char(w, ')');
         return;
       }
     } break;
 
     // One-shot mod OSM(mod) key.
     case QK_ONE_SHOT_MOD ... QK_ONE_SHOT_MOD_MAX:
-      append_P(PSTR("OSM("));
-      append_5_bit_mods(QK_ONE_SHOT_MOD_GET_MODS(keycode));
-      append_char(')');
+      append_P(w, PSTR("OSM("));
+      append_5_bit_mods(w, QK_ONE_SHOT_MOD_GET_MODS(keycode));
+      append_char(w, ')');
       return;
 
     // Various layer switch keys.
     case QK_LAYER_TAP ... QK_LAYER_TAP_MAX:  // Layer-tap LT(layer,kc) key.
-      append_P(PSTR("LT("));
-      append_number(QK_LAYER_TAP_GET_LAYER(keycode), 10);
-      append_char(',');
-      append_keycode(QK_LAYER_TAP_GET_TAP_KEYCODE(keycode));
-      append_char(')');
+      append_P(w, PSTR("LT("));
+      append_number(w, QK_LAYER_TAP_GET_LAYER(keycode), 10);
+      append_char(w, ',');
+      append_keycode(w, QK_LAYER_TAP_GET_TAP_KEYCODE(keycode));
+      append_char(w, ')');
       return;
 
     case QK_LAYER_MOD ... QK_LAYER_MOD_MAX:  // LM(layer,mod) key.
-      append_P(PSTR("LM("));
-      append_number(QK_LAYER_MOD_GET_LAYER(keycode), 10);
-      append_char(',');
-      append_5_bit_mods(QK_LAYER_MOD_GET_MODS(keycode));
-      append_char(')');
+      append_P(w, PSTR("LM("));
+      append_number(w, QK_LAYER_MOD_GET_LAYER(keycode), 10);
+      append_char(w, ',');
+      append_5_bit_mods(w, QK_LAYER_MOD_GET_MODS(keycode));
+      append_char(w, ')');
       return;
 
     case QK_TO ... QK_TO_MAX:  // TO(layer) key.
-      append_unary_keycode(PSTR("TO"),
-                           number_string(QK_TO_GET_LAYER(keycode), 10));
+      append_unary_keycode(w, PSTR("TO"), QK_TO_GET_LAYER(keycode), 10);
       return;
 
     case QK_MOMENTARY ... QK_MOMENTARY_MAX:  // MO(layer) key.
-      append_unary_keycode(PSTR("MO"),
-                           number_string(QK_MOMENTARY_GET_LAYER(keycode), 10));
+      append_unary_keycode(w, PSTR("MO"), QK_MOMENTARY_GET_LAYER(keycode),
+                           10);
       return;
 
     case QK_DEF_LAYER ... QK_DEF_LAYER_MAX:  // DF(layer) key.
-      append_unary_keycode(PSTR("DF"),
-                           number_string(QK_DEF_LAYER_GET_LAYER(keycode), 10));
+      append_unary_keycode(w, PSTR("DF"), QK_DEF_LAYER_GET_LAYER(keycode),
+                           10);
       return;
 
     case QK_TOGGLE_LAYER ... QK_TOGGLE_LAYER_MAX:  // TG(layer) key.
-      append_unary_keycode(
-          PSTR("TG"), number_string(QK_TOGGLE_LAYER_GET_LAYER(keycode), 10));
+      append_unary_keycode(w, PSTR("TG"),
+                           QK_TOGGLE_LAYER_GET_LAYER(keycode), 10);
       return;
 
     case QK_ONE_SHOT_LAYER ... QK_ONE_SHOT_LAYER_MAX:  // OSL(layer) key.
-      append_unary_keycode(
-          PSTR("OSL"), number_string(QK_ONE_SHOT_LAYER_GET_LAYER(keycode), 10));
+      append_unary_keycode(w, PSTR("OSL"),
+                           QK_ONE_SHOT_LAYER_GET_LAYER(keycode), 10);
       return;
 
     case QK_LAYER_TAP_TOGGLE ... QK_LAYER_TAP_TOGGLE_MAX:  // TT(layer) key.
-      append_unary_keycode(
-          PSTR("TT"),
-          number_string(QK_LAYER_TAP_TOGGLE_GET_LAYER(keycode), 10));
+      append_unary_keycode(w, PSTR("TT"),
+                           QK_LAYER_TAP_TOGGLE_GET_LAYER(keycode), 10);
       return;
 
     // PDF(layer) key.
     case QK_PERSISTENT_DEF_LAYER ... QK_PERSISTENT_DEF_LAYER_MAX:
-      append_unary_keycode(
-          PSTR("PDF"),
-          number_string(QK_PERSISTENT_DEF_LAYER_GET_LAYER(keycode), 10));
+      append_unary_keycode(w, PSTR("PDF"),
+                           QK_PERSISTENT_DEF_LAYER_GET_LAYER(keycode), 10);
       return;
 
     // Mod-tap MT(mod,kc) key. This implementation formats the MT keys where
@@ -341,66 +383,73 @@ static void append_keycode(uint16_t keycode) {
       const bool is_rhs = mods > 15;
       mods &= 15;
       if (mods != 0 && (mods & (mods - 1)) == 0) {  // One mod is set.
-        append_char(is_rhs ? 'R' : 'L');
-        append_P(mod_names[biton(mods)]);
-        append_P(PSTR("_T("));
+        append_char(w, is_rhs ? 'R' : 'L');
+        append_P(w, mod_names[biton(mods)]);
+        append_P(w, PSTR("_T("));
       } else {
-        append_P(PSTR("MT("));
-        append_number(mods, 16);
-        append_char(',');
+        append_P(w, PSTR("MT("));
+        append_number(w, mods, 16);
+        append_char(w, ',');
       }
-      append_keycode(QK_MOD_TAP_GET_TAP_KEYCODE(keycode));
-      append_char(')');
+      append_keycode(w, QK_MOD_TAP_GET_TAP_KEYCODE(keycode));
+      append_char(w, ')');
     }
       return;
 
 #ifdef TAP_DANCE_ENABLE
     case QK_TAP_DANCE ... QK_TAP_DANCE_MAX:  // Tap dance TD(i) key.
-      append_unary_keycode(PSTR("TD"),
-                           number_string(QK_TAP_DANCE_GET_INDEX(keycode), 10));
+      append_unary_keycode(w, PSTR("TD"), QK_TAP_DANCE_GET_INDEX(keycode),
+                           10);
       return;
 #endif  // TAP_DANCE_ENABLE
 
 #ifdef UNICODE_ENABLE
     case QK_UNICODE ... QK_UNICODE_MAX:  // Unicode UC(codepoint) key.
-      append_unary_keycode(
-          PSTR("UC"), number_string(QK_UNICODE_GET_CODE_POINT(keycode), 16));
+      append_unary_keycode(w, PSTR("UC"),
+                           QK_UNICODE_GET_CODE_POINT(keycode), 16);
       return;
 #elif defined(UNICODEMAP_ENABLE)
     case QK_UNICODEMAP ... QK_UNICODEMAP_MAX:  // Unicode Map UM(i) key.
-      append_unary_keycode(PSTR("UM"),
-                           number_string(QK_UNICODEMAP_GET_INDEX(keycode), 10));
+      append_unary_keycode(w, PSTR("UM"), QK_UNICODEMAP_GET_INDEX(keycode),
+                           10);
       return;
 
     case QK_UNICODEMAP_PAIR ... QK_UNICODEMAP_PAIR_MAX: {  // UP(i,j) key.
       const uint8_t i = QK_UNICODEMAP_PAIR_GET_UNSHIFTED_INDEX(keycode);
       const uint8_t j = QK_UNICODEMAP_PAIR_GET_SHIFTED_INDEX(keycode);
-      append_P(PSTR("UP("));
-      append_number(i, 10);
-      append_char(',');
-      append_number(j, 10);
-      append_char(')');
+      append_P(w, PSTR("UP("));
+      append_number(w, i, 10);
+      append_char(w, ',');
+      append_number(w, j, 10);
+      append_char(w, ')');
     }
-      return dest;
+      return;
 #endif
 
     case KB_KEYCODE_RANGE:  // Keyboard range keycode.
-      append_P(PSTR("QK_KB_"));
-      append_number(keycode - QK_KB_0, 10);
+      append_P(w, PSTR("QK_KB_"));
+      append_number(w, keycode - QK_KB_0, 10);
       return;
 
     case USER_KEYCODE_RANGE:  // User range keycode.
-      append_P(PSTR("QK_USER_"));
-      append_number(keycode - QK_USER_0, 10);
+      append_P(w, PSTR("QK_USER_"));
+      append_number(w, keycode - QK_USER_0, 10);
       return;
   }
 
-  append_number(keycode, 16);  // Fallback: write keycode as hex value.
+  append_number(w, keycode, 16);  // Fallback: write keycode as hex value.
+}
+
+char* keycode_string_r(uint16_t keycode, char* dest, uint8_t size) {
+  if (size == 0) {
+    return dest;
+  }
+  writer_t w = {dest, 0, (uint8_t)(size - 1)};
+  dest[0] = '\0';
+  append_keycode(&w, keycode);
+  return dest;
 }
 
 const char* keycode_string(uint16_t keycode) {
-  buffer_len = 0;
-  buffer[0] = '\0';
-  append_keycode(keycode);
-  return buffer;
+  return keycode_string_r(keycode, buffer, sizeof(buffer));
 }
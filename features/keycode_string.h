@@ -52,6 +52,8 @@ extern "C" {
  *
  * @note The returned char* string should be used right away. The string memory
  * is reused and will be overwritten by the next call to `keycode_string()`.
+ * To format several keycodes at once, e.g. in one `xprintf()` call, use
+ * `keycode_string_r()` with a buffer for each.
  *
  * Many common QMK keycodes are understood by this function, but not all.
  * Recognized keycodes include:
@@ -89,8 +91,65 @@ extern "C" {
  */
 const char* keycode_string(uint16_t keycode);
 
+/** Buffer size used by `keycode_string()`, enough for most keycodes. */
+#ifndef KEYCODE_STRING_BUFFER_SIZE
+#define KEYCODE_STRING_BUFFER_SIZE 32
+#endif  // KEYCODE_STRING_BUFFER_SIZE
+
+/**
+ * @brief Formats a QMK keycode into a caller-provided buffer.
+ *
+ * Same as `keycode_string()`, but writes to `dest`, so that the result stays
+ * valid across other calls. The string is truncated if longer than `size - 1`
+ * chars. Example:
+ *
+ *     char a[KEYCODE_STRING_BUFFER_SIZE];
+ *     char b[KEYCODE_STRING_BUFFER_SIZE];
+ *     xprintf("%s -> %s\n", keycode_string_r(from, a, sizeof(a)),
+ *             keycode_string_r(to, b, sizeof(b)));
+ *
+ * @param keycode  QMK keycode.
+ * @param dest     Destination buffer.
+ * @param size     Size of the destination buffer in bytes.
+ * @return         `dest`.
+ */
+char* keycode_string_r(uint16_t keycode, char* dest, uint8_t size);
+
 #define KEYCODE_STRING_NAME(kc) {(kc), PSTR(#kc)}
 #define KEYCODE_STRING_NAMES_END {0, NULL}
+#define KEYCODE_STRING_NAME_ENTRY(kc) KEYCODE_STRING_NAME(kc),
+
+// Helpers for KEYCODE_STRING_CHECK_SORTED. Each entry opens a block that
+// asserts its keycode is greater than `keycode_string_last_` of the enclosing
+// block, then shadows `keycode_string_last_` with its own keycode.
+#define KEYCODE_STRING_CHECK_OPEN_(kc)                               \
+  {                                                                  \
+    _Static_assert((long)(kc) > (long)keycode_string_last_,          \
+                   "Keycode names must be sorted by keycode: " #kc); \
+    enum { keycode_string_last_ = (kc) };
+#define KEYCODE_STRING_CHECK_CLOSE_(kc) }
+
+/**
+ * Asserts at compile time that X-macro list `names` of keycodes is strictly
+ * increasing, as required for the name tables.
+ */
+#define KEYCODE_STRING_CHECK_SORTED(names)                                 \
+  static inline void keycode_string_check_sorted_##names(void) {         \
+    enum { keycode_string_last_ = -1 };                                  \
+    names(KEYCODE_STRING_CHECK_OPEN_) names(KEYCODE_STRING_CHECK_CLOSE_) \
+  }
+
+/**
+ * Defines the `custom_keycode_names` table from X-macro list `names`, and
+ * asserts at compile time that it is sorted by keycode. For example:
+ *
+ *     #define MY_KEYCODE_NAMES(X) X(KC_EXLM) X(MYMACRO1) X(MYMACRO2)
+ *     KEYCODE_STRING_CUSTOM_NAMES(MY_KEYCODE_NAMES);
+ */
+#define KEYCODE_STRING_CUSTOM_NAMES(names)                         \
+  KEYCODE_STRING_CHECK_SORTED(names)                               \
+  const keycode_string_name_t custom_keycode_names[] = {           \
+      names(KEYCODE_STRING_NAME_ENTRY) KEYCODE_STRING_NAMES_END}
 
 /** Defines a human-readable name for a keycode. */
 typedef struct {
@@ -101,7 +160,12 @@ typedef struct {
 /**
  * @brief Names for additional keycodes for `keycode_string()`.
  *
- * @note The table *must* end with `KEYCODE_STRING_NAMES_END`.
+ * @note The table *must* end with `KEYCODE_STRING_NAMES_END`. Entries should
+ * be sorted by keycode, with no keycode listed twice, so that names are found
+ * by binary search. This is checked once on first use, and a table that is not
+ * sorted is searched linearly instead, which is slower but gives the same
+ * names. Defining the table with `KEYCODE_STRING_CUSTOM_NAMES` checks the
+ * order at compile time.
  *
  * Define the `custom_keycode_names` table in your keymap.c to add names for
  * additional keycodes to `keycode_string()`. This table may also be used to
@@ -109,14 +173,18 @@ typedef struct {
  * keymap.c defines `MYMACRO1` and `MYMACRO2` as custom keycodes:
  *
  *     const keycode_string_name_t custom_keycode_names[] = {
+ *       KEYCODE_STRING_NAME(KC_EXLM),
  *       KEYCODE_STRING_NAME(MYMACRO1),
  *       KEYCODE_STRING_NAME(MYMACRO2),
- *       KEYCODE_STRING_NAME(KC_EXLM),
  *       KEYCODE_STRING_NAMES_END // End of table sentinel.
  *     };
  *
  * The above defines names for `MYMACRO1` and `MYMACRO2`, and overrides
- * `KC_EXLM` to format as "KC_EXLM" instead of the default "S(KC_1)".
+ * `KC_EXLM` to format as "KC_EXLM" instead of the default "S(KC_1)". The same
+ * table with the order checked is
+ *
+ *     #define MY_KEYCODE_NAMES(X) X(KC_EXLM) X(MYMACRO1) X(MYMACRO2)
+ *     KEYCODE_STRING_CUSTOM_NAMES(MY_KEYCODE_NAMES);
  */
 extern const keycode_string_name_t custom_keycode_names[];
 
@@ -22,6 +22,10 @@
 
 #include "layer_lock.h"
 
+#ifdef SCHEDULER_ENABLE
+#include "scheduler.h"
+#endif  // SCHEDULER_ENABLE
+
 #pragma message \
     "Layer Lock is now a core QMK feature! To use it, update your QMK set up and see https://docs.qmk.fm/features/layer_lock"
 
@@ -33,11 +37,33 @@ static layer_state_t locked_layers = 0;
 #if LAYER_LOCK_IDLE_TIMEOUT > 0
 static uint32_t layer_lock_timer = 0;
 
+#ifdef SCHEDULER_ENABLE
+// Wakes `layer_lock_task()` when the idle timer expires. Since scheduler
+// deadlines are limited to half the 16-bit timer period, longer timeouts are
+// waited out in steps of at most 30 seconds.
+static void schedule_task(void) {
+  const uint32_t elapsed = timer_elapsed32(layer_lock_timer);
+  uint32_t delay_ms =
+      (elapsed <= LAYER_LOCK_IDLE_TIMEOUT) ? LAYER_LOCK_IDLE_TIMEOUT - elapsed
+                                           : 0;
+  if (delay_ms > 30000) {
+    delay_ms = 30000;
+  }
+  // + 1, since the timeout is reached once the elapsed time exceeds it.
+  scheduler_wake(SCHEDULER_TASK_LAYER_LOCK, layer_lock_task, delay_ms + 1);
+}
+#else
+#define schedule_task()
+#endif  // SCHEDULER_ENABLE
+
 void layer_lock_task(void) {
-  if (locked_layers &&
-      timer_elapsed32(layer_lock_timer) > LAYER_LOCK_IDLE_TIMEOUT) {
-    layer_lock_all_off();
-    layer_lock_timer = timer_read32();
+  if (locked_layers) {
+    if (timer_elapsed32(layer_lock_timer) > LAYER_LOCK_IDLE_TIMEOUT) {
+      layer_lock_all_off();
+      layer_lock_timer = timer_read32();
+    } else {
+      schedule_task();  // The timer was reset since the last wake up.
+    }
   }
 }
 #endif  // LAYER_LOCK_IDLE_TIMEOUT > 0
@@ -57,6 +83,9 @@ bool process_layer_lock(uint16_t keycode, keyrecord_t* record,
                         uint16_t lock_keycode) {
 #if LAYER_LOCK_IDLE_TIMEOUT > 0
   layer_lock_timer = timer_read32();
+  if (locked_layers) {
+    schedule_task();
+  }
 #endif  // LAYER_LOCK_IDLE_TIMEOUT > 0
 
   // The intention is that locked layers remain on. If something outside of
@@ -121,6 +150,7 @@ void layer_lock_invert(uint8_t layer) {
     layer_on(layer);
 #if LAYER_LOCK_IDLE_TIMEOUT > 0
     layer_lock_timer = timer_read32();
+    schedule_task();
 #endif  // LAYER_LOCK_IDLE_TIMEOUT > 0
   } else {  // Layer is being unlocked.
     layer_off(layer);
@@ -127,7 +127,8 @@ void layer_lock_set_user(layer_state_t locked_layers);
  *
  * If using `LAYER_LOCK_IDLE_TIMEOUT`, call this function from your
  * `housekeeping_task_user()` function in keymap.c. (If no timeout is set,
- * calling `layer_lock_task()` has no effect.)
+ * calling `layer_lock_task()` has no effect.) Or with `SCHEDULER_ENABLE`, call
+ * `scheduler_task()`, which runs this only when the timeout may have expired.
  */
 #if LAYER_LOCK_IDLE_TIMEOUT > 0
 void layer_lock_task(void);
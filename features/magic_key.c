@@ -0,0 +1,190 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file magic_key.c
+ * @brief Magic key implementation
+ *
+ * The context is a buffer of tokens, each a basic keycode, or'd with QK_LSFT if
+ * typed with Shift. This is the same encoding as `S(kc)`. A key typed by the
+ * Magic key itself is preceded by a QK_AREP token.
+ *
+ * The generated trie is a uint16_t array of nodes. Each node is
+ *
+ *     output, num_children, token_1, child_1, ..., token_n, child_n
+ *
+ * where `output` is the keycode for the context spelled by the path to the
+ * node, or KC_NO if there is none, and `child_i` is the array offset of the
+ * child node for `token_i`. The root node is at offset 0. Paths are spelled
+ * backwards, starting from the most recent key.
+ */
+
+#include "magic_key.h"
+
+#if !defined(IS_QK_MOD_TAP)
+// Attempt to detect out-of-date QMK installation, which would fail with
+// implicit-function-declaration errors in the code below.
+#error "magic_key: QMK version is too old to build. Please update QMK."
+#else
+
+static uint16_t context[MAGIC_KEY_CONTEXT_SIZE] = {0};
+static uint8_t context_len = 0;
+
+static void context_add(uint16_t token) {
+  if (context_len >= MAGIC_KEY_CONTEXT_SIZE) {
+    memmove(context, context + 1,
+            (MAGIC_KEY_CONTEXT_SIZE - 1) * sizeof(uint16_t));
+    context_len = MAGIC_KEY_CONTEXT_SIZE - 1;
+  }
+  context[context_len++] = token;
+}
+
+void magic_key_context_clear(void) { context_len = 0; }
+
+bool process_magic_key(uint16_t keycode, keyrecord_t* record) {
+  if (!record->event.pressed) {
+    return true;
+  }
+
+  // Unpack tapping keycode for tap-hold keys. Holds are ignored.
+  switch (keycode) {
+#ifndef NO_ACTION_TAPPING
+    case QK_MOD_TAP ... QK_MOD_TAP_MAX:
+      if (record->tap.count == 0) {
+        return true;
+      }
+      keycode = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+      break;
+#ifndef NO_ACTION_LAYER
+    case QK_LAYER_TAP ... QK_LAYER_TAP_MAX:
+      if (record->tap.count == 0) {
+        return true;
+      }
+      keycode = QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+      break;
+#endif  // NO_ACTION_LAYER
+#endif  // NO_ACTION_TAPPING
+  }
+
+  uint8_t mods = get_mods() | get_weak_mods();
+#ifndef NO_ACTION_ONESHOT
+  mods |= get_oneshot_mods();
+#endif  // NO_ACTION_ONESHOT
+  if (IS_QK_MODS(keycode)) {  // Unpack modifier + basic key.
+    const uint8_t key_mods = QK_MODS_GET_MODS(keycode);
+    if ((key_mods & ~MOD_RSFT) != 0) {
+      mods |= MOD_BIT(KC_LCTL);  // Mods other than Shift make a hotkey.
+    } else if ((key_mods & MOD_LSFT) != 0) {
+      mods |= MOD_BIT(KC_LSFT);
+    }
+    keycode = QK_MODS_GET_BASIC_KEYCODE(keycode);
+  }
+
+  if ((mods & ~MOD_MASK_SHIFT) != 0) {
+    magic_key_context_clear();  // Hotkeys clear the context.
+    return true;
+  }
+
+  switch (keycode) {
+    case KC_A ... KC_0:
+    case KC_ENT:
+    case KC_TAB:
+    case KC_SPC ... KC_SLSH:
+#ifdef REPEAT_KEY_ENABLE
+      if (get_repeat_key_count() < 0) {
+        context_add(QK_AREP);  // Typed by the Magic key.
+      }
+#endif  // REPEAT_KEY_ENABLE
+      context_add(keycode | ((mods & MOD_MASK_SHIFT) ? QK_LSFT : 0));
+      break;
+
+    case KC_BSPC:
+      if (context_len > 0) {
+        --context_len;
+      }
+      if (context_len > 0 && context[context_len - 1] == QK_AREP) {
+        --context_len;  // Remove the key's QK_AREP token with it.
+      }
+      break;
+
+    case KC_LCTL ... KC_RGUI:  // Mod keys.
+    case QK_REP:
+    case QK_AREP:
+    case QK_USER ... QK_USER_MAX:  // Macros.
+      break;
+
+    default:
+      magic_key_context_clear();
+  }
+
+  return true;
+}
+
+void magic_key_context_add_string_P(const char* str) {
+  for (char c; (c = pgm_read_byte(str)) != '\0'; ++str) {
+    if ('a' <= c && c <= 'z') {
+      context_add(KC_A + (c - 'a'));
+    } else if ('A' <= c && c <= 'Z') {
+      context_add(S(KC_A + (c - 'A')));
+    } else {
+      switch (c) {
+        case ' ': context_add(KC_SPC); break;
+        case '.': context_add(KC_DOT); break;
+        case '/': context_add(KC_SLSH); break;
+        case '=': context_add(KC_EQL); break;
+        default: magic_key_context_clear();
+      }
+    }
+  }
+}
+
+// Returns the offset of `node`'s child for `token`, or 0 if there is none.
+static uint16_t find_child(const uint16_t* data, uint16_t node,
+                           uint16_t token) {
+  const uint16_t num_children = pgm_read_word(data + node + 1);
+  const uint16_t* children = data + node + 2;
+  for (uint16_t i = 0; i < num_children; ++i) {
+    if (pgm_read_word(children + 2 * i) == token) {
+      return pgm_read_word(children + 2 * i + 1);
+    }
+  }
+  return 0;
+}
+
+uint16_t magic_key_lookup(const uint16_t* data) {
+  uint16_t output = KC_NO;
+  uint16_t node = 0;
+
+  for (int8_t i = context_len - 1; i >= 0; --i) {
+    const uint16_t token = context[i];
+    uint16_t child = find_child(data, node, token);
+    if (!child && (token & QK_LSFT) &&
+        KC_A <= (token & 0xff) && (token & 0xff) <= KC_Z) {
+      child = find_child(data, node, token & 0xff);  // Try unshifted letter.
+    }
+    if (!child) {
+      break;
+    }
+
+    node = child;
+    const uint16_t node_output = pgm_read_word(data + node);
+    if (node_output != KC_NO) {
+      output = node_output;  // Longest match so far.
+    }
+  }
+
+  return output;
+}
+
+#endif  // version check
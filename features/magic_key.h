@@ -0,0 +1,116 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file magic_key.h
+ * @brief Magic key: context-dependent alternate key from the last few keys.
+ *
+ * Overview
+ * --------
+ *
+ * A "magic" key is an Alternate Repeat Key whose output depends on what was
+ * just typed, used to remove same-finger bigrams and type common n-grams. Core
+ * Repeat Key only remembers the single last key, so longer patterns like
+ * "ion" + magic -> "ions" are out of reach. This library keeps a small buffer
+ * of the last MAGIC_KEY_CONTEXT_SIZE typed keys, and looks up the alternate key
+ * from the longest matching context in a trie.
+ *
+ * The trie is generated from a rule file with make_magic_key_data.py, in the
+ * same way as Autocorrection's dictionary. Each rule has the syntax
+ * "context -> output", for instance:
+ *
+ *     a    -> KC_O
+ *     i    -> M_ION
+ *     ion  -> KC_S
+ *     \mo  -> KC_N
+ *
+ * where `\m` matches the Magic key, so that the last rule applies when "o" was
+ * typed by the Magic key rather than by its own key.
+ *
+ * The output is a keycode expression and may use custom keycodes. Since the
+ * generated table refers to them, include the generated header in keymap.c
+ * after your custom keycodes are defined, and pass the table to the lookup:
+ *
+ *     #include "features/magic_key.h"
+ *     // After enum custom_keycodes...
+ *     #include "features/magic_key_data.h"
+ *
+ *     bool process_record_user(uint16_t keycode, keyrecord_t* record) {
+ *       if (!process_magic_key(keycode, record)) { return false; }
+ *       // Your macros...
+ *       return true;
+ *     }
+ *
+ *     uint16_t get_alt_repeat_key_keycode_user(uint16_t keycode,
+ *                                              uint8_t mods) {
+ *       if ((mods & ~MOD_MASK_SHIFT) == 0) {
+ *         const uint16_t magic = magic_key_lookup(magic_key_data);
+ *         if (magic != KC_NO) { return magic; }
+ *       }
+ *       return KC_TRNS;
+ *     }
+ *
+ * Lookup cost is bounded by the context size: one trie step per buffered key.
+ */
+
+#pragma once
+
+#include "quantum.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of recently typed keys kept as context. This must be at least the
+// longest context in the rule file.
+#ifndef MAGIC_KEY_CONTEXT_SIZE
+#define MAGIC_KEY_CONTEXT_SIZE 8
+#endif  // MAGIC_KEY_CONTEXT_SIZE
+
+/**
+ * Handler function for the magic key.
+ *
+ * Call this function from `process_record_user()` to track the typed context.
+ * It observes events and always returns true.
+ *
+ * Typing keys (letters, digits, space, enter, tab, and punctuation) are
+ * appended to the context, with Shift, and marked if typed by the Alternate
+ * Repeat Key. Backspace removes the last key. Keys in
+ * the user range (macros) are ignored; macros that type text can add it with
+ * `magic_key_context_add_string_P()`. Other keys, or pressing with Ctrl, Alt,
+ * or GUI, clear the context.
+ */
+bool process_magic_key(uint16_t keycode, keyrecord_t* record);
+
+/**
+ * Looks up the alternate keycode for the current context.
+ *
+ * The context is matched against the rules backwards from the most recent
+ * key, and the output of the longest matching rule is returned. A shifted
+ * letter falls back to matching the unshifted letter.
+ *
+ * @param data  Generated trie, `magic_key_data` from magic_key_data.h.
+ * @return The alternate keycode, or KC_NO if no rule matches.
+ */
+uint16_t magic_key_lookup(const uint16_t* data);
+
+/** Appends the keys typed by ASCII string `str`, stored in PROGMEM. */
+void magic_key_context_add_string_P(const char* str);
+
+/** Clears the context. */
+void magic_key_context_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,91 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Generated code.
+
+// Magic key rules (52 entries):
+//   !     -> KC_EQL
+//   "     -> M_DOCSTR
+//   #     -> M_INCLUDE
+//   %     -> KC_EQL
+//   &     -> KC_EQL
+//   '     -> M_NOOP
+//   *     -> KC_EQL
+//   +     -> KC_EQL
+//   ,     -> M_NOOP
+//   -     -> KC_EQL
+//   .     -> M_UPDIR
+//   /     -> KC_SLSH
+//   <     -> KC_MINS
+//   =     -> M_EQEQ
+//   >     -> KC_EQL
+//   I     -> KC_QUOT
+//   \ma   -> KC_N
+//   \me   -> KC_N
+//   \mi   -> KC_N
+//   \mo   -> KC_N
+//   \mu   -> KC_N
+//   \my   -> KC_N
+//   \n    -> M_THE
+//   \s    -> M_THE
+//   \sthe -> KC_N
+//   \t    -> M_THE
+//   ^     -> KC_EQL
+//   `     -> M_MKGRVS
+//   a     -> KC_O
+//   c     -> KC_Y
+//   d     -> KC_Y
+//   e     -> KC_U
+//   ent   -> KC_S
+//   f     -> M_NOOP
+//   g     -> KC_Y
+//   i     -> M_ION
+//   ion   -> KC_S
+//   l     -> KC_K
+//   m     -> M_MENT
+//   n     -> KC_N
+//   o     -> KC_A
+//   p     -> KC_Y
+//   q     -> M_QUEN
+//   r     -> KC_L
+//   s     -> KC_K
+//   t     -> M_TMENT
+//   u     -> KC_E
+//   uen   -> KC_C
+//   v     -> M_NOOP
+//   y     -> KC_P
+//   |     -> KC_EQL
+//   ~     -> KC_EQL
+
+#define MAGIC_KEY_DATA_MAX_CONTEXT 4
+
+static const uint16_t magic_key_data[230] PROGMEM = {KC_NO, 42, 0x0004, 86,
+    0x0006, 90, 0x0007, 92, 0x0008, 94, 0x0009, 100, 0x000A, 102, 0x000C, 104,
+    0x000F, 108, 0x0010, 110, 0x0011, 112, 0x0012, 118, 0x0013, 122, 0x0014,
+    124, 0x0015, 126, 0x0016, 128, 0x0017, 130, 0x0018, 134, 0x0019, 138,
+    0x001C, 140, 0x0028, 144, 0x002B, 146, 0x002C, 148, 0x002D, 150, 0x002E,
+    152, 0x0034, 154, 0x0035, 156, 0x0036, 158, 0x0037, 160, 0x0038, 162,
+    0x020C, 164, 0x021E, 166, 0x0220, 168, 0x0222, 170, 0x0223, 172, 0x0224,
+    174, 0x0225, 176, 0x022E, 178, 0x0231, 180, 0x0234, 182, 0x0235, 184,
+    0x0236, 186, 0x0237, 188, KC_O, 1, QK_AREP, 190, KC_Y, 0, KC_Y, 0, KC_U, 2,
+    0x000B, 192, QK_AREP, 196, M_NOOP, 0, KC_Y, 0, M_ION, 1, QK_AREP, 198, KC_K,
+    0, M_MENT, 0, KC_N, 2, 0x0008, 200, 0x0012, 204, KC_A, 1, QK_AREP, 208,
+    KC_Y, 0, M_QUEN, 0, KC_L, 0, KC_K, 0, M_TMENT, 1, 0x0011, 210, KC_E, 1,
+    QK_AREP, 214, M_NOOP, 0, KC_P, 1, QK_AREP, 216, M_THE, 0, M_THE, 0, M_THE,
+    0, KC_EQL, 0, M_EQEQ, 0, M_NOOP, 0, M_MKGRVS, 0, M_NOOP, 0, M_UPDIR, 0,
+    KC_SLSH, 0, KC_QUOT, 0, KC_EQL, 0, M_INCLUDE, 0, KC_EQL, 0, KC_EQL, 0,
+    KC_EQL, 0, KC_EQL, 0, KC_EQL, 0, KC_EQL, 0, M_DOCSTR, 0, KC_EQL, 0, KC_MINS,
+    0, KC_EQL, 0, KC_N, 0, KC_NO, 1, 0x0017, 218, KC_N, 0, KC_N, 0, KC_NO, 1,
+    0x0018, 222, KC_NO, 1, 0x000C, 224, KC_N, 0, KC_NO, 1, 0x0008, 226, KC_N, 0,
+    KC_N, 0, KC_NO, 1, 0x002C, 228, KC_C, 0, KC_S, 0, KC_S, 0, KC_N, 0};
@@ -0,0 +1,246 @@
+# Copyright 2025 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Python program to make just_typed_data.h.
+
+This program reads "just_typed_dict.txt" from the current directory and
+generates a C source file "just_typed_data.h" with a multi-pattern matching
+automaton embedded as an array. Run this program without arguments like
+
+$ python3 make_just_typed_data.py
+
+Or specify a dict file as the first argument like
+
+$ python3 make_just_typed_data.py mykeymap/dict.txt
+
+The output is written to "just_typed_data.h" in the same directory as the
+dictionary. Or optionally specify the output .h file as well like
+
+$ python3 make_just_typed_data.py dict.txt somewhere/out.h
+
+Each line of the dict file defines one pattern with the syntax
+"pattern -> NAME". The pattern is written as in magic_key_dict.txt: as the
+characters typed on a US layout, with \\s, \\n, \\t for space, enter and tab.
+Letters match regardless of case. NAME is an identifier for which the
+generated header defines a bit `JUST_TYPED_<NAME>`, set in the match mask when
+the pattern has just been typed. Several patterns may share a NAME, and up to
+32 distinct names may be used. Example:
+
+    \\svs.   -> ABBREV
+    \\setc.  -> ABBREV
+    \\sbtw   -> BTW
+
+The automaton is an Aho-Corasick trie: each node holds a failure link to the
+node of its longest proper suffix that is also in the trie, and the mask of
+all patterns that are suffixes of its path, so one step per key reports every
+pattern completed by that key.
+"""
+
+import os.path
+import re
+import sys
+import textwrap
+from typing import Any, Dict, List, Tuple
+
+from make_magic_key_data import (CHAR_KEYCODES, LICENSE_HEADER,
+                                 format_context, parse_file_lines)
+
+QK_LSFT = 0x0200
+KC_A = 0x04
+KC_Z = 0x1d
+
+MAX_NAMES = 32
+
+
+def char_token(c: str) -> int:
+  """Gets the token for char `c`. Letters are matched without Shift."""
+  code, shifted = CHAR_KEYCODES[c]
+  if KC_A <= code <= KC_Z:
+    return code
+  return code | (QK_LSFT if shifted else 0)
+
+
+def parse_file(file_name: str) -> Tuple[List[Tuple[str, str]], List[str]]:
+  """Parses just typed patterns file.
+
+  Args:
+    file_name: String, path of the patterns file.
+  Returns:
+    (patterns, names) where patterns is a list of (pattern, name) tuples and
+    names is the list of distinct names in order of first appearance.
+  """
+  patterns = []
+  names = []
+  seen = set()
+  for line_number, pattern, name in parse_file_lines(file_name):
+    if not re.fullmatch(r'[A-Z][A-Z0-9_]*', name):
+      print(f'Error:{line_number}: Invalid name "{name}". Names must be '
+            'uppercase identifiers.')
+      sys.exit(1)
+    key = (tuple(char_token(c) for c in pattern), name)
+    if key in seen:
+      print(f'Warning:{line_number}: Ignoring duplicate pattern: '
+            f'{repr(pattern)}')
+      continue
+    seen.add(key)
+
+    if name not in names:
+      if len(names) >= MAX_NAMES:
+        print(f'Error:{line_number}: Too many names, the limit is '
+              f'{MAX_NAMES}.')
+        sys.exit(1)
+      names.append(name)
+    patterns.append((pattern, name))
+
+  return patterns, names
+
+
+def make_automaton(patterns: List[Tuple[str, str]],
+                   names: List[str]) -> List[Dict[str, Any]]:
+  """Makes an Aho-Corasick automaton from the patterns.
+
+  Args:
+    patterns: List of (pattern, name) tuples.
+    names: List of distinct names; a name's index is its bit in the mask.
+  Returns:
+    List of nodes in breadth first order, with the root first. Each node is a
+    dict with 'children' (token -> node index), 'fail' (node index) and 'mask'.
+  """
+  nodes = [{'children': {}, 'fail': 0, 'mask': 0}]
+  for pattern, name in patterns:
+    node = 0
+    for c in pattern:
+      token = char_token(c)
+      children = nodes[node]['children']
+      if token not in children:
+        children[token] = len(nodes)
+        nodes.append({'children': {}, 'fail': 0, 'mask': 0})
+      node = children[token]
+    nodes[node]['mask'] |= 1 << names.index(name)
+
+  # Compute failure links in breadth first order, and renumber the nodes in
+  # that order so that the serialized offsets of parents precede children.
+  order = [0]
+  i = 0
+  while i < len(order):
+    node = nodes[order[i]]
+    for token, child in sorted(node['children'].items()):
+      fail = node['fail']
+      if order[i] == 0:
+        fail = 0
+      else:
+        while fail and token not in nodes[fail]['children']:
+          fail = nodes[fail]['fail']
+        fail = nodes[fail]['children'].get(token, 0)
+      nodes[child]['fail'] = fail
+      # Patterns ending at the failure node also end here.
+      nodes[child]['mask'] |= nodes[fail]['mask']
+      order.append(child)
+    i += 1
+
+  index_of = {old: new for new, old in enumerate(order)}
+  return [{'children': {token: index_of[child]
+                        for token, child in nodes[old]['children'].items()},
+           'fail': index_of[nodes[old]['fail']],
+           'mask': nodes[old]['mask']} for old in order]
+
+
+def serialize_automaton(nodes: List[Dict[str, Any]]) -> List[str]:
+  """Serializes the automaton as a list of C expressions for a uint16_t array.
+
+  Each node is serialized as "fail, mask low word, mask high word,
+  num_children" followed by the pairs "token, child offset", with the root at
+  offset 0.
+
+  Args:
+    nodes: List of nodes from make_automaton().
+  Returns:
+    List of strings, each a C expression.
+  """
+  offsets = [0]
+  for node in nodes:
+    offsets.append(offsets[-1] + 4 + 2 * len(node['children']))
+
+  if offsets[-1] > 0xffff:
+    print('Error: The just typed table is too large, exceeding 64K entries.')
+    sys.exit(1)
+
+  data = []
+  for node in nodes:
+    children = sorted(node['children'].items())
+    data += [str(offsets[node['fail']]),
+             f'0x{node["mask"] & 0xffff:04X}',
+             f'0x{node["mask"] >> 16:04X}',
+             str(len(children))]
+    for token, child in children:
+      data += [f'0x{token:04X}', str(offsets[child])]
+
+  return data
+
+
+def write_generated_code(patterns: List[Tuple[str, str]],
+                         names: List[str],
+                         data: List[str],
+                         file_name: str) -> None:
+  """Writes just typed data as generated C code to `file_name`.
+
+  Args:
+    patterns: List of (pattern, name) tuples.
+    names: List of distinct names.
+    data: List of C expressions, the serialized automaton.
+    file_name: String, path of the output C file.
+  """
+  formatted = [format_context(pattern) for pattern, _ in patterns]
+  width = max(len(pattern) for pattern in formatted)
+  max_pattern = max(len(pattern) for pattern, _ in patterns)
+  name_width = max(len(name) for name in names)
+  generated_code = ''.join([
+    LICENSE_HEADER,
+    '// Generated code.\n\n',
+    f'// Just typed patterns ({len(patterns)} entries):\n',
+    ''.join(sorted(f'//   {pattern:<{width}} -> {name}\n'
+                   for pattern, (_, name) in zip(formatted, patterns))),
+    '\n',
+    ''.join(f'#define JUST_TYPED_{name:<{name_width}} (UINT32_C(1) << {i})\n'
+            for i, name in enumerate(names)),
+    f'\n#define JUST_TYPED_DATA_MAX_PATTERN {max_pattern}\n\n',
+    textwrap.fill('static const uint16_t just_typed_data[%d] PROGMEM = {%s};' % (
+      len(data), ', '.join(data)), width=80, subsequent_indent='    '),
+    '\n'])
+
+  with open(file_name, 'wt') as f:
+    f.write(generated_code)
+
+
+def get_default_h_file(dict_file: str) -> str:
+  return os.path.join(os.path.dirname(dict_file), 'just_typed_data.h')
+
+
+def main(argv):
+  dict_file = argv[1] if len(argv) > 1 else 'just_typed_dict.txt'
+  h_file = argv[2] if len(argv) > 2 else get_default_h_file(dict_file)
+
+  patterns, names = parse_file(dict_file)
+  if not patterns:
+    print(f'Error: No patterns in {dict_file}')
+    sys.exit(1)
+  nodes = make_automaton(patterns, names)
+  data = serialize_automaton(nodes)
+  print(f'Processed %d just typed patterns (%d names) to table with %d '
+        'entries.' % (len(patterns), len(names), len(data)))
+  write_generated_code(patterns, names, data, h_file)
+
+
+if __name__ == '__main__':
+  main(sys.argv)
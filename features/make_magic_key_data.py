@@ -0,0 +1,290 @@
+# Copyright 2025 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Python program to make magic_key_data.h.
+
+This program reads "magic_key_dict.txt" from the current directory and
+generates a C source file "magic_key_data.h" with a serialized trie embedded as
+an array. Run this program without arguments like
+
+$ python3 make_magic_key_data.py
+
+Or specify a dict file as the first argument like
+
+$ python3 make_magic_key_data.py mykeymap/dict.txt
+
+The output is written to "magic_key_data.h" in the same directory as the
+dictionary. Or optionally specify the output .h file as well like
+
+$ python3 make_magic_key_data.py dict.txt somewhere/out.h
+
+Each line of the dict file defines one magic key rule with the syntax
+"context -> output". When the last keys typed match `context`, the magic key
+types `output`. If several rules match, the one with the longest context wins.
+Blank lines or lines starting with '#' are ignored. Example:
+
+    a     -> KC_O
+    i     -> M_ION
+    ion   -> KC_S
+    \\sthe -> KC_N
+    \\mo   -> KC_N
+
+The context is written as the characters typed on a US layout. Uppercase
+letters and shifted symbols match keys typed with Shift, though a context with
+a lowercase letter also matches the letter typed with Shift. Write space, enter
+and tab as \\s, \\n, \\t, and write \\#, \\\\ for a literal '#' or backslash.
+Write \\m for the Magic key itself: "\\mo" matches "o" when it was typed by the
+Magic key.
+
+The output is a C keycode expression like KC_O or S(KC_N), or a custom keycode
+like M_ION. It is copied verbatim into the generated code, which is why the
+generated header must be included after custom keycodes are defined.
+"""
+
+import os.path
+import sys
+import textwrap
+from typing import Any, Dict, Iterator, List, Tuple
+
+QK_LSFT = 0x0200
+KC_A = 0x04
+
+# Map from char to (basic keycode, shifted) on a US layout.
+CHAR_KEYCODES = dict(
+  # Letters a-z and A-Z.
+  [(chr(c), (c - ord('a') + KC_A, False))
+   for c in range(ord('a'), ord('z') + 1)] +
+  [(chr(c), (c - ord('A') + KC_A, True))
+   for c in range(ord('A'), ord('Z') + 1)] +
+  # Digits and their shifted symbols.
+  [(c, (0x1e + i, False)) for i, c in enumerate('1234567890')] +
+  [(c, (0x1e + i, True)) for i, c in enumerate('!@#$%^&*()')] +
+  [
+    ('\n', (0x28, False)),  # KC_ENT
+    ('\t', (0x2b, False)),  # KC_TAB
+    (' ', (0x2c, False)),  # KC_SPC
+  ] +
+  # Punctuation keys KC_MINS through KC_SLSH and their shifted symbols.
+  [(c, (code, False)) for c, code in zip('-=[]\\', range(0x2d, 0x32))] +
+  [(c, (code, True)) for c, code in zip('_+{}|', range(0x2d, 0x32))] +
+  [(c, (code, False)) for c, code in zip(';\'`,./', range(0x33, 0x39))] +
+  [(c, (code, True)) for c, code in zip(':"~<>?', range(0x33, 0x39))]
+)
+
+LICENSE_HEADER = """\
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+"""
+
+# Stands for the Magic key in parsed contexts, written \m in the dict.
+MAGIC_CHAR = '\x01'
+MAGIC_TOKEN = 0x7C7A  # QK_AREP
+
+ESCAPES = {'s': ' ', 'n': '\n', 't': '\t', '#': '#', '\\': '\\',
+           'm': MAGIC_CHAR}
+
+
+def char_token(c: str) -> int:
+  """Gets the context token for char `c`, in the encoding of `S(kc)`."""
+  if c == MAGIC_CHAR:
+    return MAGIC_TOKEN
+  code, shifted = CHAR_KEYCODES[c]
+  return code | (QK_LSFT if shifted else 0)
+
+
+def parse_context(line_number: int, text: str) -> str:
+  """Parses a context string, resolving escape sequences."""
+  context = ''
+  i = 0
+  while i < len(text):
+    c = text[i]
+    if c == '\\':
+      if i + 1 >= len(text) or text[i + 1] not in ESCAPES:
+        print(f'Error:{line_number}: Invalid escape in "{text}"')
+        sys.exit(1)
+      c = ESCAPES[text[i + 1]]
+      i += 1
+    if c not in CHAR_KEYCODES and c != MAGIC_CHAR:
+      print(f'Error:{line_number}: Context "{text}" has unsupported char '
+            f'{repr(c)}')
+      sys.exit(1)
+    context += c
+    i += 1
+  return context
+
+
+def parse_file_lines(file_name: str) -> Iterator[Tuple[int, str, str]]:
+  """Parses lines read from `file_name` into context-output pairs."""
+
+  line_number = 0
+  for line in open(file_name, 'rt'):
+    line_number += 1
+    line = line.strip()
+    if line and line[0] != '#':
+      # Parse syntax "context -> output". Split on the last "->" since the
+      # context may itself contain "-" or ">".
+      tokens = [token.strip() for token in line.rsplit('->', 1)]
+      if len(tokens) != 2 or not tokens[0] or not tokens[1]:
+        print(f'Error:{line_number}: Invalid syntax: "{line}"')
+        sys.exit(1)
+
+      context, output = tokens
+      yield line_number, parse_context(line_number, context), output
+
+
+def parse_file(file_name: str) -> List[Tuple[str, str]]:
+  """Parses magic key rules file.
+
+  Args:
+    file_name: String, path of the rules file.
+  Returns:
+    List of (context, output) tuples.
+  """
+  rules = []
+  contexts = set()
+  for line_number, context, output in parse_file_lines(file_name):
+    if context in contexts:
+      print(f'Warning:{line_number}: Ignoring duplicate context: '
+            f'{repr(context)}')
+      continue
+
+    rules.append((context, output))
+    contexts.add(context)
+
+  return rules
+
+
+def make_trie(rules: List[Tuple[str, str]]) -> Dict[int, Any]:
+  """Makes a trie from the rule contexts, keyed by tokens in reverse.
+
+  Args:
+    rules: List of (context, output) tuples.
+  Returns:
+    Dict of dict, representing the trie. Key 'OUTPUT' holds a node's output.
+  """
+  trie = {}
+  for context, output in rules:
+    node = trie
+    for c in context[::-1]:
+      node = node.setdefault(char_token(c), {})
+    node['OUTPUT'] = output
+
+  return trie
+
+
+def serialize_trie(trie: Dict[Any, Any]) -> List[str]:
+  """Serializes the trie as a list of C expressions for a uint16_t array.
+
+  Each node is serialized as "output, num_children" followed by the pairs
+  "token, child offset", in breadth first order with the root at offset 0.
+
+  Args:
+    trie: Dict of dicts.
+  Returns:
+    List of strings, each a C expression.
+  """
+  # Assign offsets in breadth first order.
+  nodes = [trie]
+  offsets = [0]
+  i = 0
+  while i < len(nodes):
+    node = nodes[i]
+    children = sorted(k for k in node if k != 'OUTPUT')
+    nodes.extend(node[k] for k in children)
+    offsets.append(offsets[-1] + 2 + 2 * len(children))
+    i += 1
+
+  if offsets[-1] > 0xffff:
+    print('Error: The magic key table is too large, exceeding 64K entries.')
+    sys.exit(1)
+
+  data = []
+  offset_of = {id(node): offset for node, offset in zip(nodes, offsets)}
+  for node in nodes:
+    children = sorted(k for k in node if k != 'OUTPUT')
+    data += [node.get('OUTPUT', 'KC_NO'), str(len(children))]
+    for k in children:
+      token = 'QK_AREP' if k == MAGIC_TOKEN else f'0x{k:04X}'
+      data += [token, str(offset_of[id(node[k])])]
+
+  return data
+
+
+def format_context(context: str) -> str:
+  """Formats context for display in a comment."""
+  return ''.join({' ': '\\s', '\n': '\\n', '\t': '\\t',
+                  MAGIC_CHAR: '\\m'}.get(c, c) for c in context)
+
+
+def write_generated_code(rules: List[Tuple[str, str]],
+                         data: List[str],
+                         file_name: str) -> None:
+  """Writes magic key data as generated C code to `file_name`.
+
+  Args:
+    rules: List of (context, output) tuples.
+    data: List of C expressions, the serialized trie.
+    file_name: String, path of the output C file.
+  """
+  contexts = [format_context(context) for context, _ in rules]
+  width = max(len(context) for context in contexts)
+  max_context = max(len(context) for context, _ in rules)
+  generated_code = ''.join([
+    LICENSE_HEADER,
+    '// Generated code.\n\n',
+    f'// Magic key rules ({len(rules)} entries):\n',
+    ''.join(sorted(f'//   {context:<{width}} -> {output}\n'
+                   for context, (_, output) in zip(contexts, rules))),
+    f'\n#define MAGIC_KEY_DATA_MAX_CONTEXT {max_context}\n\n',
+    textwrap.fill('static const uint16_t magic_key_data[%d] PROGMEM = {%s};' % (
+      len(data), ', '.join(data)), width=80, subsequent_indent='    '),
+    '\n'])
+
+  with open(file_name, 'wt') as f:
+    f.write(generated_code)
+
+
+def get_default_h_file(dict_file: str) -> str:
+  return os.path.join(os.path.dirname(dict_file), 'magic_key_data.h')
+
+
+def main(argv):
+  dict_file = argv[1] if len(argv) > 1 else 'magic_key_dict.txt'
+  h_file = argv[2] if len(argv) > 2 else get_default_h_file(dict_file)
+
+  rules = parse_file(dict_file)
+  if not rules:
+    print(f'Error: No rules in {dict_file}')
+    sys.exit(1)
+  trie = make_trie(rules)
+  data = serialize_trie(trie)
+  print(f'Processed %d magic key rules to table with %d entries.'
+        % (len(rules), len(data)))
+  write_generated_code(rules, data, h_file)
+
+
+if __name__ == '__main__':
+  main(sys.argv)
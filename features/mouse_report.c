@@ -0,0 +1,204 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file mouse_report.c
+ * @brief Mouse report implementation
+ */
+
+#include "mouse_report.h"
+
+#ifdef SCHEDULER_ENABLE
+#include "scheduler.h"
+#endif  // SCHEDULER_ENABLE
+
+#if !defined(MOUSE_ENABLE)
+#error "mouse_report: Please set `MOUSE_ENABLE = yes` in rules.mk."
+#else
+
+// Largest magnitudes of the report fields.
+#ifdef MOUSE_EXTENDED_REPORT
+#define XY_MAX 32767
+#else
+#define XY_MAX 127
+#endif  // MOUSE_EXTENDED_REPORT
+#ifdef WHEEL_EXTENDED_REPORT
+#define HV_MAX 32767
+#else
+#define HV_MAX 127
+#endif  // WHEEL_EXTENDED_REPORT
+
+static struct {
+  // Accumulated cursor motion as Q.8 values and wheel motion as Q.6 values,
+  // including residuals not yet sent.
+  int32_t x;
+  int32_t y;
+  int32_t h;
+  int32_t v;
+  // Buttons held by each source.
+  uint8_t source_buttons[MOUSE_REPORT_NUM_SOURCES];
+  // Union of `source_buttons`.
+  uint8_t buttons;
+  // Buttons in the last report sent.
+  uint8_t sent_buttons;
+  // Time when the last report was sent.
+  uint16_t send_time;
+  // True if there is something to send.
+  bool pending;
+} state;
+
+/**
+ * Takes the whole part of fixed-point value `*acc` with `frac_bits`
+ * fractional bits, clamped to [-max, max], leaving the rest in `*acc`.
+ */
+static int16_t take_whole(int32_t* acc, uint8_t frac_bits, int16_t max) {
+  // Division truncates toward zero, so the residual has the sign of `*acc`.
+  int32_t whole = *acc / ((int32_t)1 << frac_bits);
+  if (whole > max) {
+    whole = max;
+  } else if (whole < -max) {
+    whole = -max;
+  }
+  *acc -= whole * ((int32_t)1 << frac_bits);
+  return (int16_t)whole;
+}
+
+/** Returns true if at least one whole unit of motion is accumulated. */
+static bool has_whole_motion(void) {
+  return state.x <= -256 || state.x >= 256 || state.y <= -256 ||
+         state.y >= 256 || state.h <= -64 || state.h >= 64 ||
+         state.v <= -64 || state.v >= 64;
+}
+
+/** Wakes the task in `delay_ms`, or leaves it to polling. */
+static void schedule_task(uint16_t delay_ms) {
+#ifdef SCHEDULER_ENABLE
+  scheduler_wake(SCHEDULER_TASK_MOUSE_REPORT, mouse_report_task, delay_ms);
+#endif  // SCHEDULER_ENABLE
+}
+
+/** Sends the report now, if it would change anything. */
+static void send_report(void) {
+  report_mouse_t report = {0};
+  report.buttons = state.buttons;
+  report.x = take_whole(&state.x, 8, XY_MAX);
+  report.y = take_whole(&state.y, 8, XY_MAX);
+  report.h = take_whole(&state.h, 6, HV_MAX);
+  report.v = take_whole(&state.v, 6, HV_MAX);
+
+  if (report.x || report.y || report.h || report.v ||
+      report.buttons != state.sent_buttons) {
+    host_mouse_send(&report);
+    state.sent_buttons = report.buttons;
+    state.send_time = timer_read();
+  }
+
+  // Motion beyond the range of one report remains for the next.
+  state.pending = has_whole_motion();
+  if (state.pending) {
+    schedule_task(MOUSE_REPORT_INTERVAL_MS);
+  }
+}
+
+/** Marks that there is something to send, and wakes the task. */
+static void set_pending(void) {
+  if (!state.pending) {
+    state.pending = true;
+    const uint16_t elapsed = timer_elapsed(state.send_time);
+    schedule_task(elapsed < MOUSE_REPORT_INTERVAL_MS
+                      ? MOUSE_REPORT_INTERVAL_MS - elapsed : 0);
+  }
+}
+
+void mouse_report_task(void) {
+  if (!state.pending) {
+    return;
+  }
+  const uint16_t elapsed = timer_elapsed(state.send_time);
+  if (elapsed < MOUSE_REPORT_INTERVAL_MS) {
+    schedule_task(MOUSE_REPORT_INTERVAL_MS - elapsed);
+    return;
+  }
+  send_report();
+}
+
+void mouse_report_set_buttons(uint8_t source, uint8_t buttons) {
+  state.source_buttons[source] = buttons;
+  uint8_t merged = 0;
+  for (uint8_t i = 0; i < MOUSE_REPORT_NUM_SOURCES; ++i) {
+    merged |= state.source_buttons[i];
+  }
+  const uint8_t changed = merged ^ state.buttons;
+  if (!changed) {
+    return;
+  }
+
+  // If a button whose change hasn't been sent yet would change back, the host
+  // would never see it, for instance a click by Turbo Click. Send the pending
+  // change now rather than wait out the interval.
+  if (changed & (state.buttons ^ state.sent_buttons)) {
+    send_report();
+  }
+
+#ifdef MOUSEKEY_ENABLE
+  // Mirror the changed buttons into the mouse keys report, so that reports
+  // sent by mouse keys carry them too.
+  for (uint8_t i = 0; i < 8; ++i) {
+    const uint8_t mask = 1 << i;
+    if (changed & mask) {
+      if (merged & mask) {
+        mousekey_on(MS_BTN1 + i);
+      } else {
+        mousekey_off(MS_BTN1 + i);
+      }
+    }
+  }
+#endif  // MOUSEKEY_ENABLE
+
+  state.buttons = merged;
+  set_pending();
+}
+
+void mouse_report_move(int16_t x, int16_t y) {
+  state.x += x;
+  state.y += y;
+  if (has_whole_motion()) {
+    set_pending();
+  }
+}
+
+void mouse_report_scroll(int16_t h, int16_t v) {
+  state.h += h;
+  state.v += v;
+  if (has_whole_motion()) {
+    set_pending();
+  }
+}
+
+bool process_mouse_report(uint16_t keycode, keyrecord_t* record) {
+  if (MS_BTN1 <= keycode && keycode <= MS_BTN8) {
+    const uint8_t mask = 1 << (keycode - MS_BTN1);
+    uint8_t buttons = state.source_buttons[MOUSE_REPORT_SOURCE_MOUSEKEY];
+    if (record->event.pressed) {
+      buttons |= mask;
+    } else {
+      buttons &= ~mask;
+    }
+    mouse_report_set_buttons(MOUSE_REPORT_SOURCE_MOUSEKEY, buttons);
+    return false;
+  }
+  return true;
+}
+
+#endif
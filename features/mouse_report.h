@@ -0,0 +1,125 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file mouse_report.h
+ * @brief Mouse report: one sender for buttons and motion from several sources.
+ *
+ * Overview
+ * --------
+ *
+ * Orbital Mouse, Mouse Turbo Click, and QMK's mouse keys each used to send
+ * their own mouse reports. Reports from one source carried only that source's
+ * buttons, so for instance a motion report from Orbital Mouse released a
+ * button held by Turbo Click, and sources sending in the same polling interval
+ * produced reports that the host never saw separately anyway.
+ *
+ * With this library, sources instead hand their state to one aggregator:
+ *
+ *  * `mouse_report_set_buttons()` sets the buttons held by a source. The report
+ *    holds the union of the buttons of all sources.
+ *
+ *  * `mouse_report_move()` and `mouse_report_scroll()` add motion and wheel
+ *    deltas in fixed point. Only whole units go in a report; the fractional
+ *    residual is kept for the next one, as is any part beyond the range of a
+ *    report, so no motion is lost to rounding or clamping.
+ *
+ * `mouse_report_task()` sends at most one report per
+ * `MOUSE_REPORT_INTERVAL_MS`, which defaults to the USB polling interval, and
+ * sends nothing if the report would not change anything. One exception: if a
+ * button would revert before its change was sent, the change is sent right
+ * away, so that short clicks are never merged away.
+ *
+ * Mouse keys buttons `MS_BTN1`-`MS_BTN8` are routed through the aggregator by
+ * `process_mouse_report()`. They are mirrored into the mouse keys report, as are
+ * the buttons of the other sources, so that reports QMK sends for mouse keys
+ * movement carry the same buttons. Mouse keys movement itself, with its
+ * acceleration, is left to QMK.
+ *
+ * In rules.mk, add `OPT_DEFS += -DMOUSE_REPORT_ENABLE`,
+ * `SRC += features/mouse_report.c`, and `MOUSE_ENABLE = yes`. Orbital Mouse
+ * and Mouse Turbo Click use the aggregator when `MOUSE_REPORT_ENABLE` is
+ * defined.
+ */
+
+#pragma once
+
+#include "quantum.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Minimum time in ms between reports.
+#ifndef MOUSE_REPORT_INTERVAL_MS
+#ifdef USB_POLLING_INTERVAL_MS
+#define MOUSE_REPORT_INTERVAL_MS USB_POLLING_INTERVAL_MS
+#else
+#define MOUSE_REPORT_INTERVAL_MS 1
+#endif  // USB_POLLING_INTERVAL_MS
+#endif  // MOUSE_REPORT_INTERVAL_MS
+
+/** Identifies a source of mouse buttons. */
+enum {
+  /** Buttons held by `MS_BTN*` mouse keys. */
+  MOUSE_REPORT_SOURCE_MOUSEKEY,
+  /** Buttons held by Orbital Mouse. */
+  MOUSE_REPORT_SOURCE_ORBITAL_MOUSE,
+  /** Button clicked by Mouse Turbo Click. */
+  MOUSE_REPORT_SOURCE_TURBO_CLICK,
+  MOUSE_REPORT_NUM_SOURCES,
+};
+
+/**
+ * Handler function for mouse reports.
+ *
+ * Call this function from `process_record_user()`, after any handler that
+ * remaps mouse keys, like Orbital Mouse:
+ *
+ *     #include "features/mouse_report.h"
+ *
+ *     bool process_record_user(uint16_t keycode, keyrecord_t* record) {
+ *       if (!process_mouse_report(keycode, record)) { return false; }
+ *       // Your macros...
+ *       return true;
+ *     }
+ */
+bool process_mouse_report(uint16_t keycode, keyrecord_t* record);
+
+/**
+ * Task function for mouse reports.
+ *
+ * Call this function from `housekeeping_task_user()`, after the task functions
+ * of the sources. With `SCHEDULER_ENABLE`, `scheduler_task()` calls it when a
+ * report is due instead.
+ */
+void mouse_report_task(void);
+
+/**
+ * Sets the buttons held by a source.
+ *
+ * @param source   `MOUSE_REPORT_SOURCE_*` identifying the caller.
+ * @param buttons  Bitmask of held buttons, bit 0 for button 1.
+ */
+void mouse_report_set_buttons(uint8_t source, uint8_t buttons);
+
+/** Adds cursor motion in pixels, as Q.8 fixed-point values. */
+void mouse_report_move(int16_t x, int16_t y);
+
+/** Adds wheel motion in steps, as Q.6 fixed-point values. */
+void mouse_report_scroll(int16_t h, int16_t v);
+
+#ifdef __cplusplus
+}
+#endif
@@ -22,6 +22,10 @@
 
 #include "features/mouse_turbo_click.h"
 
+#ifdef MOUSE_REPORT_ENABLE
+#include "features/mouse_report.h"
+#endif  // MOUSE_REPORT_ENABLE
+
 // This library relies on that mouse keys and the deferred execution API are
 // enabled, which we check for here. Enable them in your rules.mk by setting:
 //   MOUSEKEY_ENABLE = yes
@@ -48,25 +52,103 @@
 #define MOUSE_TURBO_CLICK_PERIOD 80
 #endif  // MOUSE_TURBO_CLICK_PERIOD
 
+// Alternatively, the click rate may be set in clicks per second, which is
+// exact where the period in whole milliseconds would not be. When defined, this
+// takes precedence over `MOUSE_TURBO_CLICK_PERIOD`.
+//
+// Each click takes two reports, a press and a release, so the rate can be at
+// most half the USB polling rate, 500 clicks per second at the default 1 ms
+// polling interval. Faster clicks would be merged by the host.
+#ifdef MOUSE_TURBO_CLICK_CPS
+#ifdef USB_POLLING_INTERVAL_MS
+#define MAX_CPS (500 / USB_POLLING_INTERVAL_MS)
+#else
+#define MAX_CPS 500
+#endif  // USB_POLLING_INTERVAL_MS
+#if MOUSE_TURBO_CLICK_CPS < 1 || MOUSE_TURBO_CLICK_CPS > MAX_CPS
+#error "mouse_turbo_click: MOUSE_TURBO_CLICK_CPS must be between 1 and half the USB polling rate."
+#endif
+// Edge k of the click train is at k * 500 / CPS ms.
+#define EDGE_MS_NUM 500
+#define EDGE_MS_DEN MOUSE_TURBO_CLICK_CPS
+#else
+// Edge k of the click train is at k * PERIOD / 2 ms.
+#define EDGE_MS_NUM MOUSE_TURBO_CLICK_PERIOD
+#define EDGE_MS_DEN 2
+#endif  // MOUSE_TURBO_CLICK_CPS
+// Time between edges in whole ms, at least 1.
+#define EDGE_MIN_MS \
+  (EDGE_MS_NUM / EDGE_MS_DEN > 0 ? EDGE_MS_NUM / EDGE_MS_DEN : 1)
+
 static deferred_token click_token = INVALID_DEFERRED_TOKEN;
 static bool click_registered = false;
+// Time of edge 0 of the click train, and the index of the next edge after it.
+// After `EDGE_MS_DEN` edges, exactly `EDGE_MS_NUM` ms have passed, at which
+// point `edge_base` advances and `edge_count` restarts from zero, so that the
+// product below never overflows.
+static uint32_t edge_base = 0;
+static uint16_t edge_count = 0;
+
+// Presses or releases `MOUSE_TURBO_CLICK_KEY`. With features/mouse_report.h,
+// mouse buttons are set there directly, so that the clicks are merged with
+// other mouse reports.
+static void set_click(bool pressed) {
+  click_registered = pressed;
+#ifdef MOUSE_REPORT_ENABLE
+  if (MS_BTN1 <= MOUSE_TURBO_CLICK_KEY &&
+      MOUSE_TURBO_CLICK_KEY <= MS_BTN8) {
+    mouse_report_set_buttons(
+        MOUSE_REPORT_SOURCE_TURBO_CLICK,
+        pressed ? 1 << (MOUSE_TURBO_CLICK_KEY - MS_BTN1) : 0);
+    return;
+  }
+#endif  // MOUSE_REPORT_ENABLE
+  if (pressed) {
+    register_code16(MOUSE_TURBO_CLICK_KEY);
+  } else {
+    unregister_code16(MOUSE_TURBO_CLICK_KEY);
+  }
+}
 
 // Callback used with deferred execution. It alternates between registering and
 // unregistering (pressing and releasing) `MOUSE_TURBO_CLICK_KEY`.
+//
+// Deferred execution schedules the next call relative to when this call ran,
+// so returning a fixed delay would let every bit of main loop latency, from
+// macros, RGB effects, and so on, accumulate into a slower click rate and
+// uneven clicks. Instead, edges are placed on a fixed grid of absolute
+// deadlines from when Turbo Click started, and the returned delay is however
+// long remains until the next one. A late edge is then followed by an earlier
+// one, and the rate holds exactly over time.
 static uint32_t turbo_click_callback(uint32_t trigger_time, void* cb_arg) {
-  if (click_registered) {
-    unregister_code16(MOUSE_TURBO_CLICK_KEY);
-    click_registered = false;
-  } else {
-    click_registered = true;
-    register_code16(MOUSE_TURBO_CLICK_KEY);
+  set_click(!click_registered);
+
+  if (++edge_count >= EDGE_MS_DEN) {
+    edge_base += EDGE_MS_NUM;
+    edge_count -= EDGE_MS_DEN;
+  }
+  const uint32_t next_edge =
+      edge_base + ((uint32_t)edge_count * EDGE_MS_NUM) / EDGE_MS_DEN;
+  const uint32_t now = timer_read32();
+
+  if (!timer_expired32(now, next_edge)) {
+    return next_edge - now;  // Execute again at the next edge.
+  } else if (now - next_edge < EDGE_MIN_MS) {
+    return 1;  // The next edge is due already; run it as soon as possible.
   }
-  return MOUSE_TURBO_CLICK_PERIOD / 2;  // Execute again in half a period.
+  // The main loop stalled for longer than an edge. Rather than catch up with a
+  // burst of edges, which would land in the same USB poll and be lost to the
+  // host anyway, restart the grid from now.
+  edge_base = now;
+  edge_count = 0;
+  return EDGE_MIN_MS;
 }
 
 // Starts Turbo Click, begins the `turbo_click_callback()` callback.
 static void turbo_click_start(void) {
   if (click_token == INVALID_DEFERRED_TOKEN) {
+    edge_base = timer_read32();
+    edge_count = 0;
     uint32_t next_delay_ms = turbo_click_callback(0, NULL);
     click_token = defer_exec(next_delay_ms, turbo_click_callback, NULL);
   }
@@ -79,8 +161,7 @@ static void turbo_click_stop(void) {
     click_token = INVALID_DEFERRED_TOKEN;
     if (click_registered) {
       // If `MOUSE_TURBO_CLICK_KEY` is currently registered, release it.
-      unregister_code16(MOUSE_TURBO_CLICK_KEY);
-      click_registered = false;
+      set_click(false);
     }
   }
 }
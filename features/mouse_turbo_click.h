@@ -28,6 +28,11 @@
  *  * Quickly double tapping the Turbo Click button "locks" it. Rapid mouse
  *    clicks are sent until the Turbo Click button is tapped again.
  *
+ * The click rate is set in config.h by `MOUSE_TURBO_CLICK_PERIOD` in ms, or by
+ * `MOUSE_TURBO_CLICK_CPS` in clicks per second, up to half the USB polling
+ * rate. Clicks follow a fixed grid of deadlines, so that delays in the main
+ * loop make individual clicks late but don't slow down the overall rate.
+ *
  * @note Mouse keys and deferred execution must be enabled; in rules.mk set
  * `MOUSEKEY_ENABLE = yes` and `DEFERRED_EXEC_ENABLE = yes`.
  *
@@ -22,6 +22,13 @@
 
 #include "orbital_mouse.h"
 
+#ifdef MOUSE_REPORT_ENABLE
+#include "mouse_report.h"
+#endif  // MOUSE_REPORT_ENABLE
+#ifdef SCHEDULER_ENABLE
+#include "scheduler.h"
+#endif  // SCHEDULER_ENABLE
+
 #ifndef ORBITAL_MOUSE_RADIUS
 #define ORBITAL_MOUSE_RADIUS 36
 #endif  // ORBITAL_MOUSE_RADIUS
@@ -46,6 +53,19 @@
 #ifndef ORBITAL_MOUSE_INTERVAL_MS
 #define ORBITAL_MOUSE_INTERVAL_MS 16
 #endif  // ORBITAL_MOUSE_INTERVAL_MS
+#ifdef ORBITAL_MOUSE_HIGH_RATE
+#ifndef ORBITAL_MOUSE_STEP_MS
+#define ORBITAL_MOUSE_STEP_MS 4
+#endif  // ORBITAL_MOUSE_STEP_MS
+#if !(1 <= ORBITAL_MOUSE_STEP_MS && ORBITAL_MOUSE_STEP_MS <= 8)
+#error "Invalid ORBITAL_MOUSE_STEP_MS. Value must be in [1, 8]."
+#endif
+#if defined(USB_POLLING_INTERVAL_MS) && \
+    (ORBITAL_MOUSE_STEP_MS % USB_POLLING_INTERVAL_MS) != 0
+#pragma message \
+    "orbital_mouse: ORBITAL_MOUSE_STEP_MS should be a multiple of USB_POLLING_INTERVAL_MS, or steps will beat against the host's polling."
+#endif
+#endif  // ORBITAL_MOUSE_HIGH_RATE
 
 #if !(0 <= ORBITAL_MOUSE_RADIUS && ORBITAL_MOUSE_RADIUS <= 63)
 #error "Invalid ORBITAL_MOUSE_RADIUS. Value must be in [0, 63]."
@@ -78,6 +98,8 @@ enum {
   /** Wheel speed in steps/frame as a Q2.6 value. */
   WHEEL_SPEED_Q2_6 = (ORBITAL_MOUSE_WHEEL_SPEED) < 3.99
       ? ((uint8_t)((ORBITAL_MOUSE_WHEEL_SPEED) * 64 + 0.5)) : 255,
+  /** Movement time at which the speed curve ends, in 1/16 intervals. */
+  SPEED_CURVE_END_T = 16 * 16 * (NUM_SPEED_CURVE_INTERVALS - 1),
   /** Double click delay in units of intervals. */
   DOUBLE_CLICK_DELAY_INTERVALS =
       (ORBITAL_MOUSE_DBL_DELAY_MS) / (ORBITAL_MOUSE_INTERVAL_MS),
@@ -103,18 +125,22 @@ static struct {
   const uint8_t* speed_curve;
   // Time when the Orbital Mouse task function should next run.
   uint16_t timer;
+#ifdef ORBITAL_MOUSE_HIGH_RATE
+  // Time of the last step.
+  uint16_t step_time;
+  // Time in ms since the double click action last advanced a frame.
+  uint8_t double_click_ms;
+#endif  // ORBITAL_MOUSE_HIGH_RATE
   // Fractional displacement of the cursor as Q7.8 values.
   int16_t x;
   int16_t y;
   // Fractional displacement of the mouse wheel as Q9.6 values.
   int16_t wheel_x;
   int16_t wheel_y;
-  // Current cursor movement speed as a Q9.6 value.
-  int16_t speed;
   // Bitfield tracking which movement keys are currently held.
   uint8_t held_keys;
-  // Cursor movement time, counted in number of intervals.
-  uint8_t move_t;
+  // Cursor movement time, counted in 1/16 intervals.
+  uint16_t move_t;
   // Cursor movement direction, 1 => forward, -1 => backward.
   int8_t move_dir;
   // Steering direction, 1 => counter-clockwise, -1 => clockwise.
@@ -128,38 +154,90 @@ static struct {
   uint8_t selected_button;
   // Tracks double click action.
   uint8_t double_click_frame;
+  // Mouse buttons in the last report sent.
+  uint8_t sent_buttons;
   // When true, movement and turning are slower.
   bool slow;
 } state = {.speed_curve = init_speed_curve};
 
+#ifdef ORBITAL_MOUSE_HIGH_RATE
+/** Scales a per-interval `value` by `scale`, a Q8.8 fraction of an interval. */
+static int16_t scale_step(int16_t value, uint16_t scale) {
+  return (int16_t)(((int32_t)value * scale + 128) >> 8);
+}
+#else
+// Each step is exactly one interval.
+#define scale_step(value, scale) (value)
+#endif  // ORBITAL_MOUSE_HIGH_RATE
+
 /**
  * Fixed-point sine with specified amplitude and phase.
  *
+ * The sine is linearly interpolated between the entries of a quarter-wave look
+ * up table, so that the fractional part of the heading angle is not discarded
+ * and steering is smooth rather than in 64 coarse steps.
+ *
  * @param amplitude Nonnegative Q6.2 value.
- * @param phase Value in [0, 63].
+ * @param phase Angle as a Q6.8 value, with 64 * 256 being a full cycle.
  * @returns Result as a Q6.8 value.
  */
-static int16_t scaled_sin(uint8_t amplitude, uint8_t phase) {
-  // Look up table covers half a cycle of a sine wave.
-  static const uint8_t lut[NUM_ANGLES / 2] PROGMEM = {
-      0,   25,  50,  74,  98,  120, 142, 162, 180, 197, 212,
-      225, 236, 244, 250, 254, 255, 254, 250, 244, 236, 225,
-      212, 197, 180, 162, 142, 120, 98,  74,  50,  25};
-  // amplitude Q6.2 and lut is Q0.8. Shift down by 2 so that the result is Q6.8.
-  int16_t value = (int16_t)(((uint16_t)amplitude
-        * pgm_read_byte(lut + (phase & (NUM_ANGLES / 2 - 1))) + 2) >> 2);
-  return ((NUM_ANGLES / 2) & phase) == 0 ? value : -value;
+static int16_t scaled_sin(uint8_t amplitude, uint16_t phase) {
+  // Look up table covers a quarter cycle of a sine wave, including both ends.
+  static const uint8_t lut[NUM_ANGLES / 4 + 1] PROGMEM = {
+      0,   25,  50,  74,  98,  120, 142, 162, 180,
+      197, 212, 225, 236, 244, 250, 254, 255};
+  // Position within the quarter cycle as a Q4.8 value, mirrored in the second
+  // and fourth quarters.
+  uint16_t q = phase & (NUM_ANGLES / 4 * 256 - 1);
+  if (phase & (NUM_ANGLES / 4 * 256)) {
+    q = NUM_ANGLES / 4 * 256 - q;
+  }
+  const uint8_t i = q >> 8;
+  uint8_t sine = pgm_read_byte(lut + i);  // Q0.8 value.
+  if (i < NUM_ANGLES / 4) {
+    const uint8_t frac = q & 255;
+    sine += ((pgm_read_byte(lut + i + 1) - sine) * frac + 128) >> 8;
+  }
+  // amplitude Q6.2 and sine is Q0.8. Shift down by 2 so the result is Q6.8.
+  const int16_t value = (int16_t)(((uint16_t)amplitude * sine + 2) >> 2);
+  return (phase & (NUM_ANGLES / 2 * 256)) == 0 ? value : -value;
 }
 
 /** Computes fixed-point cosine. */
-static int16_t scaled_cos(uint8_t amplitude, uint8_t phase) {
-  return scaled_sin(amplitude, phase + (NUM_ANGLES / 4));
+static int16_t scaled_cos(uint8_t amplitude, uint16_t phase) {
+  return scaled_sin(amplitude, phase + (NUM_ANGLES / 4 * 256));
+}
+
+/**
+ * Gets the cursor speed from the speed curve, linearly interpolated.
+ *
+ * @param t Movement time in 1/16 intervals.
+ * @returns Speed as a Q9.6 value.
+ */
+static int16_t get_speed(uint16_t t) {
+  if (t >= SPEED_CURVE_END_T) {
+    return (int16_t)state.speed_curve[NUM_SPEED_CURVE_INTERVALS - 1] * 16;
+  }
+  // Each entry of the speed curve spans 16 intervals = 256 units of t.
+  const uint8_t i = t >> 8;
+  const uint8_t frac = t & 255;
+  const int16_t a = state.speed_curve[i];
+  const int16_t b = state.speed_curve[i + 1];
+  return (int16_t)((a * 256 + (b - a) * frac + 8) / 16);
 }
 
 /** Wakes the Orbital Mouse task.  */
 static void wake_orbital_mouse_task(void) {
   if (!state.timer) {
     state.timer = timer_read() | 1;
+#ifdef ORBITAL_MOUSE_HIGH_RATE
+    // Count the first step as a full step, so that motion starts right away.
+    state.step_time = state.timer - ORBITAL_MOUSE_STEP_MS;
+#endif  // ORBITAL_MOUSE_HIGH_RATE
+#ifdef SCHEDULER_ENABLE
+    scheduler_wake_at(SCHEDULER_TASK_ORBITAL_MOUSE, orbital_mouse_task,
+                      state.timer);
+#endif  // SCHEDULER_ENABLE
   }
 }
 
@@ -215,11 +293,11 @@ uint8_t get_orbital_mouse_angle(void) {
 }
 
 static void set_orbital_mouse_angle_fractional(uint16_t angle) {
-  state.x += scaled_sin(RADIUS_Q6_2, state.angle >> 8);
-  state.y += scaled_cos(RADIUS_Q6_2, state.angle >> 8);
+  state.x += scaled_sin(RADIUS_Q6_2, state.angle);
+  state.y += scaled_cos(RADIUS_Q6_2, state.angle);
   state.angle = angle;
-  state.x -= scaled_sin(RADIUS_Q6_2, angle >> 8);
-  state.y -= scaled_cos(RADIUS_Q6_2, angle >> 8);
+  state.x -= scaled_sin(RADIUS_Q6_2, angle);
+  state.y -= scaled_cos(RADIUS_Q6_2, angle);
   wake_orbital_mouse_task();
 }
 
@@ -263,6 +341,9 @@ bool process_orbital_mouse(uint16_t keycode, keyrecord_t* record) {
       case OM_DBLS:
         if (record->event.pressed) {
           state.double_click_frame = 1;
+#ifdef ORBITAL_MOUSE_HIGH_RATE
+          state.double_click_ms = ORBITAL_MOUSE_INTERVAL_MS;
+#endif  // ORBITAL_MOUSE_HIGH_RATE
         }
         break;
       case OM_SLOW:
@@ -298,30 +379,42 @@ void orbital_mouse_task(void) {
     return;
   }
 
+#ifdef ORBITAL_MOUSE_HIGH_RATE
+  // Scale motion by the time elapsed since the last step, as a Q8.8 fraction
+  // of an interval, so that speeds are independent of the step rate and
+  // jitter. Long stalls are limited to two intervals to avoid large jumps.
+  uint16_t elapsed = now - state.step_time;
+  if (elapsed > 2 * ORBITAL_MOUSE_INTERVAL_MS) {
+    elapsed = 2 * ORBITAL_MOUSE_INTERVAL_MS;
+  }
+  state.step_time = now;
+  const uint16_t scale = (elapsed * 256 + ORBITAL_MOUSE_INTERVAL_MS / 2) /
+                         ORBITAL_MOUSE_INTERVAL_MS;
+  const uint16_t dt = (elapsed * 16 + ORBITAL_MOUSE_INTERVAL_MS / 2) /
+                      ORBITAL_MOUSE_INTERVAL_MS;
+#else
+  const uint16_t dt = 16;  // One interval, in 1/16 intervals.
+#endif  // ORBITAL_MOUSE_HIGH_RATE
+
   bool active = false;
 
   // Update position if moving.
   if (state.move_dir) {
-    // Update speed, interpolated from speed_curve.
-    if (state.move_t <= 16 * (NUM_SPEED_CURVE_INTERVALS - 1)) {
-      if (state.move_t == 0) {
-        state.speed = (int16_t)state.speed_curve[0] * 16;
-      } else {
-        const uint8_t i = (state.move_t - 1) / 16;
-        state.speed += (int16_t)state.speed_curve[i + 1]
-                     - (int16_t)state.speed_curve[i];
-      }
-
-      ++state.move_t;
+    // Get speed, interpolated from speed_curve.
+    const int16_t speed_q9_6 = get_speed(state.move_t);
+    if (state.move_t < SPEED_CURVE_END_T) {
+      state.move_t += dt;
     }
     // Round and cast from Q9.6 to Q6.2.
-    uint8_t speed = (state.speed + 8) / 16;
+    uint8_t speed = (speed_q9_6 + 8) / 16;
     if (state.slow) {
       speed = ((uint16_t)speed) * (1 + (uint16_t)SLOW_MOVE_FACTOR_Q_8) >> 8;
     }
 
-    state.x -= state.move_dir * scaled_sin(speed, state.angle >> 8);
-    state.y -= state.move_dir * scaled_cos(speed, state.angle >> 8);
+    state.x -= scale_step(state.move_dir * scaled_sin(speed, state.angle),
+                          scale);
+    state.y -= scale_step(state.move_dir * scaled_cos(speed, state.angle),
+                          scale);
     active = true;
   }
 
@@ -331,37 +424,76 @@ void orbital_mouse_task(void) {
     if (state.steer_dir == -1) {
       angle_step = -angle_step;
     }
-    set_orbital_mouse_angle_fractional(state.angle + angle_step);
+    set_orbital_mouse_angle_fractional(state.angle +
+                                       scale_step(angle_step, scale));
     active = true;
   }
 
   // Update mouse wheel if active.
   if (state.wheel_x_dir || state.wheel_y_dir) {
-    state.wheel_x -= state.wheel_x_dir * WHEEL_SPEED_Q2_6;
-    state.wheel_y += state.wheel_y_dir * WHEEL_SPEED_Q2_6;
+    state.wheel_x -= scale_step(state.wheel_x_dir * WHEEL_SPEED_Q2_6, scale);
+    state.wheel_y += scale_step(state.wheel_y_dir * WHEEL_SPEED_Q2_6, scale);
     active = true;
   }
 
   // Update double click action.
   if (state.double_click_frame) {
-    ++state.double_click_frame;
-    const uint8_t mask = 1 << state.selected_button;
-    switch (state.double_click_frame) {
-      case 2:
-      case 3:
-      case 4 + DOUBLE_CLICK_DELAY_INTERVALS:
-        state.report.buttons ^= mask;
-        break;
-      case 5 + DOUBLE_CLICK_DELAY_INTERVALS:
-        state.report.buttons &= ~mask;
-        state.double_click_frame = 0;
+#ifdef ORBITAL_MOUSE_HIGH_RATE
+    // Frames advance once per interval, regardless of the step rate.
+    state.double_click_ms += elapsed;
+    const bool next_frame = state.double_click_ms >= ORBITAL_MOUSE_INTERVAL_MS;
+    if (next_frame) {
+      state.double_click_ms = 0;
+    }
+#else
+    const bool next_frame = true;
+#endif  // ORBITAL_MOUSE_HIGH_RATE
+    if (next_frame) {
+      ++state.double_click_frame;
+      const uint8_t mask = 1 << state.selected_button;
+      switch (state.double_click_frame) {
+        case 2:
+        case 3:
+        case 4 + DOUBLE_CLICK_DELAY_INTERVALS:
+          state.report.buttons ^= mask;
+          break;
+        case 5 + DOUBLE_CLICK_DELAY_INTERVALS:
+          state.report.buttons &= ~mask;
+          state.double_click_frame = 0;
+      }
     }
     active = true;
   }
 
   // Schedule when task should run again, or go to sleep if inactive.
+#ifdef ORBITAL_MOUSE_HIGH_RATE
+  // Steps follow a fixed cadence from the previous deadline rather than from
+  // `now`, so they keep a steady phase relative to the host's polling. If the
+  // task fell behind by more than a step, restart the cadence from `now`.
+  uint16_t next = state.timer + ORBITAL_MOUSE_STEP_MS;
+  if (timer_expired(now, next)) {
+    next = now + ORBITAL_MOUSE_STEP_MS;
+  }
+  state.timer = active ? (next ? next : 1) : 0;
+#else
   state.timer = active ? ((now + ORBITAL_MOUSE_INTERVAL_MS) | 1) : 0;
-
+#endif  // ORBITAL_MOUSE_HIGH_RATE
+#ifdef SCHEDULER_ENABLE
+  if (state.timer) {
+    scheduler_wake_at(SCHEDULER_TASK_ORBITAL_MOUSE, orbital_mouse_task,
+                      state.timer);
+  }
+#endif  // SCHEDULER_ENABLE
+
+#ifdef MOUSE_REPORT_ENABLE
+  // Hand over all motion, fractional parts included. The aggregator keeps the
+  // residuals and merges the buttons with those of other sources.
+  mouse_report_move(state.x, state.y);
+  mouse_report_scroll(state.wheel_x, state.wheel_y);
+  state.x = state.y = state.wheel_x = state.wheel_y = 0;
+  mouse_report_set_buttons(MOUSE_REPORT_SOURCE_ORBITAL_MOUSE,
+                           state.report.buttons);
+#else
   // Set whole part of movement deltas in report and retain fractional parts.
   state.report.x = state.x / 256;
   state.report.y = state.y / 256;
@@ -371,7 +503,15 @@ void orbital_mouse_task(void) {
   state.report.v = state.wheel_y / 64;
   state.wheel_x -= (int16_t)state.report.h * 64;
   state.wheel_y -= (int16_t)state.report.v * 64;
-  host_mouse_send(&state.report);
+
+  // Skip the report if it wouldn't change anything, which is common at high
+  // step rates where many steps move less than a pixel.
+  if (state.report.x || state.report.y || state.report.h || state.report.v ||
+      state.report.buttons != state.sent_buttons) {
+    host_mouse_send(&state.report);
+    state.sent_buttons = state.report.buttons;
+  }
+#endif  // MOUSE_REPORT_ENABLE
 }
 
 #endif
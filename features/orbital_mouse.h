@@ -34,6 +34,21 @@
  *     OM_HLDS, OM_L   , OM_D   , OM_R   , OM_SEL2,
  *     OM_RELS, OM_W_D , OM_W_U , OM_BTN3, OM_SEL3,
  *
+ * By default, the pointer moves in steps every `ORBITAL_MOUSE_INTERVAL_MS`
+ * (16 ms, about 60 Hz), which can look choppy on high refresh rate displays.
+ * For smoother motion, enable the high-rate mode in config.h:
+ *
+ *     #define ORBITAL_MOUSE_HIGH_RATE
+ *     #define ORBITAL_MOUSE_STEP_MS 4  // Optional, step period of 1 to 8 ms.
+ *
+ * Motion is then stepped every `ORBITAL_MOUSE_STEP_MS` and scaled by the time
+ * actually elapsed, so that speeds are the same as in the default mode. For
+ * steps to line up with the host's polling, choose a step period that is a
+ * multiple of `USB_POLLING_INTERVAL_MS`. In either mode, steps that don't
+ * change the report are not sent, and the task is idle while no Orbital Mouse
+ * keys are held. With `MOUSE_REPORT_ENABLE`, reports go through
+ * features/mouse_report.h, which merges them with other mouse sources.
+ *
  * For full documentation, see
  * <https://getreuer.info/posts/keyboards/orbital-mouse>
  */
@@ -69,6 +84,9 @@ bool process_orbital_mouse(uint16_t keycode, keyrecord_t* record);
  *
  *       // Other tasks ...
  *     }
+ *
+ * Alternatively, with `SCHEDULER_ENABLE` (see scheduler.h), call
+ * `scheduler_task()`, which runs this only at each movement interval.
  */
 void orbital_mouse_task(void);
 
@@ -34,18 +34,24 @@
 #error "repeat_key: Please set `COMBO_ENABLE = yes` in rules.mk."
 #else
 
-// Variables saving the state of the last key press.
-static keyrecord_t last_record = {0};
-static uint8_t last_mods = 0;
+_Static_assert(1 <= REPEAT_KEY_HISTORY_SIZE && REPEAT_KEY_HISTORY_SIZE <= 127,
+               "REPEAT_KEY_HISTORY_SIZE must be between 1 and 127");
+
+// History of remembered keys, a ring buffer of keycode and mods pairs. The
+// last key is at `history_head`, and the key before it one index lower. The
+// keycodes and mods are kept in separate arrays rather than an array of
+// structs, which ARM would pad to 4 bytes per key.
+static uint16_t history_keycodes[REPEAT_KEY_HISTORY_SIZE] = {0};
+static uint8_t history_mods[REPEAT_KEY_HISTORY_SIZE] = {0};
+static uint8_t history_head = 0;
+static uint8_t history_len = 0;
+// How many keys back `repeat_key_back_tap()` has stepped, or 0.
+static uint8_t history_step = 0;
 // Signed count of the number of times the last key has been repeated or
 // alternate repeated: it is 0 when a key is pressed normally, positive when
 // repeated, and negative when alternate repeated.
 static int8_t last_repeat_count = 0;
 
-// The repeat_count, but set to 0 outside of repeat_key_invoke() so that it is
-// nonzero only while a repeated key is being processed.
-static int8_t processing_repeat_count = 0;
-
 /** @brief Updates `last_repeat_count` in direction `dir`. */
 static void update_last_repeat_count(int8_t dir) {
   if (dir * last_repeat_count < 0) {
@@ -55,80 +61,184 @@ static void update_last_repeat_count(int8_t dir) {
   }
 }
 
-static void set_last_record(uint16_t keycode, keyrecord_t* record) {
-  last_record = *record;
-  last_record.keycode = keycode;
+/** @brief Index in `history` of the `n`th most recent key, 1 being the last. */
+static uint8_t history_index(uint8_t n) {
+  return (history_head + REPEAT_KEY_HISTORY_SIZE + 1 - n) %
+         REPEAT_KEY_HISTORY_SIZE;
+}
+
+/** @brief Adds `keycode` to the history as the last key. */
+static void history_push(uint16_t keycode) {
+  history_head = (history_head + 1) % REPEAT_KEY_HISTORY_SIZE;
+  history_keycodes[history_head] = keycode;
+  history_mods[history_head] = 0;
+  if (history_len < REPEAT_KEY_HISTORY_SIZE) {
+    ++history_len;
+  }
+  history_step = 0;
   last_repeat_count = 0;
 }
 
-static void repeat_key_invoke(const keyevent_t* event) {
+/**
+ * @brief Makes a record for the `n`th most recent key, 1 being the last.
+ *
+ * Only the keycode is stored in the history, so the record is reconstructed as
+ * a tap. Keys are only remembered on tap anyway.
+ */
+static keyrecord_t history_record(uint8_t n) {
+  return (keyrecord_t){
+#ifndef NO_ACTION_TAPPING
+      .tap.interrupted = false,
+      .tap.count = 1,
+#endif
+      .keycode = history_keycodes[history_index(n)],
+  };
+}
+
+/**
+ * @brief Queues a tap of the `n`th most recent key, 1 being the last.
+ * @return False if the queue had no room for the press, and nothing was queued.
+ */
+static bool history_tap(uint8_t n, uint8_t delay_ms) {
+  keyrecord_t record = history_record(n);
+  const uint8_t mods = history_mods[history_index(n)];
+  record.event = MAKE_KEYEVENT(0, 0, true);
+  if (!event_queue_push(&record, EVENT_QUEUE_SOURCE_REPEAT_KEY, 1, mods,
+                        delay_ms)) {
+    return false;
+  }
+  // The release may use the queue's reserved slots, so it always fits.
+  record.event = MAKE_KEYEVENT(0, 0, false);
+  event_queue_push(&record, EVENT_QUEUE_SOURCE_REPEAT_KEY, 1, mods,
+                   TAP_CODE_DELAY);
+  return true;
+}
+
+static void repeat_key_invoke(const keyevent_t* event, uint8_t delay_ms) {
   // It is possible (e.g. in rolled presses) that the last key changes while the
   // Repeat Key is pressed. To prevent stuck keys, it is important to remember
   // separately what key record was processed on press so that the the
   // corresponding record is generated on release.
   static keyrecord_t registered_record = {0};
   static int8_t registered_repeat_count = 0;
-  // Since this function calls process_record(), it may recursively call itself.
-  // We return early if `processing_repeat_count` is nonzero to prevent infinite
-  // recursion.
-  if (processing_repeat_count || !last_record.keycode) {
+  static uint8_t registered_mods = 0;
+  if (!get_last_keycode()) {
     return;
   }
 
   if (event->pressed) {
     update_last_repeat_count(1);
-    // On press, apply the last mods state, stacking on top of current mods.
-    register_weak_mods(last_mods);
-    registered_record = last_record;
+    registered_record = history_record(1);
     registered_repeat_count = last_repeat_count;
+    registered_mods = get_last_mods();
   }
 
-  // Generate a keyrecord and plumb it into the event pipeline.
+  // Generate a keyrecord and queue it to be plumbed into the event pipeline.
+  // The last mods state is applied as weak mods while the key is held,
+  // stacking on top of current mods. Queued events come back through
+  // `process_repeat_key()` with a nonzero repeat count, where they pass.
   registered_record.event = *event;
-  processing_repeat_count = registered_repeat_count;
-  process_record(&registered_record);
-  processing_repeat_count = 0;
-
-  // On release, restore the mods state.
-  if (!event->pressed) {
-    unregister_weak_mods(last_mods);
-  }
+  event_queue_push(&registered_record, EVENT_QUEUE_SOURCE_REPEAT_KEY,
+                   registered_repeat_count, registered_mods, delay_ms);
 }
 
+// Default alternate keys are defined by lists of pairs of basic keycodes,
+// written as X-macros `X(k, a, b)`. For each list, the `k` argument is passed
+// through to `X` so that the list can be expanded into an expression in `k`.
+//
+// The following pairs apply when the last key was pressed with a modifier
+// other than Shift. They map mod + F <-> mod + B and a few others, supporting
+// several core hotkeys used in Emacs, Vim, less, and other programs.
+// clang-format off
+#define ALT_REPEAT_PAIRS_WITH_MODS(X, k)                              \
+    X(k, KC_F   , KC_B   )  /* Forward / Backward. */                 \
+    X(k, KC_D   , KC_U   )  /* Down / Up. */                          \
+    X(k, KC_N   , KC_P   )  /* Next / Previous. */                    \
+    X(k, KC_A   , KC_E   )  /* Home / End. */                         \
+    X(k, KC_O   , KC_I   )  /* Vim jumplist Older / Newer. */
+
+// The following pairs apply when the last key was pressed with no mods or only
+// Shift. They map a few more Vim hotkeys.
+#define ALT_REPEAT_PAIRS_NO_MODS(X, k)                                \
+    X(k, KC_J   , KC_K   )  /* Down / Up. */                          \
+    X(k, KC_H   , KC_L   )  /* Left / Right. */                       \
+    /* These two lines map W and E to B, and B to W. */               \
+    X(k, KC_W   , KC_B   )  /* Forward / Backward by word. */         \
+    X(k, KC_E   , KC_B   )  /* Forward / Backward by word. */
+
+#ifdef EXTRAKEY_ENABLE
+#define ALT_REPEAT_PAIRS_EXTRAKEY(X, k)                               \
+    X(k, KC_WBAK, KC_WFWD)  /* Browser Back / Forward. */             \
+    X(k, KC_MNXT, KC_MPRV)  /* Next / Previous Media Track. */        \
+    X(k, KC_MFFD, KC_MRWD)  /* Fast Forward / Rewind Media. */        \
+    X(k, KC_VOLU, KC_VOLD)  /* Volume Up / Down. */                   \
+    X(k, KC_BRIU, KC_BRID)  /* Brightness Up / Down. */
+#else
+#define ALT_REPEAT_PAIRS_EXTRAKEY(X, k)
+#endif  // EXTRAKEY_ENABLE
+
+#ifdef MOUSEKEY_ENABLE
+#define ALT_REPEAT_PAIRS_MOUSEKEY(X, k)                               \
+    X(k, KC_MS_L, KC_MS_R)  /* Mouse Cursor Left / Right. */          \
+    X(k, KC_MS_U, KC_MS_D)  /* Mouse Cursor Up / Down. */             \
+    X(k, KC_WH_L, KC_WH_R)  /* Mouse Wheel Left / Right. */           \
+    X(k, KC_WH_U, KC_WH_D)  /* Mouse Wheel Up / Down. */
+#else
+#define ALT_REPEAT_PAIRS_MOUSEKEY(X, k)
+#endif  // MOUSEKEY_ENABLE
+
+// The following pairs are considered with any mods, if the above don't match.
+#define ALT_REPEAT_PAIRS_ANY_MODS(X, k)                               \
+    ALT_REPEAT_KEY_USER_PAIRS(X, k)                                   \
+    X(k, KC_LEFT, KC_RGHT)  /* Left / Right Arrow. */                 \
+    X(k, KC_UP  , KC_DOWN)  /* Up / Down Arrow. */                    \
+    X(k, KC_HOME, KC_END )  /* Home / End. */                         \
+    X(k, KC_PGUP, KC_PGDN)  /* Page Up / Page Down. */                \
+    X(k, KC_BSPC, KC_DEL )  /* Backspace / Delete. */                 \
+    X(k, KC_LBRC, KC_RBRC)  /* Brackets [ ] and { }. */               \
+    ALT_REPEAT_PAIRS_EXTRAKEY(X, k)                                   \
+    ALT_REPEAT_PAIRS_MOUSEKEY(X, k)
+// clang-format on
+
+// Expands to `(k == a) ? b : (k == b) ? a :`, so that a list of pairs expands
+// into a chain of conditionals where the first pair containing k wins.
+#define ALT_REPEAT_MATCH(k, a, b) ((k) == (a)) ? (b) : ((k) == (b)) ? (a) :
+
+// Alternate of basic keycode k when pressed with or without mods.
+#define ALT_REPEAT_WITH_MODS(k)                       \
+  (ALT_REPEAT_PAIRS_WITH_MODS(ALT_REPEAT_MATCH, k)    \
+   ALT_REPEAT_PAIRS_ANY_MODS(ALT_REPEAT_MATCH, k) KC_NO)
+#define ALT_REPEAT_NO_MODS(k)                         \
+  (ALT_REPEAT_PAIRS_NO_MODS(ALT_REPEAT_MATCH, k)      \
+   ALT_REPEAT_PAIRS_ANY_MODS(ALT_REPEAT_MATCH, k) KC_NO)
+
+#define ALT_REPEAT_ENTRY(k) \
+  (uint16_t)((ALT_REPEAT_WITH_MODS(k) << 8) | ALT_REPEAT_NO_MODS(k)),
+#define ALT_REPEAT_ENTRIES_4(k)                                \
+  ALT_REPEAT_ENTRY(k) ALT_REPEAT_ENTRY(k + 1) ALT_REPEAT_ENTRY(k + 2) \
+  ALT_REPEAT_ENTRY(k + 3)
+#define ALT_REPEAT_ENTRIES_16(k)                                       \
+  ALT_REPEAT_ENTRIES_4(k) ALT_REPEAT_ENTRIES_4(k + 4)                  \
+  ALT_REPEAT_ENTRIES_4(k + 8) ALT_REPEAT_ENTRIES_4(k + 12)
+#define ALT_REPEAT_ENTRIES_64(k)                                       \
+  ALT_REPEAT_ENTRIES_16(k) ALT_REPEAT_ENTRIES_16(k + 16)               \
+  ALT_REPEAT_ENTRIES_16(k + 32) ALT_REPEAT_ENTRIES_16(k + 48)
+
 /**
- * @brief Find alternate keycode from a table of opposing keycode pairs.
- * @param table Array of pairs of basic keycodes, declared as PROGMEM.
- * @param table_size_bytes The size of the table in bytes.
- * @param target The basic keycode to find.
- * @return The alternate basic keycode, or KC_NO if none was found.
- *
- * @note The table keycodes and target must be basic keycodes.
- *
- * This helper is used several times below to define alternate keys. Given a
- * table of pairs of basic keycodes, the function finds the pair containing
- * `target` and returns the other keycode in the pair.
+ * Alternate keycodes indexed by basic keycode, merged at compile time from the
+ * pair lists above. The high byte of each entry is the alternate when the key
+ * was pressed with Ctrl, Alt, or GUI, and the low byte the alternate with no
+ * mods or only Shift, or KC_NO if there is none. Finding the alternate is then
+ * a single PROGMEM read however many pairs are defined.
  */
-static uint8_t find_alt_keycode(const uint8_t (*table)[2],
-                                uint8_t table_size_bytes, uint8_t target) {
-  const uint8_t* keycodes = (const uint8_t*)table;
-  for (uint8_t i = 0; i < table_size_bytes; ++i) {
-    if (target == pgm_read_byte(keycodes + i)) {
-      // Xor (i ^ 1) the index to get the other element in the pair.
-      return pgm_read_byte(keycodes + (i ^ 1));
-    }
-  }
-  return KC_NO;
-}
+static const uint16_t alt_keycodes[256] PROGMEM = {
+    ALT_REPEAT_ENTRIES_64(0) ALT_REPEAT_ENTRIES_64(64)
+    ALT_REPEAT_ENTRIES_64(128) ALT_REPEAT_ENTRIES_64(192)
+};
 
-static void alt_repeat_key_invoke(const keyevent_t* event) {
+static void alt_repeat_key_invoke(const keyevent_t* event, uint8_t delay_ms) {
   static keyrecord_t registered_record = {0};
   static int8_t registered_repeat_count = 0;
-  // Since this function calls process_record(), it may recursively call itself.
-  // We return early if `processing_repeat_count` is nonzero to prevent infinite
-  // recursion.
-  if (processing_repeat_count) {
-    return;
-  }
 
   if (event->pressed) {
     registered_record = (keyrecord_t){
@@ -150,11 +260,10 @@ static void alt_repeat_key_invoke(const keyevent_t* event) {
     registered_repeat_count = last_repeat_count;
   }
 
-  // Generate a keyrecord and plumb it into the event pipeline.
+  // Generate a keyrecord and queue it to be plumbed into the event pipeline.
   registered_record.event = *event;
-  processing_repeat_count = registered_repeat_count;
-  process_record(&registered_record);
-  processing_repeat_count = 0;
+  event_queue_push(&registered_record, EVENT_QUEUE_SOURCE_REPEAT_KEY,
+                   registered_repeat_count, 0, delay_ms);
 }
 
 __attribute__((weak)) bool get_repeat_key_eligible(uint16_t keycode,
@@ -216,7 +325,7 @@ bool process_repeat_key(uint16_t keycode, keyrecord_t* record,
   }
 
   if (keycode == repeat_keycode) {
-    repeat_key_invoke(&record->event);
+    repeat_key_invoke(&record->event, 0);
     return false;
   } else if (record->event.pressed) {
     uint8_t remembered_mods = get_mods() | get_weak_mods();
@@ -225,7 +334,7 @@ bool process_repeat_key(uint16_t keycode, keyrecord_t* record,
 #endif  // NO_ACTION_ONESHOT
 
     if (remember_last_key_wrapper(keycode, record, &remembered_mods)) {
-      set_last_record(keycode, record);
+      history_push(keycode);
       set_last_mods(remembered_mods);
     }
   }
@@ -237,33 +346,51 @@ bool process_repeat_key_with_alt(uint16_t keycode, keyrecord_t* record,
                                  uint16_t repeat_keycode,
                                  uint16_t alt_repeat_keycode) {
   if (keycode == alt_repeat_keycode) {
-    alt_repeat_key_invoke(&record->event);
+    alt_repeat_key_invoke(&record->event, 0);
     return false;
   }
 
   return process_repeat_key(keycode, record, repeat_keycode);
 }
 
-int8_t get_repeat_key_count(void) { return processing_repeat_count; }
+int8_t get_repeat_key_count(void) {
+  return event_queue_source() == EVENT_QUEUE_SOURCE_REPEAT_KEY
+             ? event_queue_arg()
+             : 0;
+}
 
-uint16_t get_last_keycode(void) { return last_record.keycode; }
+uint16_t get_last_keycode(void) { return get_repeat_key_history_keycode(1); }
 
-uint8_t get_last_mods(void) { return last_mods; }
+uint8_t get_last_mods(void) { return get_repeat_key_history_mods(1); }
 
 void set_last_keycode(uint16_t keycode) {
-  set_last_record(keycode, &(keyrecord_t){
-#ifndef NO_ACTION_TAPPING
-                               .tap.interrupted = false,
-                               .tap.count = 1,
-#endif
-                           });
+  // Replace the last key rather than add to the history, as when a macro sets
+  // what the Repeat Key does after it.
+  if (!history_len) {
+    history_push(keycode);
+  } else {
+    history_keycodes[history_head] = keycode;
+    history_step = 0;
+    last_repeat_count = 0;
+  }
 }
 
-void set_last_mods(uint8_t mods) { last_mods = mods; }
+void set_last_mods(uint8_t mods) { history_mods[history_head] = mods; }
+
+uint8_t get_repeat_key_history_length(void) { return history_len; }
+
+uint16_t get_repeat_key_history_keycode(uint8_t n) {
+  return (1 <= n && n <= history_len) ? history_keycodes[history_index(n)]
+                                      : KC_NO;
+}
+
+uint8_t get_repeat_key_history_mods(uint8_t n) {
+  return (1 <= n && n <= history_len) ? history_mods[history_index(n)] : 0;
+}
 
 uint16_t get_alt_repeat_key_keycode(void) {
-  uint16_t keycode = last_record.keycode;
-  uint8_t mods = last_mods;
+  uint16_t keycode = get_last_keycode();
+  uint8_t mods = get_last_mods();
 
   // Call the user callback first to give it a chance to override the default
   // alternate key definitions that follow.
@@ -307,65 +434,9 @@ uint16_t get_alt_repeat_key_keycode(void) {
   }
 
   if (IS_QK_BASIC(keycode)) {
-    if ((mods & (MOD_LCTL | MOD_LALT | MOD_LGUI))) {
-      // The last key was pressed with a modifier other than Shift. The
-      // following maps
-      //   mod + F <-> mod + B
-      // and a few others, supporting several core hotkeys used in Emacs, Vim,
-      // less, and other programs.
-      // clang-format off
-      static const uint8_t pairs[][2] PROGMEM = {
-          {KC_F   , KC_B   },  // Forward / Backward.
-          {KC_D   , KC_U   },  // Down / Up.
-          {KC_N   , KC_P   },  // Next / Previous.
-          {KC_A   , KC_E   },  // Home / End.
-          {KC_O   , KC_I   },  // Vim jumplist Older / Newer.
-      };
-      // clang-format on
-      alt_keycode = find_alt_keycode(pairs, sizeof(pairs), keycode);
-    } else {
-      // The last key was pressed with no mods or only Shift. The following map
-      // a few more Vim hotkeys.
-      // clang-format off
-      static const uint8_t pairs[][2] PROGMEM = {
-          {KC_J   , KC_K   },  // Down / Up.
-          {KC_H   , KC_L   },  // Left / Right.
-          // These two lines map W and E to B, and B to W.
-          {KC_W   , KC_B   },  // Forward / Backward by word.
-          {KC_E   , KC_B   },  // Forward / Backward by word.
-      };
-      // clang-format on
-      alt_keycode = find_alt_keycode(pairs, sizeof(pairs), keycode);
-    }
-
-    if (!alt_keycode) {
-      // The following key pairs are considered with any mods.
-      // clang-format off
-      static const uint8_t pairs[][2] PROGMEM = {
-          {KC_LEFT, KC_RGHT},  // Left / Right Arrow.
-          {KC_UP  , KC_DOWN},  // Up / Down Arrow.
-          {KC_HOME, KC_END },  // Home / End.
-          {KC_PGUP, KC_PGDN},  // Page Up / Page Down.
-          {KC_BSPC, KC_DEL },  // Backspace / Delete.
-          {KC_LBRC, KC_RBRC},  // Brackets [ ] and { }.
-#ifdef EXTRAKEY_ENABLE
-          {KC_WBAK, KC_WFWD},  // Browser Back / Forward.
-          {KC_MNXT, KC_MPRV},  // Next / Previous Media Track.
-          {KC_MFFD, KC_MRWD},  // Fast Forward / Rewind Media.
-          {KC_VOLU, KC_VOLD},  // Volume Up / Down.
-          {KC_BRIU, KC_BRID},  // Brightness Up / Down.
-#endif  // EXTRAKEY_ENABLE
-#ifdef MOUSEKEY_ENABLE
-          {KC_MS_L, KC_MS_R},  // Mouse Cursor Left / Right.
-          {KC_MS_U, KC_MS_D},  // Mouse Cursor Up / Down.
-          {KC_WH_L, KC_WH_R},  // Mouse Wheel Left / Right.
-          {KC_WH_U, KC_WH_D},  // Mouse Wheel Up / Down.
-#endif  // MOUSEKEY_ENABLE
-      };
-      // clang-format on
-      alt_keycode = find_alt_keycode(pairs, sizeof(pairs), keycode);
-    }
-
+    const uint16_t entry = pgm_read_word(alt_keycodes + keycode);
+    alt_keycode = (mods & (MOD_LCTL | MOD_LALT | MOD_LGUI)) ? (entry >> 8)
+                                                            : (entry & 0xff);
     if (alt_keycode) {
       // Combine basic keycode with mods.
       return (mods << 8) | alt_keycode;
@@ -376,22 +447,57 @@ uint16_t get_alt_repeat_key_keycode(void) {
 }
 
 void repeat_key_register(void) {
-  repeat_key_invoke(&MAKE_KEYEVENT(0, 0, true));
+  repeat_key_invoke(&MAKE_KEYEVENT(0, 0, true), 0);
 }
 
 void repeat_key_unregister(void) {
-  repeat_key_invoke(&MAKE_KEYEVENT(0, 0, false));
+  repeat_key_invoke(&MAKE_KEYEVENT(0, 0, false), 0);
 }
 
 void repeat_key_tap(void) {
-  repeat_key_register();
-  wait_ms(TAP_CODE_DELAY);
-  repeat_key_unregister();
+  repeat_key_invoke(&MAKE_KEYEVENT(0, 0, true), 0);
+  repeat_key_invoke(&MAKE_KEYEVENT(0, 0, false), TAP_CODE_DELAY);
+}
+
+bool repeat_key_nth_tap(uint8_t n) {
+  if (n < 1 || n > history_len) {
+    return false;
+  }
+  return history_tap(n, 0);
+}
+
+bool repeat_key_back_tap(void) {
+  if (history_step + 2 > history_len) {
+    return false;  // Already at the oldest key.
+  }
+  if (!history_tap(history_step + 2, 0)) {
+    return false;  // Event queue is full.
+  }
+  ++history_step;
+  return true;
+}
+
+uint8_t repeat_key_group_tap(uint8_t n) {
+  // Each key is queued as a press and a release. Limit `n` to what fits in the
+  // free slots, so that the group is never cut short partway and the reserved
+  // slots stay open for real key events that arrive while it plays.
+  const uint8_t max_taps = event_queue_free() / 2;
+  if (n > max_taps) {
+    n = max_taps;
+  }
+  if (n > history_len) {
+    n = history_len;
+  }
+  // Replay oldest first, so that the keys are typed in their original order.
+  for (uint8_t i = n; i >= 1; --i) {
+    history_tap(i, (i == n) ? 0 : TAP_CODE_DELAY);
+  }
+  return n;
 }
 
 bool alt_repeat_key_register(void) {
   if (get_alt_repeat_key_keycode()) {
-    alt_repeat_key_invoke(&MAKE_KEYEVENT(0, 0, true));
+    alt_repeat_key_invoke(&MAKE_KEYEVENT(0, 0, true), 0);
     return true;
   }
   return false;
@@ -399,7 +505,7 @@ bool alt_repeat_key_register(void) {
 
 bool alt_repeat_key_unregister(void) {
   if (get_alt_repeat_key_keycode()) {
-    alt_repeat_key_invoke(&MAKE_KEYEVENT(0, 0, false));
+    alt_repeat_key_invoke(&MAKE_KEYEVENT(0, 0, false), 0);
     return true;
   }
   return false;
@@ -407,9 +513,8 @@ bool alt_repeat_key_unregister(void) {
 
 bool alt_repeat_key_tap(void) {
   if (get_alt_repeat_key_keycode()) {
-    alt_repeat_key_register();
-    wait_ms(TAP_CODE_DELAY);
-    alt_repeat_key_unregister();
+    alt_repeat_key_invoke(&MAKE_KEYEVENT(0, 0, true), 0);
+    alt_repeat_key_invoke(&MAKE_KEYEVENT(0, 0, false), TAP_CODE_DELAY);
     return true;
   }
   return false;
@@ -33,7 +33,14 @@
  *
  * The implementation is a generic event-plumbing strategy that interoperates
  * predictably with most QMK features, including tap-hold keys, Auto Shift,
- * Combos, and userspace macros.
+ * Combos, and userspace macros. Repeated events are plumbed through the event
+ * queue (features/event_queue.c), so `event_queue_task()` must be called from
+ * `housekeeping_task_user()`.
+ *
+ * The last `REPEAT_KEY_HISTORY_SIZE` keys are remembered, not only the last
+ * one. Keys earlier in the history can be repeated with
+ * `repeat_key_nth_tap()`, stepped back through with `repeat_key_back_tap()`,
+ * or the last several keys replayed as a group with `repeat_key_group_tap()`.
  *
  * For full documentation, see
  * <https://getreuer.info/posts/keyboards/repeat-key>
@@ -42,11 +49,17 @@
 #pragma once
 
 #include "quantum.h"
+#include "event_queue.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Number of keys remembered, at most 127. Each takes 3 bytes of RAM.
+#ifndef REPEAT_KEY_HISTORY_SIZE
+#define REPEAT_KEY_HISTORY_SIZE 8
+#endif  // REPEAT_KEY_HISTORY_SIZE
+
 /**
  * Handler function for Repeat Key. Call either this function or
  * `process_repeat_key_with_rev()` (but not both) from `process_record_user()`
@@ -127,6 +140,21 @@ bool remember_last_key_user(uint16_t keycode, keyrecord_t* record,
  */
 uint16_t get_alt_repeat_key_keycode(void);
 
+/**
+ * Additional pairs of alternate basic keycodes, considered with any mods. To
+ * add pairs, define in config.h a list of `X(k, a, b)` entries like
+ *
+ *     #define ALT_REPEAT_KEY_USER_PAIRS(X, k) \
+ *         X(k, KC_MPLY, KC_MSTP)              \
+ *         X(k, KC_CAPS, KC_ESC )
+ *
+ * These are merged at compile time into the table of default alternates, so
+ * they don't slow down Alternate Repeat however many are defined.
+ */
+#ifndef ALT_REPEAT_KEY_USER_PAIRS
+#define ALT_REPEAT_KEY_USER_PAIRS(X, k)
+#endif  // ALT_REPEAT_KEY_USER_PAIRS
+
 /**
  * @brief Optional user callback to define additional alternate keys.
  *
@@ -157,6 +185,61 @@ void repeat_key_unregister(void);
 /** Taps the Repeat Key with a delay of `TAP_CODE_DELAY`. */
 void repeat_key_tap(void);
 
+/** @brief Number of keys in the history, up to `REPEAT_KEY_HISTORY_SIZE`. */
+uint8_t get_repeat_key_history_length(void);
+
+/**
+ * @brief Keycode of the `n`th most recent key, or KC_NO.
+ *
+ * `n` = 1 is the last key, the same as `get_last_keycode()`, `n` = 2 the key
+ * before it, and so on.
+ */
+uint16_t get_repeat_key_history_keycode(uint8_t n);
+
+/** @brief Mods that were active with the `n`th most recent key. */
+uint8_t get_repeat_key_history_mods(uint8_t n);
+
+/**
+ * Taps the `n`th most recent key with its mods, with `n` = 1 being the last
+ * key. This is useful for a key that repeats the second or third last key:
+ *
+ *     case REPEAT2:
+ *       if (record->event.pressed) {
+ *         repeat_key_nth_tap(2);
+ *       }
+ *       return false;
+ *
+ * As with `repeat_key_register()`, such keys should be ignored in
+ * `remember_last_key_user()` so that they don't enter the history themselves.
+ *
+ * @return True if the history has `n` keys and the event queue had room for
+ *         the tap.
+ */
+bool repeat_key_nth_tap(uint8_t n);
+
+/**
+ * Taps the key one further back in the history than the one tapped by the
+ * previous call, starting with the second most recent key (the last key being
+ * what the Repeat Key does). Stepping restarts once another key is remembered.
+ *
+ * @return True if there was a key further back and the event queue had room
+ *         for the tap.
+ */
+bool repeat_key_back_tap(void);
+
+/**
+ * Replays the last `n` keys in their original order, as taps with their mods.
+ * Each key is queued as a press and a release event, so the number replayed is
+ * limited by the room left in the event queue, `event_queue_free() / 2` keys,
+ * leaving the `EVENT_QUEUE_RESERVED` slots for real key events. With an empty
+ * queue, that is `(EVENT_QUEUE_SIZE - EVENT_QUEUE_RESERVED) / 2`. To replay the
+ * full history, define `EVENT_QUEUE_SIZE` in config.h as at least
+ * `2 * REPEAT_KEY_HISTORY_SIZE + EVENT_QUEUE_RESERVED`.
+ *
+ * @return Number of keys replayed.
+ */
+uint8_t repeat_key_group_tap(uint8_t n);
+
 /**
  * Registers (presses down) the Alternate Repeat Key, performing the alternate,
  * if there is one, for the last pressed key. If no alternate is found, the
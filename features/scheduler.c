@@ -0,0 +1,130 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file scheduler.c
+ * @brief Scheduler implementation
+ *
+ * With only a handful of tasks, deadlines are kept in a plain array indexed by
+ * task, rather than a heap or timer wheel. What matters is that the common
+ * case, nothing due, is cheap: `earliest` caches the earliest deadline, so
+ * `scheduler_task()` usually returns after one comparison. The cache may be
+ * earlier than the true earliest deadline after a cancellation, which costs
+ * only an early wake up that finds nothing due and recomputes it.
+ */
+
+#include "scheduler.h"
+
+_Static_assert(SCHEDULER_NUM_TASKS <= 8,
+               "scheduler: The pending mask holds at most 8 tasks.");
+
+static uint16_t deadlines[SCHEDULER_NUM_TASKS];
+static void (*callbacks[SCHEDULER_NUM_TASKS])(void);
+// The kth bit is on if task k has a pending deadline.
+static uint8_t pending = 0;
+// Earliest pending deadline, or possibly earlier. Valid if `pending` != 0.
+static uint16_t earliest = 0;
+#ifdef SCHEDULER_STATS
+static uint16_t max_lateness = 0;
+#endif  // SCHEDULER_STATS
+
+// Returns whether time `a` is strictly before time `b`.
+static bool is_before(uint16_t a, uint16_t b) { return !timer_expired(a, b); }
+
+// Recomputes `earliest` from the pending deadlines.
+static void update_earliest(void) {
+  bool found = false;
+  for (uint8_t i = 0; i < SCHEDULER_NUM_TASKS; ++i) {
+    if ((pending & (UINT8_C(1) << i)) &&
+        (!found || is_before(deadlines[i], earliest))) {
+      earliest = deadlines[i];
+      found = true;
+    }
+  }
+}
+
+void scheduler_wake_at(uint8_t task, void (*callback)(void),
+                       uint16_t deadline) {
+  const uint8_t bit = UINT8_C(1) << task;
+  if ((pending & bit) && !is_before(deadline, deadlines[task])) {
+    return;  // Already due no later than `deadline`.
+  }
+
+  deadlines[task] = deadline;
+  callbacks[task] = callback;
+  if (!pending || is_before(deadline, earliest)) {
+    earliest = deadline;
+  }
+  pending |= bit;
+}
+
+void scheduler_wake(uint8_t task, void (*callback)(void), uint16_t delay_ms) {
+  scheduler_wake_at(task, callback, timer_read() + delay_ms);
+}
+
+void scheduler_cancel(uint8_t task) { pending &= ~(UINT8_C(1) << task); }
+
+bool scheduler_is_pending(uint8_t task) {
+  return (pending & (UINT8_C(1) << task)) != 0;
+}
+
+uint16_t scheduler_next_delay(void) {
+  if (!pending) {
+    return SCHEDULER_IDLE;
+  }
+  const uint16_t now = timer_read();
+  return is_before(now, earliest) ? earliest - now : 0;
+}
+
+void scheduler_task(void) {
+  if (!pending) {
+    return;
+  }
+  const uint16_t now = timer_read();
+  if (is_before(now, earliest)) {
+    return;  // Nothing is due yet.
+  }
+
+  // Take the due tasks out of `pending` before calling any of them, so that
+  // callbacks may wake themselves again.
+  uint8_t due = 0;
+  for (uint8_t i = 0; i < SCHEDULER_NUM_TASKS; ++i) {
+    const uint8_t bit = UINT8_C(1) << i;
+    if ((pending & bit) && !is_before(now, deadlines[i])) {
+      due |= bit;
+#ifdef SCHEDULER_STATS
+      const uint16_t lateness = now - deadlines[i];
+      if (lateness > max_lateness) {
+        max_lateness = lateness;
+      }
+#endif  // SCHEDULER_STATS
+    }
+  }
+  pending &= ~due;
+  update_earliest();
+
+  for (uint8_t i = 0; due; ++i, due >>= 1) {
+    if (due & 1) {
+      callbacks[i]();
+    }
+  }
+}
+
+#ifdef SCHEDULER_STATS
+uint16_t scheduler_get_max_lateness(void) {
+  const uint16_t result = max_lateness;
+  max_lateness = 0;
+  return result;
+}
+#endif  // SCHEDULER_STATS
@@ -0,0 +1,123 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file scheduler.h
+ * @brief Scheduler: one deadline per feature task instead of polling.
+ *
+ * Overview
+ * --------
+ *
+ * Achordion, Orbital Mouse, Sentence Case, Caps Word, Select Word, Layer Lock,
+ * and Mouse Report each have a `*_task()` function meant to be called from
+ * `housekeeping_task_user()` on every main loop iteration. Each call reads the
+ * timer and compares against the feature's own deadline, though nearly always
+ * nothing is due.
+ *
+ * With the scheduler, features instead tell when they next need to run, and
+ * `scheduler_task()` calls them back only once that time has come. Per
+ * iteration, the cost is one timer read and one comparison against the
+ * earliest deadline, or nothing at all when no deadline is pending. The
+ * features above use the scheduler when `SCHEDULER_ENABLE` is defined, and
+ * otherwise continue to work by polling as before.
+ *
+ * Each task has one slot, identified by `SCHEDULER_TASK_*`. A slot holds one
+ * deadline: `scheduler_wake_at()` moves it earlier but never later. A task
+ * runs once per wake up and may wake sooner than needed, for instance if an
+ * idle timer it was woken for has since been extended. So task functions still
+ * check their own timers, and before returning, request a new wake up for
+ * anything still pending.
+ *
+ * In keymap.c, call `scheduler_task()` from `housekeeping_task_user()`:
+ *
+ *     #include "features/scheduler.h"
+ *
+ *     void housekeeping_task_user(void) {
+ *       scheduler_task();
+ *       // Other tasks...
+ *     }
+ *
+ * and in rules.mk, add `OPT_DEFS += -DSCHEDULER_ENABLE` and
+ * `SRC += features/scheduler.c`.
+ *
+ * @note Deadlines are 16-bit `timer_read()` times, and must be less than half
+ * the timer period (32768 ms) in the future.
+ */
+
+#pragma once
+
+#include "quantum.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Identifies a task's slot in the scheduler. */
+enum {
+  SCHEDULER_TASK_ACHORDION,
+  SCHEDULER_TASK_CAPS_WORD,
+  SCHEDULER_TASK_EVENT_QUEUE,
+  SCHEDULER_TASK_LAYER_LOCK,
+  SCHEDULER_TASK_MOUSE_REPORT,
+  SCHEDULER_TASK_ORBITAL_MOUSE,
+  SCHEDULER_TASK_SELECT_WORD,
+  SCHEDULER_TASK_SENTENCE_CASE,
+  SCHEDULER_NUM_TASKS,
+};
+
+/** Value of `scheduler_next_delay()` when no deadline is pending. */
+#define SCHEDULER_IDLE UINT16_MAX
+
+/**
+ * Requests that `callback` be called no later than time `deadline`.
+ *
+ * If the task already has an earlier deadline, that one is kept.
+ *
+ * @param task      Task slot, one of `SCHEDULER_TASK_*`.
+ * @param callback  Function to call.
+ * @param deadline  Time as from `timer_read()`.
+ */
+void scheduler_wake_at(uint8_t task, void (*callback)(void), uint16_t deadline);
+
+/** Requests that `callback` be called within `delay_ms` from now. */
+void scheduler_wake(uint8_t task, void (*callback)(void), uint16_t delay_ms);
+
+/** Cancels the task's pending deadline, if any. */
+void scheduler_cancel(uint8_t task);
+
+/** Returns whether the task has a pending deadline. */
+bool scheduler_is_pending(uint8_t task);
+
+/**
+ * Gets the time in ms until the earliest pending deadline, 0 if overdue, or
+ * `SCHEDULER_IDLE` if none is pending. The main loop may skip work or sleep
+ * for this long.
+ */
+uint16_t scheduler_next_delay(void);
+
+/** Calls the tasks whose deadlines have passed. */
+void scheduler_task(void);
+
+#ifdef SCHEDULER_STATS
+/**
+ * Gets the largest lateness in ms of a task call relative to its deadline
+ * since the last call to this function, then resets it. This measures the
+ * jitter of all scheduled tasks in one place.
+ */
+uint16_t scheduler_get_max_lateness(void);
+#endif  // SCHEDULER_STATS
+
+#ifdef __cplusplus
+}
+#endif
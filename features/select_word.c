@@ -22,30 +22,302 @@
 
 #include "select_word.h"
 
-// Mac users, uncomment this line:
+#ifdef SCHEDULER_ENABLE
+#include "scheduler.h"
+#endif  // SCHEDULER_ENABLE
+
+// Mac hotkeys are used when OS detection finds macOS or iOS. Without OS
+// detection, Mac users, uncomment this line:
 // #define MAC_HOTKEYS
 
+// Time in ms that the macro is held before it begins repeating, and the time
+// between repeats after that.
+#ifndef SELECT_WORD_REPEAT_DELAY_MS
+#define SELECT_WORD_REPEAT_DELAY_MS 300
+#endif  // SELECT_WORD_REPEAT_DELAY_MS
+#ifndef SELECT_WORD_REPEAT_MS
+#define SELECT_WORD_REPEAT_MS 80
+#endif  // SELECT_WORD_REPEAT_MS
+
+// Minimum time in ms between taps, by default `TAP_CODE_DELAY` as for
+// `tap_code()`. With a delay of 0, all taps of a selection are sent at once, as
+// fast as the host accepts the reports.
+#ifndef SELECT_WORD_TAP_DELAY_MS
+#define SELECT_WORD_TAP_DELAY_MS TAP_CODE_DELAY
+#endif  // SELECT_WORD_TAP_DELAY_MS
+
+// Number of pending runs of taps.
+#ifndef SELECT_WORD_QUEUE_SIZE
+#define SELECT_WORD_QUEUE_SIZE 4
+#endif  // SELECT_WORD_QUEUE_SIZE
+
 // clang-format off
 enum {
-    STATE_NONE,        // No selection.
-    STATE_SELECTED,    // Macro released with something selected.
-    STATE_WORD,        // Macro held with word(s) selected.
-    STATE_FIRST_LINE,  // Macro held with one line selected.
-    STATE_LINE         // Macro held with multiple lines selected.
+    STATE_NONE,      // No selection.
+    STATE_SELECTED,  // Macro released with something selected.
+    STATE_WORD,      // Macro held with word(s) selected.
+    STATE_LINE,      // Macro held with line(s) selected.
+    STATE_EXPAND,    // Macro held with the selection expanded.
 };
 // clang-format on
 static uint8_t state = STATE_NONE;
 
+/** A run of `count` taps of `keycode` with `mods` held. */
+typedef struct {
+  uint8_t mods;
+  uint8_t keycode;
+  uint8_t count;
+} tap_run_t;
+
+// Queue of taps to send, so that a selection is worked out up front and then
+// sent without waiting on the main loop between taps.
+static tap_run_t queue[SELECT_WORD_QUEUE_SIZE];
+static uint8_t queue_head = 0;
+static uint8_t queue_size = 0;
+// While the macro is held, time when it next repeats, or 0 if not held.
+static uint16_t repeat_timer = 0;
+#if SELECT_WORD_TAP_DELAY_MS > 0
+// Time when the next tap may be sent.
+static uint16_t tap_timer = 0;
+#endif  // SELECT_WORD_TAP_DELAY_MS > 0
+// The last tap sent. If `select_word_task()` isn't called, it is held down
+// while the macro is held, so that the OS repeats it.
+static tap_run_t last_tap = {0};
+static bool holding_last_tap = false;
+// Mods added to hold the last tap, released with it.
+static uint8_t held_mods = 0;
+#ifndef SCHEDULER_ENABLE
+// Whether `select_word_task()` has been called.
+static bool task_called = false;
+#endif  // SCHEDULER_ENABLE
+
 // Idle timeout timer to disable Select Word after a period of inactivity.
 #if SELECT_WORD_TIMEOUT > 0
 static uint16_t idle_timer = 0;
+#endif  // SELECT_WORD_TIMEOUT > 0
 
-void select_word_task(void) {
-  if (state && timer_expired(timer_read(), idle_timer)) {
-    state = STATE_NONE;
+#ifdef SCHEDULER_ENABLE
+// Wakes `select_word_task()` at `deadline`. The scheduler keeps the earliest
+// of the deadlines requested for the idle timer, repeats, and taps.
+#define schedule_task(deadline) \
+  scheduler_wake_at(SCHEDULER_TASK_SELECT_WORD, select_word_task, deadline)
+#else
+#define schedule_task(deadline)
+#endif  // SCHEDULER_ENABLE
+
+/**
+ * Returns true if `select_word_task()` runs, so that taps may be paced and the
+ * selection repeated while the macro is held. Under `SCHEDULER_ENABLE`, the
+ * scheduler calls it.
+ */
+static bool task_runs(void) {
+#ifdef SCHEDULER_ENABLE
+  return true;
+#else
+  return task_called;
+#endif  // SCHEDULER_ENABLE
+}
+
+/** Returns true if Mac hotkeys should be used. */
+static bool use_mac_hotkeys(void) {
+#if defined(MAC_HOTKEYS)
+  return true;
+#elif defined(OS_DETECTION_ENABLE)
+  const os_variant_t os = detected_host_os();
+  return os == OS_MACOS || os == OS_IOS;
+#else
+  return false;
+#endif
+}
+
+/**
+ * Sends queued taps. Each tap is one report pressing the key with its mods and
+ * one releasing it, with no reports just to change mods in between. Without
+ * the task to pace them, all taps are sent now with `wait_ms()` between them.
+ */
+static void send_taps(void) {
+  if (!queue_size) {
+    return;
+  }
+#if SELECT_WORD_TAP_DELAY_MS > 0
+  const bool paced = task_runs();
+  if (paced && !timer_expired(timer_read(), tap_timer)) {
+    schedule_task(tap_timer);
+    return;
+  }
+#endif  // SELECT_WORD_TAP_DELAY_MS > 0
+
+  const uint8_t saved_mods = get_mods();
+  const uint8_t saved_weak_mods = get_weak_mods();
+  clear_weak_mods();
+
+  do {
+    tap_run_t* run = &queue[queue_head];
+    set_mods(run->mods);
+    register_code(run->keycode);
+    unregister_code(run->keycode);
+    last_tap = (tap_run_t){.mods = run->mods, .keycode = run->keycode};
+    if (--run->count == 0) {
+      queue_head = (queue_head + 1) % SELECT_WORD_QUEUE_SIZE;
+      --queue_size;
+    }
+#if SELECT_WORD_TAP_DELAY_MS > 0
+    if (paced) {
+      // Send one tap at a time, paced by the task.
+      tap_timer = timer_read() + SELECT_WORD_TAP_DELAY_MS;
+      if (queue_size) {
+        schedule_task(tap_timer);
+      }
+      break;
+    } else if (queue_size) {
+      wait_ms(SELECT_WORD_TAP_DELAY_MS);
+    }
+#endif  // SELECT_WORD_TAP_DELAY_MS > 0
+  } while (queue_size);
+
+  set_mods(saved_mods);
+  set_weak_mods(saved_weak_mods);
+  send_keyboard_report();
+}
+
+/**
+ * Holds the last tap down, with its mods, until `release_last_tap()`. The OS
+ * then repeats it, as it would if the key were held.
+ */
+static void hold_last_tap(void) {
+  if (!last_tap.keycode) {
+    return;
+  }
+  held_mods = last_tap.mods & ~get_mods();
+  add_mods(last_tap.mods);
+  register_code(last_tap.keycode);
+  holding_last_tap = true;
+}
+
+/** Releases the tap held by `hold_last_tap()`. */
+static void release_last_tap(void) {
+  if (holding_last_tap) {
+    holding_last_tap = false;
+    unregister_code(last_tap.keycode);
+    unregister_mods(held_mods);
   }
 }
+
+/** Queues `count` taps of `keycode` with `mods`. */
+static void push_taps(uint8_t mods, uint8_t keycode, uint8_t count) {
+  if (!count) {
+    return;
+  }
+  if (queue_size) {
+    // Extend the last run if it taps the same key.
+    tap_run_t* last =
+        &queue[(queue_head + queue_size - 1) % SELECT_WORD_QUEUE_SIZE];
+    if (last->mods == mods && last->keycode == keycode &&
+        last->count <= UINT8_MAX - count) {
+      last->count += count;
+      return;
+    }
+  }
+  while (queue_size == SELECT_WORD_QUEUE_SIZE) {
+#if SELECT_WORD_TAP_DELAY_MS > 0
+    tap_timer = timer_read();  // The queue is full; send a tap now.
+#endif  // SELECT_WORD_TAP_DELAY_MS > 0
+    send_taps();
+  }
+  queue[(queue_head + queue_size) % SELECT_WORD_QUEUE_SIZE] =
+      (tap_run_t){.mods = mods, .keycode = keycode, .count = count};
+  ++queue_size;
+}
+
+void select_word(uint8_t n) {
+  // Ctrl + arrows move by word, or Alt (Option) + arrows on Mac.
+  const uint8_t word_mod =
+      use_mac_hotkeys() ? MOD_BIT(KC_LALT) : MOD_BIT(KC_LCTL);
+  if (state == STATE_NONE) {
+    // On first use, tap Ctrl+Right then Ctrl+Left (or with Alt on Mac) to
+    // ensure the cursor is positioned at the beginning of the word.
+    push_taps(word_mod, KC_RGHT, 1);
+    push_taps(word_mod, KC_LEFT, 1);
+  }
+  push_taps(word_mod | MOD_BIT(KC_LSFT), KC_RGHT, n);
+  send_taps();
+  state = STATE_WORD;
+}
+
+void select_word_line(uint8_t n) {
+  if (!n) {
+    return;
+  }
+  if (state == STATE_NONE) {
+    if (use_mac_hotkeys()) {
+      // Tap GUI (Command) + Left, then Shift + GUI + Right.
+      push_taps(MOD_BIT(KC_LGUI), KC_LEFT, 1);
+      push_taps(MOD_BIT(KC_LGUI) | MOD_BIT(KC_LSFT), KC_RGHT, 1);
+    } else {
+      // Tap Home, then Shift + End.
+      push_taps(0, KC_HOME, 1);
+      push_taps(MOD_BIT(KC_LSFT), KC_END, 1);
+    }
+    --n;
+  }
+  push_taps(MOD_BIT(KC_LSFT), KC_DOWN, n);
+  send_taps();
+  state = STATE_LINE;
+}
+
+void select_word_expand(uint8_t n) {
+  // Expand Selection hotkey, as in VS Code: Shift + Alt + Right, or
+  // Ctrl + Shift + Command + Right on Mac.
+  const uint8_t mods = use_mac_hotkeys()
+                           ? MOD_BIT(KC_LCTL) | MOD_BIT(KC_LSFT) |
+                                 MOD_BIT(KC_LGUI)
+                           : MOD_BIT(KC_LSFT) | MOD_BIT(KC_LALT);
+  push_taps(mods, KC_RGHT, n);
+  send_taps();
+  state = STATE_EXPAND;
+}
+
+void select_word_task(void) {
+#ifndef SCHEDULER_ENABLE
+  task_called = true;
+#endif  // SCHEDULER_ENABLE
+  send_taps();
+
+  if (repeat_timer) {
+    const uint16_t now = timer_read();
+    if (timer_expired(now, repeat_timer)) {
+      switch (state) {
+        case STATE_WORD:
+          select_word(1);
+          break;
+        case STATE_LINE:
+          select_word_line(1);
+          break;
+        case STATE_EXPAND:
+          select_word_expand(1);
+          break;
+      }
+      // Repeat on a fixed cadence, unless the task has fallen behind.
+      repeat_timer += SELECT_WORD_REPEAT_MS;
+      if (timer_expired(now, repeat_timer)) {
+        repeat_timer = now + SELECT_WORD_REPEAT_MS;
+      }
+      repeat_timer |= 1;
+    }
+    schedule_task(repeat_timer);
+  }
+
+#if SELECT_WORD_TIMEOUT > 0
+  if (state) {
+    if (timer_expired(timer_read(), idle_timer)) {
+      state = STATE_NONE;
+    } else {
+      // The timer was extended since the last wake up.
+      schedule_task(idle_timer);
+    }
+  }
 #endif  // SELECT_WORD_TIMEOUT > 0
+}
 
 bool process_select_word(uint16_t keycode, keyrecord_t* record,
                          uint16_t sel_keycode) {
@@ -55,84 +327,48 @@ bool process_select_word(uint16_t keycode, keyrecord_t* record,
 
 #if SELECT_WORD_TIMEOUT > 0
   idle_timer = record->event.time + SELECT_WORD_TIMEOUT;
+  schedule_task(idle_timer);
 #endif  // SELECT_WORD_TIMEOUT > 0
 
   if (keycode == sel_keycode && record->event.pressed) {  // On key press.
-    const uint8_t mods = get_mods();
 #ifndef NO_ACTION_ONESHOT
-    const bool shifted = (mods | get_oneshot_mods()) & MOD_MASK_SHIFT;
+    const uint8_t mods = get_mods() | get_oneshot_mods();
     clear_oneshot_mods();
 #else
-    const bool shifted = mods & MOD_MASK_SHIFT;
+    const uint8_t mods = get_mods();
 #endif  // NO_ACTION_ONESHOT
 
-    if (!shifted) {  // Select word.
-#ifdef MAC_HOTKEYS
-      set_mods(MOD_BIT(KC_LALT));  // Hold Left Alt (Option).
-#else
-      set_mods(MOD_BIT(KC_LCTL));  // Hold Left Ctrl.
-#endif  // MAC_HOTKEYS
-      if (state == STATE_NONE) {
-        // On first use, tap Ctrl+Right then Ctrl+Left (or with Alt on Mac) to
-        // ensure the cursor is positioned at the beginning of the word.
-        send_keyboard_report();
-        tap_code(KC_RGHT);
-        tap_code(KC_LEFT);
-      }
-      register_mods(MOD_BIT(KC_LSFT));
-      register_code(KC_RGHT);
-      state = STATE_WORD;
-    } else {  // Select line.
-      if (state == STATE_NONE) {
-#ifdef MAC_HOTKEYS
-        // Tap GUI (Command) + Left, then Shift + GUI + Right.
-        set_mods(MOD_BIT(KC_LGUI));
-        send_keyboard_report();
-        tap_code(KC_LEFT);
-        register_mods(MOD_BIT(KC_LSFT));
-        tap_code(KC_RGHT);
-#else
-        // Tap Home, then Shift + End.
-        clear_mods();
-        send_keyboard_report();
-        tap_code(KC_HOME);
-        register_mods(MOD_BIT(KC_LSFT));
-        tap_code(KC_END);
-#endif  // MAC_HOTKEYS
-        set_mods(mods);
-        state = STATE_FIRST_LINE;
-      } else {
-        register_code(KC_DOWN);
-        state = STATE_LINE;
-      }
+    if (mods & MOD_MASK_ALT) {  // Expand to the enclosing token.
+      select_word_expand(1);
+    } else if (mods & MOD_MASK_SHIFT) {  // Select line.
+      select_word_line(1);
+    } else {  // Select word.
+      select_word(1);
+    }
+    if (task_runs()) {
+      // While held, repeat instead of relying on the OS's key repeat.
+      repeat_timer = (record->event.time + SELECT_WORD_REPEAT_DELAY_MS) | 1;
+      schedule_task(repeat_timer);
+    } else {
+      hold_last_tap();
     }
     return false;
   }
 
   // `sel_keycode` was released, or another key was pressed.
+  repeat_timer = 0;
+  release_last_tap();
   switch (state) {
     case STATE_WORD:
-      unregister_code(KC_RGHT);
-#ifdef MAC_HOTKEYS
-      unregister_mods(MOD_BIT(KC_LSFT) | MOD_BIT(KC_LALT));
-#else
-      unregister_mods(MOD_BIT(KC_LSFT) | MOD_BIT(KC_LCTL));
-#endif  // MAC_HOTKEYS
-      state = STATE_SELECTED;
-      break;
-
-    case STATE_FIRST_LINE:
-      state = STATE_SELECTED;
-      break;
-
     case STATE_LINE:
-      unregister_code(KC_DOWN);
+    case STATE_EXPAND:
       state = STATE_SELECTED;
       break;
 
     case STATE_SELECTED:
       if (keycode == KC_ESC) {
-        tap_code(KC_RGHT);
+        push_taps(0, KC_RGHT, 1);  // Collapse the selection.
+        send_taps();
         state = STATE_NONE;
         return false;
       }
@@ -24,11 +24,27 @@
  * word. The effect is similar to word selection (W) in the Kakoune editor.
  *
  * Pressing the button with shift selects the current line, and pressing the
- * button again extends the selection to the following line.
+ * button again extends the selection to the following line. Pressing the button
+ * with Alt expands the selection to the enclosing token, using the Expand
+ * Selection hotkey of VS Code and similar editors.
  *
- * @note Note for Mac users: Windows/Linux editing hotkeys are assumed by
- * default. Uncomment the `#define MAC_HOTKEYS` line in select_word.c for Mac
- * hotkeys. The Mac implementation is untested, let me know if it has problems.
+ * The taps for a selection are worked out up front and sent as one report to
+ * press each key with its mods and one to release it, spaced by
+ * `SELECT_WORD_TAP_DELAY_MS` (default `TAP_CODE_DELAY`). With a delay of 0,
+ * selecting is as fast as the host accepts reports.
+ *
+ * @note Call `select_word_task()` from `housekeeping_task_user()`, even without
+ * `SELECT_WORD_TIMEOUT`. Holding the button then repeats the selection every
+ * `SELECT_WORD_REPEAT_MS` (default 80) after `SELECT_WORD_REPEAT_DELAY_MS`
+ * (default 300), and the taps are paced without blocking. Until the task is
+ * called, holding the button holds the last key of the selection for the OS to
+ * repeat, and the taps are spaced with `wait_ms()`, as in earlier versions.
+ *
+ * @note Note for Mac users: with OS detection (`OS_DETECTION_ENABLE = yes` in
+ * rules.mk), Mac hotkeys are used when the host is detected as macOS or iOS.
+ * Otherwise, Windows/Linux editing hotkeys are assumed by default. Uncomment
+ * the `#define MAC_HOTKEYS` line in select_word.c to always use Mac hotkeys.
+ * The Mac implementation is untested, let me know if it has problems.
  *
  * For full documentation, see
  * <https://getreuer.info/posts/keyboards/select-word>
@@ -47,18 +63,27 @@ bool process_select_word(uint16_t keycode, keyrecord_t* record,
                          uint16_t sel_keycode);
 
 /**
- * @fn select_word_task(void)
  * Matrix task function for Select Word.
  *
- * If using `SELECT_WORD_TIMEOUT`, call this function from your
- * `housekeeping_task_user()` function in keymap.c. (If no timeout is set,
- * calling `select_word_task()` has no effect.)
+ * Call this function from your `housekeeping_task_user()` function in
+ * keymap.c. It repeats the selection while the button is held, sends paced
+ * taps, and if using `SELECT_WORD_TIMEOUT`, handles the timeout. Under
+ * `SCHEDULER_ENABLE`, `scheduler_task()` calls this when any of these is due.
+ * Without it, the OS's key repeat is used instead.
  */
-#if SELECT_WORD_TIMEOUT > 0
 void select_word_task(void);
-#else
-static inline void select_word_task(void) {}
-#endif  // SELECT_WORD_TIMEOUT > 0
+
+/**
+ * Selects `n` words forward. If nothing is selected, the selection begins at
+ * the start of the current word; otherwise it is extended.
+ */
+void select_word(uint8_t n);
+
+/** Selects `n` lines, beginning with the current line if nothing is selected. */
+void select_word_line(uint8_t n);
+
+/** Expands the selection `n` times to the enclosing token or bracket. */
+void select_word_expand(uint8_t n);
 
 #ifdef __cplusplus
 }
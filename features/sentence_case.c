@@ -22,6 +22,10 @@
 
 #include "sentence_case.h"
 
+#ifdef SCHEDULER_ENABLE
+#include "scheduler.h"
+#endif  // SCHEDULER_ENABLE
+
 #include <string.h>
 
 #if !defined(IS_QK_MOD_TAP)
@@ -48,8 +52,67 @@ enum {
   STATE_PRIMED,   /**< "Primed" state, in the space following an ending. */
   STATE_DISABLED, /**< Sentence Case is disabled. */
 };
+
+/** Columns of the transition table, by key class. */
+enum {
+  CLASS_LETTER,  /**< 'a' */
+  CLASS_ENDING,  /**< '.' */
+  CLASS_SPACE,   /**< ' ' */
+  CLASS_QUOTE,   /**< '\'' */
+  CLASS_SYMBOL,  /**< '#' */
+  NUM_CLASSES,
+};
+
+// Flags combined with the next state in `transitions`.
+#define TRANSITION_STATE_MASK 0x0f
+/** Start of a sentence: capitalize the letter, unless suppressed. */
+#define TRANSITION_MATCH 0x80
+/** Go to the next state only if `sentence_case_check_ending()`, else INIT. */
+#define TRANSITION_CHECK_ENDING 0x40
+/** Clear `suppress_key`. */
+#define TRANSITION_CLEAR_SUPPRESS 0x20
+
+// We search for sentence beginnings using a simple finite state machine. It
+// matches things like "a. a" and "a.  a" but not "a.. a" or "a.a. a". The
+// state transition matrix is:
+//
+//             'a'       '.'      ' '      '\''     '#'
+//           +----------------------------------------------
+//   INIT    | WORD      ABBREV   INIT     INIT     INIT
+//   WORD    | WORD      ENDING   INIT     WORD     INIT
+//   ABBREV  | ABBREV    ABBREV   INIT     ABBREV   INIT
+//   ENDING  | ABBREV    ABBREV   PRIMED*  ENDING   INIT
+//   PRIMED  | match!    ABBREV   PRIMED   PRIMED   INIT
+//
+// (*) if `sentence_case_check_ending()` says it is a real ending.
+static const uint8_t transitions[][NUM_CLASSES] PROGMEM = {
+  [STATE_INIT] = {
+    STATE_WORD, STATE_ABBREV, STATE_INIT, STATE_INIT, STATE_INIT,
+  },
+  [STATE_WORD] = {
+    STATE_WORD, STATE_ENDING, STATE_INIT, STATE_WORD, STATE_INIT,
+  },
+  [STATE_ABBREV] = {
+    STATE_ABBREV, STATE_ABBREV, STATE_INIT, STATE_ABBREV, STATE_INIT,
+  },
+  [STATE_ENDING] = {
+    STATE_ABBREV, STATE_ABBREV,
+    STATE_PRIMED | TRANSITION_CHECK_ENDING | TRANSITION_CLEAR_SUPPRESS,
+    STATE_ENDING, STATE_INIT,
+  },
+  [STATE_PRIMED] = {
+    STATE_WORD | TRANSITION_MATCH, STATE_ABBREV,
+    STATE_PRIMED | TRANSITION_CLEAR_SUPPRESS, STATE_PRIMED, STATE_INIT,
+  },
+};
 // clang-format on
 
+/**
+ * Key classes indexed by basic keycode, each entry holding the class codes of
+ * the key without Shift in the low nibble and with Shift in the high nibble.
+ */
+static const uint8_t key_classes[256] PROGMEM = {SENTENCE_CASE_KEY_CLASSES};
+
 #if SENTENCE_CASE_TIMEOUT > 0
 static uint16_t idle_timer = 0;
 #endif  // SENTENCE_CASE_TIMEOUT > 0
@@ -127,9 +190,22 @@ bool is_sentence_case_primed(void) { return sentence_state == STATE_PRIMED; }
 #error "sentence_case: SENTENCE_CASE_TIMEOUT must be between 100 and 30000 ms"
 #endif
 
+#ifdef SCHEDULER_ENABLE
+// Wakes `sentence_case_task()` when the idle timer expires.
+#define schedule_task()                                                 \
+  scheduler_wake_at(SCHEDULER_TASK_SENTENCE_CASE, sentence_case_task, \
+                    idle_timer)
+#else
+#define schedule_task()
+#endif  // SCHEDULER_ENABLE
+
 void sentence_case_task(void) {
-  if (idle_timer && timer_expired(timer_read(), idle_timer)) {
-    clear_state_history();  // Timed out; clear all state.
+  if (idle_timer) {
+    if (timer_expired(timer_read(), idle_timer)) {
+      clear_state_history();  // Timed out; clear all state.
+    } else {
+      schedule_task();  // The timer was extended since the last wake up.
+    }
   }
 }
 #endif  // SENTENCE_CASE_TIMEOUT > 0
@@ -142,6 +218,7 @@ bool process_sentence_case(uint16_t keycode, keyrecord_t* record) {
 
 #if SENTENCE_CASE_TIMEOUT > 0
   idle_timer = (record->event.time + SENTENCE_CASE_TIMEOUT) | 1;
+  schedule_task();
 #endif  // SENTENCE_CASE_TIMEOUT > 0
 
   switch (keycode) {
@@ -201,74 +278,50 @@ bool process_sentence_case(uint16_t keycode, keyrecord_t* record) {
   }
 
   const uint8_t mods = get_mods() | get_weak_mods() | get_oneshot_mods();
-  uint8_t new_state = STATE_INIT;
-
-  // We search for sentence beginnings using a simple finite state machine. It
-  // matches things like "a. a" and "a.  a" but not "a.. a" or "a.a. a". The
-  // state transition matrix is:
-  //
-  //             'a'       '.'      ' '      '\''
-  //           +-------------------------------------
-  //   INIT    | WORD      INIT     INIT     INIT
-  //   WORD    | WORD      ENDING   INIT     WORD
-  //   ABBREV  | ABBREV    ABBREV   INIT     ABBREV
-  //   ENDING  | ABBREV    INIT     PRIMED   ENDING
-  //   PRIMED  | match!    INIT     PRIMED   PRIMED
-  char code = sentence_case_press_user(keycode, record, mods);
+  const char code = sentence_case_press_user(keycode, record, mods);
 #if defined SENTENCE_CASE_DEBUG
   dprintf("Sentence Case: code = '%c' (%d)\n", code, (int)code);
 #endif  // SENTENCE_CASE_DEBUG
+  uint8_t key_class;
   switch (code) {
     case '\0':  // Current key should be ignored.
       return true;
-
-    case 'a':  // Current key is a letter.
-      switch (sentence_state) {
-        case STATE_ABBREV:
-        case STATE_ENDING:
-          new_state = STATE_ABBREV;
-          break;
-
-        case STATE_PRIMED:
-          // This is the start of a sentence.
-          if (keycode != suppress_key) {
-            suppress_key = keycode;
-            set_oneshot_mods(MOD_BIT(KC_LSFT));  // Shift mod to capitalize.
-            new_state = STATE_WORD;
-          }
-          break;
-
-        default:
-          new_state = STATE_WORD;
-      }
+    case 'a':
+      key_class = CLASS_LETTER;
       break;
-
-    case '.':  // Current key is sentence-ending punctuation.
-      switch (sentence_state) {
-        case STATE_WORD:
-          new_state = STATE_ENDING;
-          break;
-
-        default:
-          new_state = STATE_ABBREV;
-      }
+    case '.':
+      key_class = CLASS_ENDING;
+      break;
+    case ' ':
+      key_class = CLASS_SPACE;
+      break;
+    case '\'':
+      key_class = CLASS_QUOTE;
       break;
+    default:
+      key_class = CLASS_SYMBOL;
+  }
 
-    case ' ':  // Current key is a space.
-      if (sentence_state == STATE_PRIMED ||
-          (sentence_state == STATE_ENDING
+  const uint8_t transition =
+      pgm_read_byte(&transitions[sentence_state][key_class]);
+  uint8_t new_state = transition & TRANSITION_STATE_MASK;
 #if SENTENCE_CASE_BUFFER_SIZE > 1
-           && sentence_case_check_ending(key_buffer)
+  if ((transition & TRANSITION_CHECK_ENDING) &&
+      !sentence_case_check_ending(key_buffer)) {
+    new_state = STATE_INIT;
+  }
 #endif  // SENTENCE_CASE_BUFFER_SIZE > 1
-               )) {
-        new_state = STATE_PRIMED;
-        suppress_key = KC_NO;
-      }
-      break;
-
-    case '\'':  // Current key is a quote.
-      new_state = sentence_state;
-      break;
+  if ((transition & TRANSITION_CLEAR_SUPPRESS) && new_state == STATE_PRIMED) {
+    suppress_key = KC_NO;
+  }
+  if (transition & TRANSITION_MATCH) {
+    // This is the start of a sentence.
+    if (keycode != suppress_key) {
+      suppress_key = keycode;
+      set_oneshot_mods(MOD_BIT(KC_LSFT));  // Shift mod to capitalize.
+    } else {
+      new_state = STATE_INIT;
+    }
   }
 
     // Slide key_buffer and state_history buffers one element to the left.
@@ -324,36 +377,23 @@ __attribute__((weak)) bool sentence_case_check_ending(const uint16_t* buffer) {
   return true;  // Real sentence ending; capitalize next letter.
 }
 
-__attribute__((weak)) char sentence_case_press_user(uint16_t keycode,
-                                                    keyrecord_t* record,
-                                                    uint8_t mods) {
+char sentence_case_key_class(uint16_t keycode, uint8_t mods) {
   if ((mods & ~(MOD_MASK_SHIFT | MOD_BIT(KC_RALT))) == 0) {
-    const bool shifted = mods & MOD_MASK_SHIFT;
-    switch (keycode) {
-      case KC_A ... KC_Z:
-        return 'a';  // Letter key.
-
-      case KC_DOT:  // . is punctuation, Shift . is a symbol (>)
-        return !shifted ? '.' : '#';
-      case KC_1:
-      case KC_SLSH:
-        return shifted ? '.' : '#';
-      case KC_EXLM:
-      case KC_QUES:
-        return '.';
-      case KC_2 ... KC_0:  // 2 3 4 5 6 7 8 9 0
-      case KC_AT ... KC_RPRN:  // @ # $ % ^ & * ( )
-      case KC_MINS ... KC_SCLN:  // - = [ ] backslash ;
-      case KC_UNDS ... KC_COLN:  // _ + { } | :
-      case KC_GRV:
-      case KC_COMM:
-        return '#';  // Symbol key.
-
-      case KC_SPC:
-        return ' ';  // Space key.
-
-      case KC_QUOT:
-        return '\'';  // Quote key.
+    bool shifted = (mods & MOD_MASK_SHIFT) != 0;
+    // Look up shifted keycodes like KC_EXLM as the basic keycode with Shift.
+    if (IS_QK_MODS(keycode) &&
+        (QK_MODS_GET_MODS(keycode) & 0x0f) == MOD_LSFT) {
+      keycode = QK_MODS_GET_BASIC_KEYCODE(keycode);
+      shifted = true;
+    }
+
+    if (IS_QK_BASIC(keycode)) {
+      static const char class_codes[] = {'\0', 'a', '.', ' ', '\'', '#'};
+      const uint8_t classes = pgm_read_byte(key_classes + keycode);
+      const uint8_t code = shifted ? (classes >> 4) : (classes & 0xf);
+      if (code && code < sizeof(class_codes)) {
+        return class_codes[code];
+      }
     }
   }
 
@@ -362,6 +402,12 @@ __attribute__((weak)) char sentence_case_press_user(uint16_t keycode,
   return '\0';
 }
 
+__attribute__((weak)) char sentence_case_press_user(uint16_t keycode,
+                                                    keyrecord_t* record,
+                                                    uint8_t mods) {
+  return sentence_case_key_class(keycode, mods);
+}
+
 __attribute__((weak)) void sentence_case_primed(bool primed) {}
 
 #endif  // NO_ACTION_ONESHOT
@@ -51,6 +51,49 @@
 extern "C" {
 #endif
 
+/**
+ * Sentence Case key class of a basic keycode, as typed without and with Shift.
+ * The classes are written as the chars returned by `sentence_case_press_user()`
+ * ('a', '.', '#', ' ', '\''), or '\0' for keys that clear Sentence Case.
+ */
+#define SENTENCE_CASE_CLASS(unshifted, shifted)   \
+  (SENTENCE_CASE_CLASS_CODE_(unshifted) |         \
+   (SENTENCE_CASE_CLASS_CODE_(shifted) << 4))
+#define SENTENCE_CASE_CLASS_CODE_(c)                              \
+  ((c) == 'a' ? 1 : (c) == '.' ? 2 : (c) == ' ' ? 3 : (c) == '\'' ? 4 \
+   : (c) == '#' ? 5 : 0)
+
+/**
+ * Default key classes, as designated initializers of a 256-entry table indexed
+ * by basic keycode. Keys not listed clear Sentence Case. Shifted keycodes like
+ * KC_EXLM are looked up as their basic keycode with Shift.
+ *
+ * To customize, define `SENTENCE_CASE_KEY_CLASSES` in config.h with the same
+ * syntax. For instance, to treat Shift + comma as sentence-ending punctuation:
+ *
+ *     #define SENTENCE_CASE_KEY_CLASSES            \
+ *       [KC_A ... KC_Z] = SENTENCE_CASE_CLASS('a', 'a'), \
+ *       [KC_COMM] = SENTENCE_CASE_CLASS('#', '.'),       \
+ *       ...
+ */
+// clang-format off
+#define SENTENCE_CASE_DEFAULT_KEY_CLASSES                                  \
+  [KC_A ... KC_Z]       = SENTENCE_CASE_CLASS('a', 'a'),  /* Letters. */   \
+  [KC_DOT]              = SENTENCE_CASE_CLASS('.', '#'),  /* . > */        \
+  [KC_1]                = SENTENCE_CASE_CLASS('#', '.'),  /* 1 ! */        \
+  [KC_SLSH]             = SENTENCE_CASE_CLASS('#', '.'),  /* / ? */        \
+  [KC_2 ... KC_0]       = SENTENCE_CASE_CLASS('#', '#'),  /* 2-0 @-) */    \
+  [KC_MINS ... KC_SCLN] = SENTENCE_CASE_CLASS('#', '#'),  /* - = [ ] ; */  \
+  [KC_GRV]              = SENTENCE_CASE_CLASS('#', '#'),  /* ` ~ */        \
+  [KC_COMM]             = SENTENCE_CASE_CLASS('#', '#'),  /* , < */        \
+  [KC_SPC]              = SENTENCE_CASE_CLASS(' ', ' '),                   \
+  [KC_QUOT]             = SENTENCE_CASE_CLASS('\'', '\''), /* ' " */
+// clang-format on
+
+#ifndef SENTENCE_CASE_KEY_CLASSES
+#define SENTENCE_CASE_KEY_CLASSES SENTENCE_CASE_DEFAULT_KEY_CLASSES
+#endif  // SENTENCE_CASE_KEY_CLASSES
+
 // The size of the keycode buffer for `sentence_case_check_ending()`. It must be
 // at least as large as the longest pattern checked. If less than 2, buffering
 // is disabled and the callback is not called.
@@ -71,7 +114,8 @@ bool process_sentence_case(uint16_t keycode, keyrecord_t* record);
  *
  * If using `SENTENCE_CASE_TIMEOUT`, call this function from your
  * `housekeeping_task_user()` function in keymap.c. (If no timeout is set,
- * calling `sentence_case_task()` has no effect.)
+ * calling `sentence_case_task()` has no effect.) If features/scheduler.h is
+ * used, `scheduler_task()` takes the place of this call.
  */
 #if SENTENCE_CASE_TIMEOUT > 0
 void sentence_case_task(void);
@@ -116,6 +160,10 @@ void sentence_case_primed(bool primed);
  *       return true;  // Real sentence ending; capitalize next letter.
  *     }
  *
+ * `SENTENCE_CASE_JUST_TYPED()` compares one pattern at a time. To check many
+ * abbreviations, features/just_typed.h can check them all in one pass over the
+ * buffer with `just_typed_scan()`.
+ *
  * @note This callback is used only if `SENTENCE_CASE_BUFFER_SIZE >= 2`.
  *       Otherwise it has no effect.
  *
@@ -170,49 +218,21 @@ bool sentence_case_just_typed_P(const uint16_t* buffer, const uint16_t* pattern,
  * action that backspace doesn't undo), then the callback should call
  * `sentence_case_clear()` to clear the state and then return '\0'.
  *
- * The default callback is:
+ * The default callback looks up the key in the key class table defined by
+ * `SENTENCE_CASE_KEY_CLASSES` (see below) with `sentence_case_key_class()`.
+ * Most customizations can be done by redefining that table. For keys outside
+ * it, like custom keycodes, define the callback as for instance
  *
  *     char sentence_case_press_user(uint16_t keycode,
  *                                   keyrecord_t* record,
  *                                   uint8_t mods) {
- *       if ((mods & ~(MOD_MASK_SHIFT | MOD_BIT(KC_RALT))) == 0) {
- *         const bool shifted = mods & MOD_MASK_SHIFT;
- *         switch (keycode) {
- *           case KC_A ... KC_Z:
- *             return 'a';  // Letter key.
- *
- *           case KC_DOT:  // . is punctuation, Shift . is a symbol (>)
- *             return !shifted ? '.' : '#';
- *           case KC_1:
- *           case KC_SLSH:
- *             return shifted ? '.' : '#';
- *           case KC_EXLM:
- *           case KC_QUES:
- *             return '.';
- *           case KC_2 ... KC_0:  // 2 3 4 5 6 7 8 9 0
- *           case KC_AT ... KC_RPRN:  // @ # $ % ^ & * ( )
- *           case KC_MINS ... KC_SCLN:  // - = [ ] backslash ;
- *           case KC_UNDS ... KC_COLN:  // _ + { } | :
- *           case KC_GRV:
- *           case KC_COMM:
- *             return '#';  // Symbol key.
- *
- *           case KC_SPC:
- *             return ' ';  // Space key.
- *
- *           case KC_QUOT:
- *             return '\'';  // Quote key.
- *         }
+ *       switch (keycode) {
+ *         case M_THE:  // Macro typing a word.
+ *           return 'a';
  *       }
- *
- *       // Otherwise clear Sentence Case to initial state.
- *       sentence_case_clear();
- *       return '\0';
+ *       return sentence_case_key_class(keycode, mods);
  *     }
  *
- * To customize, copy the above function into your keymap and add/remove
- * keycodes to the above cases.
- *
  * @param keycode Current keycode.
  * @param record record_t for the current press event.
  * @param mods equal to `get_mods() | get_weak_mods() | get_oneshot_mods()`
@@ -222,6 +242,14 @@ bool sentence_case_just_typed_P(const uint16_t* buffer, const uint16_t* pattern,
 char sentence_case_press_user(uint16_t keycode, keyrecord_t* record,
                               uint8_t mods);
 
+/**
+ * Looks up the class of `keycode` in the `SENTENCE_CASE_KEY_CLASSES` table, as
+ * a char code for `sentence_case_press_user()`. If the key isn't in the table
+ * or is pressed with mods other than Shift or AltGr, Sentence Case is cleared
+ * and '\0' is returned.
+ */
+char sentence_case_key_class(uint16_t keycode, uint8_t mods);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,179 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file song_stream.c
+ * @brief Song Stream implementation
+ */
+
+#include "song_stream.h"
+
+#if !defined(AUDIO_ENABLE)
+#error "song_stream: Please set `AUDIO_ENABLE = yes` in rules.mk."
+#elif !defined(DEFERRED_EXEC_ENABLE)
+#error "song_stream: Please set `DEFERRED_EXEC_ENABLE = yes` in rules.mk."
+#else
+
+#define NO_REPEAT 0xffff
+
+// Frequencies of the notes of octave 8. Lower octaves are found by halving.
+static const float octave8_hz[12] PROGMEM = {
+    NOTE_C8,  NOTE_CS8, NOTE_D8,  NOTE_DS8, NOTE_E8,  NOTE_F8,
+    NOTE_FS8, NOTE_G8,  NOTE_GS8, NOTE_A8,  NOTE_AS8, NOTE_B8,
+};
+
+static struct {
+  // Song in PROGMEM and its size in bytes.
+  const uint8_t* song;
+  uint16_t size;
+  // Position of the next event.
+  uint16_t pos;
+  // Position of the repeat event being played, or NO_REPEAT.
+  uint16_t repeat_pos;
+  // Number of times the repeated passage is still to be played.
+  uint8_t repeats_left;
+  // Frequency of the tone now sounding, or 0 if none.
+  float tone_hz;
+  // Time when the current note ends. Notes are timed against this absolute
+  // deadline, so that main loop latency delays a note but not the rest of the
+  // song.
+  uint32_t deadline;
+} player;
+
+static deferred_token token = INVALID_DEFERRED_TOKEN;
+
+static float pitch_to_hz(uint8_t pitch) {
+  float hz = pgm_read_float(octave8_hz + pitch % 12);
+  for (uint8_t octave = pitch / 12; octave < 8; ++octave) {
+    hz *= 0.5f;
+  }
+  return hz;
+}
+
+static void stop_tone(void) {
+  if (player.tone_hz > 0.0f) {
+    audio_stop_tone(player.tone_hz);
+    player.tone_hz = 0.0f;
+  }
+}
+
+/**
+ * Reads the next note or rest, following repeats and adding up ties. Returns
+ * false at the end of the song.
+ */
+static bool read_note(uint8_t* pitch, uint16_t* duration) {
+  while (player.pos + 1 < player.size) {
+    const uint8_t op = pgm_read_byte(player.song + player.pos);
+    const uint8_t arg = pgm_read_byte(player.song + player.pos + 1);
+
+    if (op >= SONG_PITCH_REPEAT) {
+      if (player.repeat_pos != player.pos) {  // Start of a repeat.
+        player.repeat_pos = player.pos;
+        player.repeats_left = op - SONG_PITCH_REPEAT;
+      }
+      if (player.repeats_left > 0) {
+        --player.repeats_left;
+        player.pos -= 2 * arg;  // Jump back to the start of the passage.
+      } else {
+        player.repeat_pos = NO_REPEAT;
+        player.pos += 2;
+      }
+      continue;
+    }
+
+    player.pos += 2;
+    if (op == SONG_PITCH_TIE) {
+      continue;  // A tie without a note before it; ignore.
+    }
+    *pitch = op;
+    *duration = arg;
+    while (player.pos + 1 < player.size &&
+           pgm_read_byte(player.song + player.pos) == SONG_PITCH_TIE) {
+      *duration += pgm_read_byte(player.song + player.pos + 1);
+      player.pos += 2;
+    }
+    return true;
+  }
+  return false;
+}
+
+// Returns the delay until `time`, or 1 to run as soon as possible if it is
+// past already.
+static uint32_t delay_until(uint32_t time) {
+  const uint32_t now = timer_read32();
+  return timer_expired32(now, time) ? 1 : time - now;
+}
+
+// Callback used with deferred execution. Each note takes two calls: the first
+// starts the note and returns the time until SONG_STREAM_NOTE_GAP_MS before it
+// ends, and the second stops its tone and returns the time until it ends, or
+// if that time has come, goes on to start the next note. Without the gap,
+// repeated notes of the same pitch would merge into one.
+static uint32_t song_stream_callback(uint32_t trigger_time, void* cb_arg) {
+  if (player.tone_hz > 0.0f) {
+    stop_tone();
+    const uint32_t now = timer_read32();
+    if (!timer_expired32(now, player.deadline)) {
+      return player.deadline - now;
+    }
+  }
+
+  uint8_t pitch;
+  uint16_t duration;
+  if (!read_note(&pitch, &duration)) {
+    token = INVALID_DEFERRED_TOKEN;
+    return 0;  // End of the song.
+  }
+
+  const uint16_t duration_ms = audio_duration_to_ms(duration);
+  player.deadline += duration_ms;
+  if (pitch >= SONG_PITCH_REST) {
+    return delay_until(player.deadline);
+  }
+
+  player.tone_hz = pitch_to_hz(pitch);
+  audio_play_tone(player.tone_hz);
+  // Notes too short for a gap are played without one.
+  return delay_until(duration_ms > 2 * SONG_STREAM_NOTE_GAP_MS
+                         ? player.deadline - SONG_STREAM_NOTE_GAP_MS
+                         : player.deadline);
+}
+
+void song_stream_play(const uint8_t* song, uint16_t size) {
+  song_stream_stop();
+  player.song = song;
+  player.size = size;
+  player.pos = 0;
+  player.repeat_pos = NO_REPEAT;
+  player.deadline = timer_read32();
+
+  const uint32_t delay_ms = song_stream_callback(0, NULL);
+  if (delay_ms) {
+    token = defer_exec(delay_ms, song_stream_callback, NULL);
+  }
+}
+
+void song_stream_stop(void) {
+  if (token != INVALID_DEFERRED_TOKEN) {
+    cancel_deferred_exec(token);
+    token = INVALID_DEFERRED_TOKEN;
+  }
+  stop_tone();
+}
+
+bool song_stream_is_playing(void) {
+  return token != INVALID_DEFERRED_TOKEN;
+}
+
+#endif
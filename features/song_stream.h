@@ -0,0 +1,111 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file song_stream.h
+ * @brief Song Stream: plays compactly-encoded songs directly from PROGMEM.
+ *
+ * Overview
+ * --------
+ *
+ * QMK songs made with `SONG(...)` are `float [][2]` arrays, 8 bytes per note,
+ * and `PLAY_SONG()` needs them in RAM. Song Stream instead plays a compact
+ * byte encoding, 2 bytes per note, with repeated passages stored once. The
+ * song is read from PROGMEM one note at a time as it plays, so it takes no RAM
+ * beyond the player's few bytes of state.
+ *
+ * The encoding is a sequence of 2-byte events:
+ *
+ *  * `SONG_NOTE(pitch, duration)`: plays note index `pitch`, counting
+ *    semitones up from C0 (so 12 * octave + semitone), for `duration` in
+ *    1/64ths of a beat, as in `M__NOTE()`.
+ *
+ *  * `SONG_REST(duration)`: silence for `duration`.
+ *
+ *  * `SONG_TIE(duration)`: lengthens the previous note or rest, for durations
+ *    longer than 255.
+ *
+ *  * `SONG_REPEAT(events, times)`: plays the previous `events` events
+ *    `times` more times. Repeats don't nest, and a repeated passage must start
+ *    at a note or rest.
+ *
+ * Note durations are converted to ms with `audio_duration_to_ms()`, just as
+ * QMK does for `float` songs, so a song plays with the same timing as the
+ * `SONG(...)` it was converted from. Each note's tone stops
+ * `SONG_STREAM_NOTE_GAP_MS` before the note ends, so that repeated notes of
+ * the same pitch are heard as separate notes, like the gap of
+ * `SongPlayer.NOTE_GAP_S` in tools/qmk_song_player.
+ *
+ * To convert a song, use the converter in tools/qmk_song_player
+ * (`Song.compactCode()`), which finds repeats automatically. Then play it like
+ *
+ *     #include "features/song_stream.h"
+ *
+ *     static const uint8_t my_song[] PROGMEM = {
+ *       SONG_NOTE(52, 16), SONG_NOTE(55, 16), SONG_REPEAT(2, 3),
+ *       SONG_REST(8), SONG_NOTE(60, 64),
+ *     };
+ *
+ *     song_stream_play(my_song, sizeof(my_song));
+ *
+ * In rules.mk, set `AUDIO_ENABLE = yes` and `DEFERRED_EXEC_ENABLE = yes`, and
+ * add `SRC += features/song_stream.c`.
+ */
+
+#pragma once
+
+#include "quantum.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Silence in ms at the end of each note, before the next note starts.
+#ifndef SONG_STREAM_NOTE_GAP_MS
+#define SONG_STREAM_NOTE_GAP_MS 2
+#endif  // SONG_STREAM_NOTE_GAP_MS
+
+/** Pitch byte of a rest. */
+#define SONG_PITCH_REST 108
+/** Pitch byte of a tie, continuing the previous note. */
+#define SONG_PITCH_TIE 109
+/** Pitch bytes from this value up are repeats, `SONG_PITCH_REPEAT + times`. */
+#define SONG_PITCH_REPEAT 128
+
+/** Note of index `pitch` in 0-107 for `duration` in 1/64ths of a beat. */
+#define SONG_NOTE(pitch, duration) (pitch), (duration)
+/** Rest for `duration` in 1/64ths of a beat. */
+#define SONG_REST(duration) SONG_PITCH_REST, (duration)
+/** Lengthens the previous note or rest by `duration`. */
+#define SONG_TIE(duration) SONG_PITCH_TIE, (duration)
+/** Plays the previous `events` events `times` more times, up to 127. */
+#define SONG_REPEAT(events, times) (SONG_PITCH_REPEAT + (times)), (events)
+
+/**
+ * Starts playing a song, stopping any song already playing.
+ *
+ * @param song  Song in PROGMEM, in the encoding described above.
+ * @param size  Size of the song in bytes.
+ */
+void song_stream_play(const uint8_t* song, uint16_t size);
+
+/** Stops the song playing, if any. */
+void song_stream_stop(void);
+
+/** Returns true while a song is playing. */
+bool song_stream_is_playing(void);
+
+#ifdef __cplusplus
+}
+#endif
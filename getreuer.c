@@ -23,14 +23,19 @@
  *  * features/achordion.h: customize the tap-hold decision
  *  * features/autocorrection.h: run rudimentary autocorrection on your keyboard
  *  * features/caps_word.h: modern alternative to Caps Lock
+ *  * features/caps_word_class.h: key class tables for Caps Word
  *  * features/custom_shift_keys.h: they're surprisingly tricky to get right;
  *                                  here is my approach
+ *  * features/event_queue.h: non-recursive injection of synthetic key events
+ *  * features/just_typed.h: match many "just typed" patterns in one step
  *  * features/keycode_string.h: format keycodes as human-readable strings
  *  * features/layer_lock.h: macro to stay in the current layer
+ *  * features/mouse_report.h: one sender for all mouse buttons and motion
  *  * features/mouse_turbo_click.h: macro that clicks the mouse rapidly
  *  * features/orbital_mouse.h: a polar approach to mouse key control
  *  * features/palettefx.h: palette-based animated RGB matrix lighting effects
  *  * features/repeat_key.h: a "repeat last key" implementation
+ *  * features/scheduler.h: run feature tasks only when their deadlines are due
  *  * features/sentence_case.h: capitalize first letter of sentences
  *  * features/select_word.h: macro for convenient word or line selection
  *  * features/socd_cleaner.h: enhance WASD for fast inputs for gaming
@@ -52,21 +57,43 @@
 #ifdef ACHORDION_ENABLE
 #include "features/achordion.h"
 #endif  // ACHORDION_ENABLE
+#ifdef CAPS_WORD_ENABLE
+#include "features/caps_word_class.h"
+#endif  // CAPS_WORD_ENABLE
 #ifdef CUSTOM_SHIFT_KEYS_ENABLE
 #include "features/custom_shift_keys.h"
 #endif  // CUSTOM_SHIFT_KEYS_ENABLE
+#ifdef EVENT_QUEUE_ENABLE
+#include "features/event_queue.h"
+#endif  // EVENT_QUEUE_ENABLE
+#ifdef JUST_TYPED_ENABLE
+#include "features/just_typed.h"
+#include "features/just_typed_data.h"
+#endif  // JUST_TYPED_ENABLE
 #ifdef KEYCODE_STRING_ENABLE
 #include "features/keycode_string.h"
 #endif  // KEYCODE_STRING_ENABLE
+#ifdef MAGIC_KEY_ENABLE
+#include "features/magic_key.h"
+#endif
+#ifdef MOUSE_REPORT_ENABLE
+#include "features/mouse_report.h"
+#endif  // MOUSE_REPORT_ENABLE
 #ifdef ORBITAL_MOUSE_ENABLE
 #include "features/orbital_mouse.h"
 #endif  // ORBITAL_MOUSE_ENABLE
 #ifdef RGB_MATRIX_CUSTOM_USER
 #include "features/palettefx.h"
 #endif  // RGB_MATRIX_CUSTOM_USER
+#ifdef SCHEDULER_ENABLE
+#include "features/scheduler.h"
+#endif  // SCHEDULER_ENABLE
 #ifdef SENTENCE_CASE_ENABLE
 #include "features/sentence_case.h"
 #endif  // SENTENCE_CASE_ENABLE
+#ifdef SONG_STREAM_ENABLE
+#include "features/song_stream.h"
+#endif  // SONG_STREAM_ENABLE
 #if __has_include("user_song_list.h")
 #include "user_song_list.h"
 #endif
@@ -99,16 +126,25 @@ enum custom_keycodes {
   M_DOCSTR,
   M_EQEQ,
   M_INCLUDE,
+  M_MKGRVS,
+  M_UPDIR,
+  M_NOOP,
+  // Magic key macros that type letters. Caps Word continues through those
+  // declared from M_ION to M_TMENT (see caps_word_classes).
   M_ION,
   M_MENT,
-  M_MKGRVS,
   M_QUEN,
   M_THE,
   M_TMENT,
-  M_UPDIR,
-  M_NOOP,
 };
 
+#ifdef MAGIC_KEY_ENABLE
+// The generated rule table refers to the custom keycodes above.
+#include "features/magic_key_data.h"
+_Static_assert(MAGIC_KEY_DATA_MAX_CONTEXT <= MAGIC_KEY_CONTEXT_SIZE,
+               "MAGIC_KEY_CONTEXT_SIZE is too small for magic_key_dict.txt");
+#endif  // MAGIC_KEY_ENABLE
+
 // This keymap uses Ikcelaks' Magic Sturdy layout for the base layer (see
 // https://github.com/Ikcelaks/keyboard_layouts). I've also made some twists of
 // my own. The "magic" is a key whose function depends on the last pressed key,
@@ -117,7 +153,9 @@ enum custom_keycodes {
 //
 // The following describes the magic key functionality, where * represents the
 // magic key and @ the repeat key. For example, tapping A and then the magic key
-// types "ao". Most of this is coded in my `get_alt_repeat_key_keycode_user()`
+// types "ao". The rules are listed in features/magic_key_dict.txt, from which
+// make_magic_key_data.py generates features/magic_key_data.h, and are looked
+// up from the last typed keys in my `get_alt_repeat_key_keycode_user()`
 // definition below.
 //
 // SFB removal and common n-grams:
@@ -129,21 +167,21 @@ enum custom_keycodes {
 //     G * -> GY     Q * -> QUEN    spc * -> THE
 //     I * -> ION    R * -> RL
 //
-// When the magic key types a letter, following it with the repeat key produces
-// "n". This is useful to type certain patterns without SFBs.
+// When the magic key types a vowel, tapping it again produces "n". This is
+// useful to type certain patterns without SFBs.
 //
-//     A * @ -> AON             (like "kaon")
-//     D * @ -> DYN             (like "dynamic")
-//     E * @ -> EUN             (like "reunite")
-//     O * @ -> OAN             (like "loan")
+//     A * * -> AON             (like "kaon")
+//     D * * -> DYN             (like "dynamic")
+//     E * * -> EUN             (like "reunite")
+//     O * * -> OAN             (like "loan")
 //
 // Other patterns:
 //
-//     spc * @ -> THEN
-//     I * @ -> IONS            (like "nations")
-//     M * @ -> MENTS           (like "moments")
-//     Q * @ -> QUENC           (like "frequency")
-//     T * @ -> TMENTS          (like "adjustments")
+//     spc * * -> THEN
+//     I * * -> IONS            (like "nations")
+//     M * * -> MENTS           (like "moments")
+//     Q * * -> QUENC           (like "frequency")
+//     T * * -> TMENTS          (like "adjustments")
 //     = *   -> ===             (JS code)
 //     ! *   -> !==             (JS code)
 //     " *   -> """<cursor>"""  (Python code)
@@ -225,23 +263,51 @@ enum custom_keycodes {
 ///////////////////////////////////////////////////////////////////////////////
 
 // Custom OS behavior
+#ifdef OS_DETECTION_ENABLE
 /* #include "os_detection.h" */
 #include "eeconfig.h"        // already in your file, but just to be explicit
 #include "keycode_config.h"  // provides the global keymap_config union
 
-static void set_ctrl_cmd_swap(bool mac_layout) {
-    /* 1. load current EEPROM copy into the global struct */
-    eeconfig_read_keymap(&keymap_config);
+// The last detected host OS is cached in the user EEPROM block. It is applied
+// in keyboard_post_init_user(), so that shortcuts have the right Ctrl/Cmd
+// layout from the first keystroke instead of after OS detection settles.
+// Detection then only confirms or corrects it.
+typedef union {
+  uint32_t raw;
+  struct {
+    uint8_t host_os;  // os_variant_t, where OS_UNSURE means nothing cached.
+  };
+} user_config_t;
 
-    /* 2. change the flags in RAM */
+static user_config_t user_config;
+
+static void set_ctrl_cmd_swap(bool mac_layout) {
+    // RAM only: the cached OS, not keymap_config in EEPROM, decides the
+    // layout at boot.
     keymap_config.swap_lctl_lgui = mac_layout;   // left Cmd ↔︎ Ctrl
     keymap_config.swap_rctl_rgui = mac_layout;   // right Cmd ↔︎ Ctrl
+}
 
-    /* 3. write back if you want it to persist */
-    eeconfig_update_keymap(&keymap_config);
+static bool is_apple_os(os_variant_t os) {
+  return os == OS_MACOS || os == OS_IOS;
+}
+
+// Applies the cached host OS layout. Called from keyboard_post_init_user().
+static void host_os_cache_init(void) {
+  user_config.raw = eeconfig_read_user();
+  if (user_config.host_os != OS_UNSURE) {
+    set_ctrl_cmd_swap(is_apple_os(user_config.host_os));
+  }
 }
 
 bool process_detected_host_os_user(os_variant_t detected_os) {
+  // Update the cache only when a definite result differs, sparing EEPROM
+  // writes on every plug-in to the same host.
+  if (detected_os != OS_UNSURE && detected_os != user_config.host_os) {
+    user_config.host_os = detected_os;
+    eeconfig_update_user(user_config.raw);
+  }
+
   switch (detected_os) {
       case OS_MACOS:
           rgb_matrix_set_color_all(RGB_WHITE);
@@ -267,13 +333,15 @@ bool process_detected_host_os_user(os_variant_t detected_os) {
           break;
       case OS_UNSURE:
           /* key_override_off(); */
-          set_ctrl_cmd_swap(false);          // ⌘ under your thumb, ^ on the edge
+          // Keep the cached layout, if any, rather than guess.
+          set_ctrl_cmd_swap(is_apple_os(user_config.host_os));
           rgb_matrix_set_color_all(RGB_RED);
           break;
   }
 
   return true;  // Always return true to indicate that the OS was detected.
 }
+#endif  // OS_DETECTION_ENABLE
 
 ///////////////////////////////////////////////////////////////////////////////
 // Overrides (https://docs.qmk.fm/features/key_overrides)
@@ -450,7 +518,9 @@ uint16_t achordion_streak_chord_timeout(
     break;
   }
 
-  // Otherwise, tap_hold_keycode is a mod-tap key.
+  // Otherwise, tap_hold_keycode is a mod-tap key. With
+  // ACHORDION_STREAK_ADAPTIVE, the timeouts below are used until there is an
+  // estimate from recent typing, which then replaces them.
   const uint8_t mod = mod_config(QK_MOD_TAP_GET_MODS(tap_hold_keycode));
   if ((mod & MOD_LSFT) != 0) {
     return 100;  // A short streak timeout for Shift mod-tap keys.
@@ -458,6 +528,49 @@ uint16_t achordion_streak_chord_timeout(
     return 220;  // A longer timeout otherwise.
   }
 }
+
+#ifdef ACHORDION_STATS
+#ifdef RAW_ENABLE
+// Raw HID command to read Achordion stats. The host sends {0xAC, index} and
+// gets back {0xAC, index, valid, row, col, counts...} with the counts as
+// little-endian uint16s. See tools/achordion_heatmap.py.
+#define RAW_HID_ACHORDION_STATS 0xAC
+
+// Fills in the reply to RAW_HID_ACHORDION_STATS. Returns false if the report
+// is too short.
+static bool achordion_stats_raw_hid(uint8_t* data, uint8_t length) {
+  if (length < 5 + 2 * ACHORDION_NUM_STATS) {
+    return false;
+  }
+
+  keypos_t key;
+  uint16_t counts[ACHORDION_NUM_STATS];
+  const bool valid = achordion_stats_get(data[1], &key, counts);
+  memset(data + 2, 0, length - 2);
+  if (valid) {
+    data[2] = 1;
+    data[3] = key.row;
+    data[4] = key.col;
+    for (uint8_t i = 0; i < ACHORDION_NUM_STATS; ++i) {
+      data[5 + 2 * i] = counts[i] & 0xff;
+      data[6 + 2 * i] = counts[i] >> 8;
+    }
+  }
+  return true;
+}
+#endif  // RAW_ENABLE
+
+// While debugging, dump the stats to the console once a minute.
+static void achordion_stats_task(void) {
+  static uint32_t timer = 0;
+  if (debug_enable && timer_elapsed32(timer) >= 60000) {
+    timer = timer_read32();
+    achordion_stats_print();
+  }
+}
+#else
+#define achordion_stats_task()
+#endif  // ACHORDION_STATS
 #endif  // ACHORDION_ENABLE
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -478,28 +591,17 @@ bool apply_autocorrect(uint8_t backspaces, const char* str,
 // Caps word (https://docs.qmk.fm/features/caps_word)
 ///////////////////////////////////////////////////////////////////////////////
 #ifdef CAPS_WORD_ENABLE
-bool caps_word_press_user(uint16_t keycode) {
-  switch (keycode) {
-    // Keycodes that continue Caps Word, with shift applied.
-    case KC_A ... KC_Z:
-      add_weak_mods(MOD_BIT(KC_LSFT));  // Apply shift to the next key.
-      return true;
-
-    // Keycodes that continue Caps Word, without shifting.
-    case KC_1 ... KC_0:
-    case KC_BSPC:
-    case KC_DEL:
-    case KC_UNDS:
-    case M_THE:
-    case M_ION:
-    case M_MENT:
-    case M_QUEN:
-    case M_TMENT:
-      return true;
+// clang-format off
+static const uint8_t caps_word_classes[] PROGMEM = {
+  CAPS_WORD_KEY_CLASSES,
+  [CAPS_WORD_USER(M_ION) ... CAPS_WORD_USER(M_TMENT)] =
+      CAPS_WORD_CLASS(CAPS_WORD_CONTINUE, CAPS_WORD_STOP),
+};
+// clang-format on
 
-    default:
-      return false;  // Deactivate Caps Word.
-  }
+bool caps_word_press_user(uint16_t keycode) {
+  return caps_word_apply_class(caps_word_class_lookup(
+      caps_word_classes, sizeof(caps_word_classes), keycode));
 }
 #endif  // CAPS_WORD_ENABLE
 
@@ -507,43 +609,32 @@ bool caps_word_press_user(uint16_t keycode) {
 // Sentence case (https://getreuer.info/posts/keyboards/sentence-case)
 ///////////////////////////////////////////////////////////////////////////////
 #ifdef SENTENCE_CASE_ENABLE
+// Key classes of basic keycodes are defined by SENTENCE_CASE_KEY_CLASSES in
+// config_getreuer.h. Here, only macros are handled.
 char sentence_case_press_user(uint16_t keycode, keyrecord_t* record,
                               uint8_t mods) {
-  if ((mods & ~(MOD_MASK_SHIFT | MOD_BIT(KC_RALT))) == 0) {
-    const bool shifted = mods & MOD_MASK_SHIFT;
-    switch (keycode) {
-      case KC_A ... KC_Z:
-      case M_THE:
+  switch (keycode) {
+    case M_THE:
+      if ((mods & ~(MOD_MASK_SHIFT | MOD_BIT(KC_RALT))) == 0) {
         return 'a';  // Letter key.
-
-      case KC_DOT:  // Both . and Shift . (?) punctuate sentence endings.
-      case KC_EXLM:
-      case KC_QUES:
-        return '.';
-
-      case KC_COMM:
-        return shifted ? '.' : '#';
-
-      case KC_2 ... KC_0:  // 2 3 4 5 6 7 8 9 0
-      case KC_AT ... KC_RPRN:  // @ # $ % ^ & * ( )
-      case KC_MINS ... KC_SCLN:  // - = [ ] backslash ;
-      case KC_UNDS ... KC_COLN:  // _ + { } | :
-      case KC_GRV:
-        return '#';  // Symbol key.
-
-      case KC_SPC:
-        return ' ';  // Space key.
-
-      case KC_QUOT:
-      case KC_DQUO:
-        return '\'';  // Quote key.
-    }
+      }
+      break;
   }
+  return sentence_case_key_class(keycode, mods);
+}
+
+#ifdef JUST_TYPED_ENABLE
+_Static_assert(JUST_TYPED_DATA_MAX_PATTERN <= SENTENCE_CASE_BUFFER_SIZE,
+               "SENTENCE_CASE_BUFFER_SIZE is too small for just_typed_dict");
 
-  // Otherwise clear Sentence Case to initial state.
-  sentence_case_clear();
-  return '\0';
+// Abbreviations like "vs." and "Dr." don't end the sentence. They are listed in
+// features/just_typed_dict.txt and all checked in one pass over the buffer.
+bool sentence_case_check_ending(const uint16_t* buffer) {
+  return !(just_typed_scan(just_typed_data, buffer,
+                           SENTENCE_CASE_BUFFER_SIZE) &
+           JUST_TYPED_ABBREV);
 }
+#endif  // JUST_TYPED_ENABLE
 #endif  // SENTENCE_CASE_ENABLE
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -587,91 +678,24 @@ uint16_t get_alt_repeat_key_keycode_user(uint16_t keycode, uint8_t mods) {
       case KC_C: return C(KC_V);    // Ctrl+C -> Ctrl+V
     }
   } else if ((mods & ~MOD_MASK_SHIFT) == 0) {
-    // This is where most of the "magic" for the MAGIC key is implemented.
-    switch (keycode) {
-      case KC_SPC:  // spc -> THE
-      case KC_ENT:
-      case KC_TAB:
-        return M_THE;
-
-      // For navigating next/previous search results in Vim:
-      // N -> Shift + N, Shift + N -> N.
-      case MOD_ALT1:
-        if ((mods & MOD_MASK_SHIFT) == 0) {
-          return S(KC_N);
-        }
-        // Fall through intended.
-      case KC_N: return KC_N;
-
-      // Fix SFBs and awkward strokes.
-      case LAY_WIN1: return KC_O;       // A -> O
-      case KC_O: return KC_A;         // O -> A
-      case LAY_NAV: return KC_U;       // E -> U
-      case KC_U: return KC_E;         // U -> E
-      case MOD_SFT2:
-        if ((mods & MOD_MASK_SHIFT) == 0) {
-          return M_ION;  // I -> ON
-        } else {
-          return KC_QUOT;  // Shift I -> '
-        }
-      case KC_M: return M_MENT;       // M -> ENT
-      case KC_Q: return M_QUEN;       // Q -> UEN
-      case MOD_CTL1: return M_TMENT;    // T -> TMENT
-
-      case KC_C: return KC_Y;         // C -> Y
-      /* case LAY_ARR1: return KC_Y;       // D -> Y */
-      case LAY_NUM: return KC_Y;        // G -> Y
-      case KC_P: return KC_Y;         // P -> Y
-      case KC_Y: return KC_P;         // Y -> P
-
-      case KC_L: return KC_K;         // L -> K
-      case MOD_ALT2: return KC_K;       // S -> K
-
-      case HOME_B: return KC_L;       // R -> L
-      case KC_DOT:
-        if ((mods & MOD_MASK_SHIFT) == 0) {
-          return M_UPDIR;  // . -> ./
-        }
-        return M_NOOP;
-      case KC_HASH: return M_INCLUDE; // # -> include
-      case KC_EQL: return M_EQEQ;     // = -> ==
+    // Custom shift keys type other symbols than the context records for them.
+    if ((mods & MOD_MASK_SHIFT) != 0) {
+      switch (keycode) {
+        case KC_COMM: return KC_EQL;  // ~ -> =
+        case KC_DOT: return M_NOOP;
+      }
+    }
 
-      case KC_COMM:
-        if ((mods & MOD_MASK_SHIFT) != 0) {
-          return KC_EQL;  // ! -> =
-        }
-        return M_NOOP;
-      case KC_QUOT:
-        if ((mods & MOD_MASK_SHIFT) != 0) {
-          return M_DOCSTR;  // " -> ""<cursor>"""
-        }
-        return M_NOOP;
-      case KC_GRV:  // ` -> ``<cursor>``` (for Markdown code)
-        return M_MKGRVS;
-      case KC_LABK:  // < -> - (for Haskell)
-        return KC_MINS;
-
-      case KC_SLSH:
-        return KC_SLSH;  // / -> / (easier reach than Repeat)
-
-      case KC_F:
-      case KC_V:
-      /* case HOME_B: */
-      case MOD_SFT1:
-        return M_NOOP;
-
-      case KC_PLUS:
-      case KC_MINS:
-      case KC_ASTR:
-      case KC_PERC:
-      case KC_PIPE:
-      case KC_AMPR:
-      case KC_CIRC:
-      case KC_TILD:
-      case KC_EXLM:
-      case KC_RABK:
-        return KC_EQL;
+#ifdef MAGIC_KEY_ENABLE
+    // This is where the "magic" for the MAGIC key is implemented: the rules
+    // of magic_key_dict.txt, looked up from the last typed keys.
+    const uint16_t magic_keycode = magic_key_lookup(magic_key_data);
+    if (magic_keycode != KC_NO) {
+      return magic_keycode;
+    }
+#endif  // MAGIC_KEY_ENABLE
 
+    switch (keycode) {
       case C(KC_A): return C(KC_C);  // Ctrl+A -> Ctrl+C
     }
   }
@@ -694,6 +718,9 @@ static void magic_send_string_P(const char* str, uint16_t repeat_keycode) {
 
   send_string_P(str);  // Send the string.
   set_last_keycode(repeat_keycode);
+#ifdef MAGIC_KEY_ENABLE
+  magic_key_context_add_string_P(str);
+#endif  // MAGIC_KEY_ENABLE
 
   // If Caps Word is on, restore the mods.
   if (is_caps_word_on()) {
@@ -701,31 +728,158 @@ static void magic_send_string_P(const char* str, uint16_t repeat_keycode) {
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Scheduler (features/scheduler.h)
+///////////////////////////////////////////////////////////////////////////////
+#if defined(SCHEDULER_ENABLE) && defined(SCHEDULER_STATS)
+// While debugging, print the worst task lateness once a minute.
+static void scheduler_stats_task(void) {
+  static uint32_t timer = 0;
+  if (debug_enable && timer_elapsed32(timer) >= 60000) {
+    timer = timer_read32();
+    dprintf("Scheduler: max lateness %u ms\n", scheduler_get_max_lateness());
+  }
+}
+#else
+#define scheduler_stats_task()
+#endif  // defined(SCHEDULER_ENABLE) && defined(SCHEDULER_STATS)
+
 ///////////////////////////////////////////////////////////////////////////////
 // Debug logging
 ///////////////////////////////////////////////////////////////////////////////
-#if !defined(NO_DEBUG) && defined(KEYCODE_STRING_ENABLE)
+// Key events are logged as compact binary records rather than formatted text,
+// so that logging doesn't perturb tap-hold timing. Records are queued in a ring
+// buffer by dlog_record() and drained later, to the console as "dlog <hex>"
+// lines from housekeeping, or over raw HID when the host polls. Decode them
+// with tools/dlog/dlog_decode, which names keycodes with keycode_string.c.
+//
+// Each record is 8 bytes:
+//
+//   time_lo, time_hi, row, col, layer, flags, keycode_lo, keycode_hi
+//
+// where time is record->event.time and flags is a combination of DLOG_FLAG_*.
+#if !defined(NO_DEBUG) && (defined(CONSOLE_ENABLE) || defined(RAW_ENABLE))
+#define DLOG_ENABLE
 #include "print.h"
-#include "features/keycode_string.h"
+
+#ifndef DLOG_BUFFER_SIZE
+#define DLOG_BUFFER_SIZE 32
+#endif  // DLOG_BUFFER_SIZE
+#define DLOG_RECORD_SIZE 8
+
+#define DLOG_FLAG_PRESSED 0x01
+#define DLOG_FLAG_TAP_HOLD 0x02  // Keycode is a mod-tap or layer-tap key.
+#define DLOG_FLAG_TAP 0x04  // Tap-hold key settled as tapped.
+#define DLOG_FLAG_COMBO 0x08  // Combo event, row and col are meaningless.
+
+static uint8_t dlog_buffer[DLOG_BUFFER_SIZE][DLOG_RECORD_SIZE];
+static uint8_t dlog_head = 0;
+static uint8_t dlog_len = 0;
+// Number of records dropped because the buffer was full, saturating at 255.
+static uint8_t dlog_dropped = 0;
 
 static void dlog_record(uint16_t keycode, keyrecord_t* record) {
   if (!debug_enable) { return; }
-  uint8_t layer = read_source_layers_cache(record->event.key);
-  bool is_tap_hold = IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode);
-  xprintf("L%-2u ", layer);  // Log the layer.
-  if (IS_COMBOEVENT(record->event)) {  // Combos don't have a position.
-    xprintf("combo   ");
-  } else {  // Log the "(row,col)" position.
-    xprintf("(%2u,%2u) ", record->event.key.row, record->event.key.col);
-  }
-  xprintf("%-4s %-7s %s\n",  // "(tap|hold) (press|release) <keycode>".
-      is_tap_hold ? (record->tap.count ? "tap" : "hold") : "",
-      record->event.pressed ? "press" : "release",
-      keycode_string(keycode));
+  if (dlog_len >= DLOG_BUFFER_SIZE) {
+    if (dlog_dropped < UINT8_MAX) { ++dlog_dropped; }
+    return;
+  }
+
+  uint8_t flags = record->event.pressed ? DLOG_FLAG_PRESSED : 0;
+  if (IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode)) {
+    flags |= DLOG_FLAG_TAP_HOLD;
+    if (record->tap.count) { flags |= DLOG_FLAG_TAP; }
+  }
+  if (IS_COMBOEVENT(record->event)) { flags |= DLOG_FLAG_COMBO; }
+
+  uint8_t* r = dlog_buffer[(dlog_head + dlog_len) % DLOG_BUFFER_SIZE];
+  r[0] = record->event.time & 0xff;
+  r[1] = record->event.time >> 8;
+  r[2] = record->event.key.row;
+  r[3] = record->event.key.col;
+  r[4] = read_source_layers_cache(record->event.key);
+  r[5] = flags;
+  r[6] = keycode & 0xff;
+  r[7] = keycode >> 8;
+  ++dlog_len;
 }
+
+// Removes the oldest record and returns it, or returns NULL if empty.
+static const uint8_t* dlog_pop(void) {
+  if (!dlog_len) { return NULL; }
+  const uint8_t* r = dlog_buffer[dlog_head];
+  dlog_head = (dlog_head + 1) % DLOG_BUFFER_SIZE;
+  --dlog_len;
+  return r;
+}
+
+#ifdef CONSOLE_ENABLE
+// Prints one record per call, so that draining is spread over several scans.
+static void dlog_task(void) {
+  if (dlog_dropped) {
+    xprintf("dlog_dropped %u\n", dlog_dropped);
+    dlog_dropped = 0;
+  }
+  const uint8_t* r = dlog_pop();
+  if (r) {
+    xprintf("dlog %02X%02X%02X%02X%02X%02X%02X%02X\n",
+        r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7]);
+  }
+}
+#else
+#define dlog_task()
+#endif  // CONSOLE_ENABLE
+
+#ifdef RAW_ENABLE
+// Raw HID command to read the debug log. The host sends {0xD1} and gets back
+// {0xD1, count, dropped, records...} with as many records as fit.
+#define RAW_HID_DLOG 0xD1
+
+// Fills in the reply to RAW_HID_DLOG.
+static bool dlog_raw_hid(uint8_t* data, uint8_t length) {
+  if (length < 3) { return false; }
+  memset(data + 1, 0, length - 1);
+  uint8_t count = 0;
+  const uint8_t* r;
+  while (3 + (count + 1) * DLOG_RECORD_SIZE <= length &&
+         (r = dlog_pop()) != NULL) {
+    memcpy(data + 3 + count * DLOG_RECORD_SIZE, r, DLOG_RECORD_SIZE);
+    ++count;
+  }
+  data[1] = count;
+  data[2] = dlog_dropped;
+  dlog_dropped = 0;
+  return true;
+}
+#endif  // RAW_ENABLE
 #else
 #define dlog_record(keycode, record)
-#endif  // !defined(NO_DEBUG) && defined(KEYCODE_STRING_ENABLE)
+#define dlog_task()
+#endif  // !defined(NO_DEBUG) && (CONSOLE_ENABLE || RAW_ENABLE)
+
+///////////////////////////////////////////////////////////////////////////////
+// Raw HID
+///////////////////////////////////////////////////////////////////////////////
+#ifdef RAW_ENABLE
+#include "raw_hid.h"
+
+void raw_hid_receive(uint8_t* data, uint8_t length) {
+  bool reply = false;
+  switch (data[0]) {
+#if defined(ACHORDION_ENABLE) && defined(ACHORDION_STATS)
+    case RAW_HID_ACHORDION_STATS:
+      reply = achordion_stats_raw_hid(data, length);
+      break;
+#endif  // defined(ACHORDION_ENABLE) && defined(ACHORDION_STATS)
+#ifdef DLOG_ENABLE
+    case RAW_HID_DLOG:
+      reply = dlog_raw_hid(data, length);
+      break;
+#endif  // DLOG_ENABLE
+  }
+  if (reply) { raw_hid_send(data, length); }
+}
+#endif  // RAW_ENABLE
 
 ///////////////////////////////////////////////////////////////////////////////
 // Status LEDs
@@ -757,6 +911,10 @@ void caps_word_set_user(bool active) {
 ///////////////////////////////////////////////////////////////////////////////
 
 void keyboard_post_init_user(void) {
+#ifdef OS_DETECTION_ENABLE
+  host_os_cache_init();
+#endif  // OS_DETECTION_ENABLE
+
 #if RGB_MATRIX_CUSTOM_USER
   uint8_t palette_index = PALETTEFX_AMBER;
   rgb_matrix_sethsv_noeeprom(RGB_MATRIX_HUE_STEP * palette_index, 255, 255);
@@ -766,26 +924,50 @@ void keyboard_post_init_user(void) {
 #endif  // RGB_MATRIX_CUSTOM_USER
 
   // Play MUSHROOM_SOUND two seconds after init, if defined and audio enabled.
-#if defined(AUDIO_ENABLE) && defined(MUSHROOM_SOUND)
+#if defined(AUDIO_ENABLE) && defined(SONG_STREAM_ENABLE)
+  uint32_t play_init_song_callback(uint32_t trigger_time, void* cb_arg) {
+    // MUSHROOM_SOUND, converted with `Song.compactCode()` from
+    // tools/qmk_song_player. Played from flash, it takes no RAM.
+    // 25 notes in 48 bytes (200 bytes as SONG(...)).
+    static const uint8_t init_song[] PROGMEM = {
+        60, 8, 55, 8, 60, 8, 64, 8, 67, 8, 72, 8,
+        67, 8, 56, 8, 60, 8, 63, 8, 68, 8, 129, 2,
+        72, 8, 75, 8, 80, 8, 75, 8, 58, 8, 62, 8,
+        65, 8, 70, 8, 74, 8, 77, 8, 82, 8, 77, 8,
+    };
+    song_stream_play(init_song, sizeof(init_song));
+    return 0;
+  }
+  defer_exec(2000, play_init_song_callback, NULL);
+#elif defined(AUDIO_ENABLE) && defined(MUSHROOM_SOUND)
   uint32_t play_init_song_callback(uint32_t trigger_time, void* cb_arg) {
     static float init_song[][2] = SONG(MUSHROOM_SOUND);
     PLAY_SONG(init_song);
     return 0;
   }
   defer_exec(2000, play_init_song_callback, NULL);
-#endif // defined(AUDIO_ENABLE) && defined(MUSHROOM_SOUND)
+#endif  // AUDIO_ENABLE
 }
 
 bool process_record_user(uint16_t keycode, keyrecord_t* record) {
+#ifdef EVENT_QUEUE_ENABLE
+  if (!process_event_queue(keycode, record)) { return false; }
+#endif  // EVENT_QUEUE_ENABLE
 #ifdef ACHORDION_ENABLE
   if (!process_achordion(keycode, record)) { return false; }
 #endif  // ACHORDION_ENABLE
 #ifdef ORBITAL_MOUSE_ENABLE
   if (!process_orbital_mouse(keycode, record)) { return false; }
 #endif  // ORBITAL_MOUSE_ENABLE
+#ifdef MOUSE_REPORT_ENABLE
+  if (!process_mouse_report(keycode, record)) { return false; }
+#endif  // MOUSE_REPORT_ENABLE
 #ifdef SENTENCE_CASE_ENABLE
   if (!process_sentence_case(keycode, record)) { return false; }
 #endif  // SENTENCE_CASE_ENABLE
+#ifdef MAGIC_KEY_ENABLE
+  process_magic_key(keycode, record);
+#endif  // MAGIC_KEY_ENABLE
 #ifdef CUSTOM_SHIFT_KEYS_ENABLE
   if (!process_custom_shift_keys(keycode, record)) { return false; }
 #endif  // CUSTOM_SHIFT_KEYS_ENABLE
@@ -801,21 +983,6 @@ bool process_record_user(uint16_t keycode, keyrecord_t* record) {
   const uint8_t shift_mods = all_mods & MOD_MASK_SHIFT;
   const bool alt = all_mods & MOD_BIT(KC_LALT);
 
-  // If alt repeating key A, E, I, O, U, Y with no mods other than Shift, set
-  // the last key to KC_N. Above, alternate repeat of KC_N is defined to be
-  // again KC_N. This way, either tapping alt repeat and then repeat (or
-  // equivalently double tapping alt repeat) is useful to type certain patterns
-  // without SFBs:
-  //
-  //   D <altrep> <rep> -> DYN (as in "dynamic")
-  //   O <altrep> <rep> -> OAN (as in "loan")
-  if (get_repeat_key_count() < 0 && !shift_mods &&
-      (keycode == KC_A || keycode == KC_E || keycode == KC_I ||
-       keycode == KC_O || keycode == KC_U || keycode == KC_Y)) {
-    set_last_keycode(KC_N);
-    set_last_mods(0);
-  }
-
   switch (keycode) {
     // Behavior:
     //  * Unmodified:       _ (KC_UNDS)
@@ -975,14 +1142,31 @@ bool process_record_user(uint16_t keycode, keyrecord_t* record) {
 }
 
 void housekeeping_task_user(void) {
+#ifdef SCHEDULER_ENABLE
+  // Achordion, the event queue, Orbital Mouse, mouse reports, and Sentence
+  // Case are called back by the scheduler when their deadlines are due.
+  scheduler_task();
+  scheduler_stats_task();
+#else
 #ifdef ACHORDION_ENABLE
   achordion_task();
 #endif  // ACHORDION_ENABLE
+#ifdef EVENT_QUEUE_ENABLE
+  event_queue_task();
+#endif  // EVENT_QUEUE_ENABLE
 #ifdef ORBITAL_MOUSE_ENABLE
   orbital_mouse_task();
 #endif  // ORBITAL_MOUSE_ENABLE
+#ifdef MOUSE_REPORT_ENABLE
+  mouse_report_task();  // After the tasks of mouse sources.
+#endif  // MOUSE_REPORT_ENABLE
 #ifdef SENTENCE_CASE_ENABLE
   sentence_case_task();
 #endif  // SENTENCE_CASE_ENABLE
+#endif  // SCHEDULER_ENABLE
+#ifdef ACHORDION_ENABLE
+  achordion_stats_task();
+#endif  // ACHORDION_ENABLE
+  dlog_task();
 }
 
@@ -14,6 +14,7 @@
 
 AUDIO_ENABLE = yes
 DEFERRED_EXEC_ENABLE = yes
+SONG_STREAM_ENABLE = yes
 
 ROOT_DIR := $(dir $(realpath $(lastword $(MAKEFILE_LIST))))
 include ${ROOT_DIR}../../../../../rules.mk
@@ -41,10 +41,23 @@ TAP_DANCE_ENABLE ?= no
 
 ACHORDION_ENABLE ?= yes
 ifeq ($(strip $(ACHORDION_ENABLE)), yes)
+	EVENT_QUEUE_ENABLE = yes
 	OPT_DEFS += -DACHORDION_ENABLE
 	SRC += features/achordion.c
 endif
 
+EVENT_QUEUE_ENABLE ?= no
+ifeq ($(strip $(EVENT_QUEUE_ENABLE)), yes)
+	OPT_DEFS += -DEVENT_QUEUE_ENABLE
+	SRC += features/event_queue.c
+endif
+
+SCHEDULER_ENABLE ?= yes
+ifeq ($(strip $(SCHEDULER_ENABLE)), yes)
+	OPT_DEFS += -DSCHEDULER_ENABLE
+	SRC += features/scheduler.c
+endif
+
 CUSTOM_SHIFT_KEYS_ENABLE ?= yes
 ifeq ($(strip $(CUSTOM_SHIFT_KEYS_ENABLE)), yes)
 	OPT_DEFS += -DCUSTOM_SHIFT_KEYS_ENABLE
@@ -57,6 +70,19 @@ endif
 # 	SRC += features/keycode_string.c
 # endif
 
+MAGIC_KEY_ENABLE ?= yes
+ifeq ($(strip $(MAGIC_KEY_ENABLE)), yes)
+	OPT_DEFS += -DMAGIC_KEY_ENABLE
+	SRC += features/magic_key.c
+endif
+
+MOUSE_REPORT_ENABLE ?= yes
+ifeq ($(strip $(MOUSE_REPORT_ENABLE)), yes)
+	MOUSE_ENABLE = yes
+	OPT_DEFS += -DMOUSE_REPORT_ENABLE
+	SRC += features/mouse_report.c
+endif
+
 ORBITAL_MOUSE_ENABLE ?= no
 ifeq ($(strip $(ORBITAL_MOUSE_ENABLE)), yes)
 	MOUSE_ENABLE = yes
@@ -64,9 +90,23 @@ ifeq ($(strip $(ORBITAL_MOUSE_ENABLE)), yes)
 	SRC += features/orbital_mouse.c
 endif
 
+SONG_STREAM_ENABLE ?= no
+ifeq ($(strip $(SONG_STREAM_ENABLE)), yes)
+	DEFERRED_EXEC_ENABLE = yes
+	OPT_DEFS += -DSONG_STREAM_ENABLE
+	SRC += features/song_stream.c
+endif
+
 SENTENCE_CASE_ENABLE = no
 ifeq ($(strip $(SENTENCE_CASE_ENABLE)), yes)
+	JUST_TYPED_ENABLE = yes
 	OPT_DEFS += -DSENTENCE_CASE_ENABLE
 	SRC += features/sentence_case.c
 endif
 
+JUST_TYPED_ENABLE ?= no
+ifeq ($(strip $(JUST_TYPED_ENABLE)), yes)
+	OPT_DEFS += -DJUST_TYPED_ENABLE
+	SRC += features/just_typed.c
+endif
+
@@ -0,0 +1,177 @@
+# Copyright 2025 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Program to render Achordion decision stats as a per-key heatmap."""
+import re
+import sys
+from typing import Dict, List, Tuple
+
+HELP_TEXT = """Render Achordion decision stats as a per-key heatmap.
+Use: python3 achordion_heatmap.py [options] console.log [console2.log ...]
+     python3 achordion_heatmap.py [options] --hid=VID:PID
+
+Reads the stats that the keyboard collects with ACHORDION_STATS defined, either
+from console logs (e.g. saved output of `qmk console`) or over raw HID, and
+prints a heatmap of the chosen stat over the key matrix.
+
+Options:
+  --stat    Which stat to show:
+            --stat=misfire_rate   Misfires per hold, in percent (default)
+            --stat=hold_timeout   Settled as held by timeout
+            --stat=hold_chord     Settled as held by chord
+            --stat=tap_chord      Settled as tapped by chord
+            --stat=tap_streak     Settled as tapped by typing streak
+            --stat=eager          Eager mods applied
+            --stat=misfire        Hold followed soon after by Backspace
+            --stat=hold_combo     Settled as held by a combo
+  --hid     Read stats over raw HID from the keyboard with the given hex
+            vendor and product IDs, e.g. --hid=3297:1977. Needs the `hid`
+            Python package.
+"""
+
+# Order of the counters as reported by the firmware.
+STAT_NAMES = ['hold_timeout', 'hold_chord', 'tap_chord', 'tap_streak',
+              'eager', 'misfire', 'hold_combo']
+RAW_HID_ACHORDION_STATS = 0xAC
+RAW_HID_USAGE_PAGE = 0xFF60
+RAW_HID_USAGE = 0x61
+RAW_HID_REPORT_SIZE = 32
+# Characters for shading the heatmap, from low to high.
+SHADES = ' .:-=+*#%@'
+
+Stats = Dict[Tuple[int, int], List[int]]
+
+
+def read_console_logs(file_names: List[str]) -> Stats:
+  """Parses `achordion_stats` lines from console logs."""
+  pattern = re.compile(r'achordion_stats((?: \d+){%d})' %
+                       (2 + len(STAT_NAMES)))
+  stats = {}
+  for file_name in file_names:
+    for line in open(file_name, 'rt'):
+      match = pattern.search(line)
+      if match:
+        values = [int(x) for x in match.group(1).split()]
+        # Counts are cumulative, so the last line for each key wins.
+        stats[(values[0], values[1])] = values[2:]
+
+  return stats
+
+
+def read_raw_hid(vid_pid: str) -> Stats:
+  """Queries stats over raw HID, one key position per request."""
+  import hid  # pylint: disable=import-outside-toplevel
+
+  vid, pid = (int(x, 16) for x in vid_pid.split(':'))
+  paths = [d['path'] for d in hid.enumerate(vid, pid)
+           if d['usage_page'] == RAW_HID_USAGE_PAGE and
+           d['usage'] == RAW_HID_USAGE]
+  if not paths:
+    print(f'Raw HID interface not found for {vid_pid}')
+    sys.exit(1)
+
+  device = hid.Device(path=paths[0])
+  stats = {}
+  for index in range(256):
+    request = bytes([0, RAW_HID_ACHORDION_STATS, index])
+    device.write(request.ljust(RAW_HID_REPORT_SIZE + 1, b'\0'))
+    response = device.read(RAW_HID_REPORT_SIZE, 1000)
+    if (len(response) < 5 + 2 * len(STAT_NAMES) or
+        response[0] != RAW_HID_ACHORDION_STATS or not response[2]):
+      break
+    counts = [response[5 + 2 * i] | response[6 + 2 * i] << 8
+              for i in range(len(STAT_NAMES))]
+    stats[(response[3], response[4])] = counts
+
+  device.close()
+  return stats
+
+
+def stat_value(counts: List[int], stat: str) -> float:
+  """Computes the value of `stat` from a key's counters."""
+  if stat == 'misfire_rate':
+    holds = (counts[STAT_NAMES.index('hold_timeout')] +
+             counts[STAT_NAMES.index('hold_chord')] +
+             counts[STAT_NAMES.index('hold_combo')])
+    misfires = counts[STAT_NAMES.index('misfire')]
+    return (100.0 * misfires / holds) if holds else 0.0
+  return float(counts[STAT_NAMES.index(stat)])
+
+
+def print_heatmap(stats: Stats, stat: str) -> None:
+  """Prints a shaded heatmap and a table of `stat` over the key matrix."""
+  if not stats:
+    print('No Achordion stats found.')
+    return
+
+  values = {key: stat_value(counts, stat) for key, counts in stats.items()}
+  num_rows = max(row for row, _ in values) + 1
+  num_cols = max(col for _, col in values) + 1
+  max_value = max(values.values()) or 1.0
+
+  print(f'Achordion {stat}, max {max_value:g}\n')
+  print('     ' + ''.join(f'{col:>3}' for col in range(num_cols)))
+  for row in range(num_rows):
+    cells = ''
+    for col in range(num_cols):
+      if (row, col) in values:
+        shade = SHADES[round(values[(row, col)] / max_value *
+                             (len(SHADES) - 1))]
+        cells += f'[{shade}]'
+      else:
+        cells += '   '
+    print(f'{row:>3}  {cells}')
+
+  print('\n(row,col) ' + ' '.join(f'{name:>12}' for name in STAT_NAMES))
+  for key in sorted(stats):
+    counts = stats[key]
+    print(f'({key[0]:2},{key[1]:2})   ' +
+          ' '.join(f'{count:12}' for count in counts))
+
+
+def main(argv):
+  stat = 'misfire_rate'
+  hid_device = None
+  input_file_names = []
+
+  for arg in argv[1:]:
+    if arg.startswith('--'):  # Parse command line options.
+      option, value = arg.split('=', 1)
+      if option == '--stat':
+        if value != 'misfire_rate' and value not in STAT_NAMES:
+          print(f'Invalid stat: {value}')
+          sys.exit(1)
+        stat = value
+      elif option == '--hid':
+        hid_device = value
+      else:
+        print(f'Invalid option: {arg}')
+        sys.exit(1)
+
+    else:
+      input_file_names.append(arg)
+
+  if hid_device:
+    stats = read_raw_hid(hid_device)
+  elif input_file_names:
+    stats = read_console_logs(input_file_names)
+  else:  # No input given; show help text and exit.
+    print(HELP_TEXT)
+    sys.exit(1)
+
+  print_heatmap(stats, stat)
+
+
+if __name__ == '__main__':
+  main(sys.argv)
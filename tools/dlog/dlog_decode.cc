@@ -0,0 +1,302 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file dlog_decode.cc
+ * @brief Decodes the keymap's binary key event log.
+ *
+ * The firmware logs each key event as an 8-byte record (see "Debug logging" in
+ * getreuer.c) instead of formatting text on the keyboard. This program reads
+ * the records back, from console logs or saved raw HID reports, and prints
+ * them as text. Keycodes are formatted by features/keycode_string.c, compiled
+ * for the host, so they read the same as the on-keyboard formatting did.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "keycode_string.h"
+
+namespace {
+
+constexpr char kHelpText[] = R"(Decode the binary key event log.
+Use: dlog_decode [options] [console.log ...]
+
+Reads key event records logged by the keyboard, either from console logs
+(e.g. saved output of `qmk console`, with lines "dlog <hex>") or from raw HID
+reports saved as binary, and prints one line per event with the time, time
+since the previous event, layer, position, tap-hold state, and keycode. For
+releases, the time since the press of the same key is printed too. Reads from
+stdin if no files are given.
+
+Options:
+  --keymap  Path of a source file defining `enum layers` and
+            `enum custom_keycodes`, used to name layers and custom keycodes.
+            Default getreuer.c, run from the repo root. Use --keymap= for none.
+  --raw     Inputs are binary raw HID replies to the 0xD1 command, each a
+            32-byte report {0xD1, count, dropped, records...}.
+)";
+
+constexpr int kRecordSize = 8;
+constexpr int kRawHidReportSize = 32;
+constexpr uint8_t kRawHidDlog = 0xD1;
+constexpr uint16_t kUserKeycodeFirst = 0x7E40;  // QK_USER_0 = SAFE_RANGE.
+
+// Flags, as DLOG_FLAG_* in getreuer.c.
+constexpr uint8_t kFlagPressed = 0x01;
+constexpr uint8_t kFlagTapHold = 0x02;
+constexpr uint8_t kFlagTap = 0x04;
+constexpr uint8_t kFlagCombo = 0x08;
+
+struct Record {
+  uint16_t time;
+  uint8_t row;
+  uint8_t col;
+  uint8_t layer;
+  uint8_t flags;
+  uint16_t keycode;
+};
+
+Record ParseRecord(const uint8_t* bytes) {
+  return Record{static_cast<uint16_t>(bytes[0] | bytes[1] << 8),
+                bytes[2],
+                bytes[3],
+                bytes[4],
+                bytes[5],
+                static_cast<uint16_t>(bytes[6] | bytes[7] << 8)};
+}
+
+/** Gets the names in `enum name { ... }` in `source`, in order. */
+std::vector<std::string> ParseEnum(const std::string& source,
+                                   const std::string& name) {
+  std::vector<std::string> names;
+  const std::regex enum_regex("enum\\s+" + name + "\\s*\\{([^}]*)\\}");
+  std::smatch match;
+  if (!std::regex_search(source, match, enum_regex)) { return names; }
+
+  const std::string body = match[1];
+  const std::regex entry_regex("([A-Za-z_][A-Za-z0-9_]*)\\s*(=[^,]*)?(,|$)");
+  for (auto it = std::sregex_iterator(body.begin(), body.end(), entry_regex);
+       it != std::sregex_iterator(); ++it) {
+    names.push_back((*it)[1]);
+  }
+  return names;
+}
+
+/** Reads `file_name` with // and block comments removed. */
+bool ReadSource(const std::string& file_name, std::string* source) {
+  std::ifstream file(file_name);
+  if (!file) { return false; }
+  const std::string text((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+  source->clear();
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (text.compare(i, 2, "//") == 0) {
+      i = text.find('\n', i);
+      if (i == std::string::npos) { break; }
+    } else if (text.compare(i, 2, "/*") == 0) {
+      i = text.find("*/", i + 2);
+      if (i == std::string::npos) { break; }
+      ++i;
+      continue;
+    }
+    *source += text[i];
+  }
+  return true;
+}
+
+class Decoder {
+ public:
+  Decoder(std::vector<std::string> layer_names,
+          std::vector<std::string> custom_keycode_names)
+      : layer_names_(std::move(layer_names)),
+        custom_keycode_names_(std::move(custom_keycode_names)) {}
+
+  void Print(const Record& r) {
+    if (num_records_++ == 0) {
+      time_ = r.time;
+    } else {
+      time_ += static_cast<uint16_t>(r.time - last_time_);
+    }
+    const uint32_t delta = num_records_ > 1 ? time_ - last_print_time_ : 0;
+    last_time_ = r.time;
+    last_print_time_ = time_;
+
+    std::string layer = "L" + std::to_string(r.layer);
+    if (r.layer < layer_names_.size()) { layer = layer_names_[r.layer]; }
+
+    char position[16];
+    if (r.flags & kFlagCombo) {
+      std::snprintf(position, sizeof(position), "combo  ");
+    } else {
+      std::snprintf(position, sizeof(position), "(%2u,%2u)", r.row, r.col);
+    }
+
+    const char* tap_hold = "";
+    if (r.flags & kFlagTapHold) {
+      tap_hold = (r.flags & kFlagTap) ? "tap" : "hold";
+    }
+
+    // Time since the press, keyed by position, or by keycode for combos.
+    const uint32_t key = (r.flags & kFlagCombo) ? 0x10000 | r.keycode
+                                                : (r.row << 8) | r.col;
+    std::string held;
+    if (r.flags & kFlagPressed) {
+      press_times_[key] = time_;
+    } else {
+      const auto it = press_times_.find(key);
+      if (it != press_times_.end()) {
+        held = "  held " + std::to_string(time_ - it->second) + " ms";
+        press_times_.erase(it);
+      }
+    }
+
+    std::printf("%9u +%5u  %-9s %s %-4s %-7s %s%s\n", time_, delta,
+                layer.c_str(), position, tap_hold,
+                (r.flags & kFlagPressed) ? "press" : "release",
+                KeycodeName(r.keycode).c_str(), held.c_str());
+  }
+
+  void PrintDropped(unsigned count) {
+    std::printf("(%u records dropped; buffer was full)\n", count);
+  }
+
+ private:
+  std::string KeycodeName(uint16_t keycode) const {
+    const uint32_t i = keycode - kUserKeycodeFirst;
+    if (keycode >= kUserKeycodeFirst && i < custom_keycode_names_.size()) {
+      return custom_keycode_names_[i];
+    }
+    return keycode_string(keycode);
+  }
+
+  std::vector<std::string> layer_names_;
+  std::vector<std::string> custom_keycode_names_;
+  std::map<uint32_t, uint32_t> press_times_;
+  uint64_t num_records_ = 0;
+  uint16_t last_time_ = 0;
+  uint32_t time_ = 0;
+  uint32_t last_print_time_ = 0;
+};
+
+int HexDigit(char c) {
+  if ('0' <= c && c <= '9') { return c - '0'; }
+  if ('A' <= c && c <= 'F') { return c - 'A' + 10; }
+  if ('a' <= c && c <= 'f') { return c - 'a' + 10; }
+  return -1;
+}
+
+void DecodeConsoleLog(std::istream& in, Decoder* decoder) {
+  std::string line;
+  while (std::getline(in, line)) {
+    size_t pos;
+    if ((pos = line.find("dlog_dropped ")) != std::string::npos) {
+      decoder->PrintDropped(std::atoi(line.c_str() + pos + 13));
+    } else if ((pos = line.find("dlog ")) != std::string::npos &&
+               line.size() >= pos + 5 + 2 * kRecordSize) {
+      uint8_t bytes[kRecordSize];
+      bool valid = true;
+      for (int i = 0; i < kRecordSize && valid; ++i) {
+        const int hi = HexDigit(line[pos + 5 + 2 * i]);
+        const int lo = HexDigit(line[pos + 6 + 2 * i]);
+        valid = hi >= 0 && lo >= 0;
+        bytes[i] = static_cast<uint8_t>(hi << 4 | lo);
+      }
+      if (valid) { decoder->Print(ParseRecord(bytes)); }
+    }
+  }
+}
+
+void DecodeRawHid(std::istream& in, Decoder* decoder) {
+  uint8_t report[kRawHidReportSize];
+  while (in.read(reinterpret_cast<char*>(report), sizeof(report))) {
+    if (report[0] != kRawHidDlog) { continue; }
+    if (report[2]) { decoder->PrintDropped(report[2]); }
+    const int max_count = (kRawHidReportSize - 3) / kRecordSize;
+    for (int i = 0; i < report[1] && i < max_count; ++i) {
+      decoder->Print(ParseRecord(report + 3 + i * kRecordSize));
+    }
+  }
+}
+
+int Main(int argc, char** argv) {
+  std::string keymap_file = "getreuer.c";
+  bool raw = false;
+  std::vector<std::string> files;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      std::fputs(kHelpText, stdout);
+      return 0;
+    } else if (arg.rfind("--keymap=", 0) == 0) {
+      keymap_file = arg.substr(9);
+    } else if (arg == "--raw") {
+      raw = true;
+    } else if (arg.rfind("--", 0) == 0) {
+      std::fprintf(stderr, "Error: Unknown option: %s\n", arg.c_str());
+      return 1;
+    } else {
+      files.push_back(arg);
+    }
+  }
+
+  std::vector<std::string> layer_names;
+  std::vector<std::string> custom_keycode_names;
+  if (!keymap_file.empty()) {
+    std::string source;
+    if (!ReadSource(keymap_file, &source)) {
+      std::fprintf(stderr, "Error: Failed to read %s\n", keymap_file.c_str());
+      return 1;
+    }
+    layer_names = ParseEnum(source, "layers");
+    custom_keycode_names = ParseEnum(source, "custom_keycodes");
+  }
+
+  Decoder decoder(std::move(layer_names), std::move(custom_keycode_names));
+  const auto decode = [&](std::istream& in) {
+    if (raw) {
+      DecodeRawHid(in, &decoder);
+    } else {
+      DecodeConsoleLog(in, &decoder);
+    }
+  };
+
+  if (files.empty()) {
+    decode(std::cin);
+  }
+  for (const std::string& file_name : files) {
+    std::ifstream file(file_name, raw ? std::ios::binary : std::ios::in);
+    if (!file) {
+      std::fprintf(stderr, "Error: Failed to read %s\n", file_name.c_str());
+      return 1;
+    }
+    decode(file);
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) { return Main(argc, argv); }
@@ -0,0 +1,92 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file quantum.h
+ * @brief Host stand-in for QMK's quantum.h, enough to build keycode_string.c.
+ *
+ * Keycode values and ranges are those of QMK's quantum/keycodes.h, so that
+ * features/keycode_string.c formats keycodes logged by the firmware the same
+ * way on the host as it would on the keyboard.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+
+static inline uint8_t biton(uint8_t bits) {
+  uint8_t n = 0;
+  while (bits >>= 1) { ++n; }
+  return n;
+}
+
+// clang-format off
+enum {
+  KC_A = 0x04, KC_Z = 0x1D,
+  KC_1 = 0x1E, KC_0 = 0x27,
+  KC_ENT = 0x28, KC_ESC, KC_BSPC, KC_TAB, KC_SPC, KC_MINS, KC_EQL, KC_LBRC,
+  KC_RBRC, KC_BSLS, KC_NUHS, KC_SCLN, KC_QUOT, KC_GRV, KC_COMM, KC_DOT,
+  KC_SLSH,
+  KC_F1 = 0x3A, KC_F12 = 0x45,
+  KC_INS = 0x49, KC_HOME, KC_PGUP, KC_DEL, KC_END, KC_PGDN, KC_RGHT, KC_LEFT,
+  KC_DOWN, KC_UP,
+  KC_KP_1 = 0x59, KC_KP_0 = 0x62,
+  KC_F13 = 0x68, KC_F24 = 0x73,
+  KC_LCTL = 0xE0, KC_RGUI = 0xE7,
+
+  QK_MODS = 0x0100, QK_MODS_MAX = 0x1FFF,
+  QK_MOD_TAP = 0x2000, QK_MOD_TAP_MAX = 0x3FFF,
+  QK_LAYER_TAP = 0x4000, QK_LAYER_TAP_MAX = 0x4FFF,
+  QK_LAYER_MOD = 0x5000, QK_LAYER_MOD_MAX = 0x51FF,
+  QK_TO = 0x5200, QK_TO_MAX = 0x521F,
+  QK_MOMENTARY = 0x5220, QK_MOMENTARY_MAX = 0x523F,
+  QK_DEF_LAYER = 0x5240, QK_DEF_LAYER_MAX = 0x525F,
+  QK_TOGGLE_LAYER = 0x5260, QK_TOGGLE_LAYER_MAX = 0x527F,
+  QK_ONE_SHOT_LAYER = 0x5280, QK_ONE_SHOT_LAYER_MAX = 0x529F,
+  QK_ONE_SHOT_MOD = 0x52A0, QK_ONE_SHOT_MOD_MAX = 0x52BF,
+  QK_LAYER_TAP_TOGGLE = 0x52C0, QK_LAYER_TAP_TOGGLE_MAX = 0x52DF,
+  QK_PERSISTENT_DEF_LAYER = 0x52E0, QK_PERSISTENT_DEF_LAYER_MAX = 0x52FF,
+  QK_TAP_DANCE = 0x5700, QK_TAP_DANCE_MAX = 0x57FF,
+  DB_TOGG = 0x7C02,
+  QK_KB_0 = 0x7E00, QK_KB_31 = 0x7E1F,
+  QK_USER_0 = 0x7E40, QK_USER_31 = 0x7E5F,
+};
+// clang-format on
+
+#define MODIFIER_KEYCODE_RANGE KC_LCTL ... KC_RGUI
+#define KB_KEYCODE_RANGE QK_KB_0 ... QK_KB_31
+#define USER_KEYCODE_RANGE QK_USER_0 ... QK_USER_31
+
+#define QK_MODS_GET_MODS(kc) (((kc) >> 8) & 0x1F)
+#define QK_MODS_GET_BASIC_KEYCODE(kc) ((kc) & 0xFF)
+#define QK_MOD_TAP_GET_MODS(kc) (((kc) >> 8) & 0x1F)
+#define QK_MOD_TAP_GET_TAP_KEYCODE(kc) ((kc) & 0xFF)
+#define QK_LAYER_TAP_GET_LAYER(kc) (((kc) >> 8) & 0xF)
+#define QK_LAYER_TAP_GET_TAP_KEYCODE(kc) ((kc) & 0xFF)
+#define QK_LAYER_MOD_GET_LAYER(kc) (((kc) >> 5) & 0xF)
+#define QK_LAYER_MOD_GET_MODS(kc) ((kc) & 0x1F)
+#define QK_TO_GET_LAYER(kc) ((kc) & 0x1F)
+#define QK_MOMENTARY_GET_LAYER(kc) ((kc) & 0x1F)
+#define QK_DEF_LAYER_GET_LAYER(kc) ((kc) & 0x1F)
+#define QK_TOGGLE_LAYER_GET_LAYER(kc) ((kc) & 0x1F)
+#define QK_ONE_SHOT_LAYER_GET_LAYER(kc) ((kc) & 0x1F)
+#define QK_ONE_SHOT_MOD_GET_MODS(kc) ((kc) & 0x1F)
+#define QK_LAYER_TAP_TOGGLE_GET_LAYER(kc) ((kc) & 0x1F)
+#define QK_PERSISTENT_DEF_LAYER_GET_LAYER(kc) ((kc) & 0x1F)
+#define QK_TAP_DANCE_GET_INDEX(kc) ((kc) & 0xFF)
@@ -0,0 +1,174 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file achordion_test.c
+ * @brief Counts the reports Achordion sends when settling eager mods as tapped.
+ *
+ * An eager Shift or Ctrl settled as tapped is cleared without a report of its
+ * own, so that the tap press report carries the mods release. Eager Alt and
+ * GUI are released with a report of their own, since they may need to be
+ * neutralized. This test checks both paths, key by key.
+ *
+ * A combo triggered while a tap-hold key is unsettled settles it as held. The
+ * hold press is queued ahead of the combo event, so the combo's key is sent
+ * with the mods.
+ *
+ * A Backspace counts a hold as a misfire only after the hold key is released,
+ * not while the mod is in use, as in Alt + Backspace.
+ */
+
+#include "achordion.h"
+#include "qmk_host.h"
+
+// Row 0 is the left hand, row 6 the right.
+static uint16_t keymap[MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {LSFT_T(KC_A), KC_B, LALT_T(KC_C), KC_BSPC},
+};
+
+uint16_t host_keymap(keypos_t key) { return keymap[key.row][key.col]; }
+
+bool process_record_user(uint16_t keycode, keyrecord_t* record) {
+  if (!process_event_queue(keycode, record)) { return false; }
+  if (!process_achordion(keycode, record)) { return false; }
+  return true;
+}
+
+// Make every mod eager, so that Alt takes the neutralized path.
+static bool eager = true;
+bool achordion_eager_mod(uint8_t mod) { return eager; }
+
+static void run_tasks(void) {
+  for (int i = 0; i < 10; ++i) {
+    achordion_task();
+    event_queue_task();
+    host_advance(1);
+  }
+}
+
+// Presses the mod-tap key at column `mt_col`, then KC_B on the same hand, so
+// that Achordion settles the mod-tap key as tapped. Returns the number of
+// reports sent from the KC_B press on, which are checked to be the tap key,
+// then KC_B, without mods.
+static int count_settle_reports(uint8_t mt_col, uint8_t tap_key,
+                                uint8_t mod_bits) {
+  host_reset(1000);
+  host_key_event(0, mt_col, true, 0);
+  run_tasks();
+  CHECK(host_num_reports == 1);  // Eager mods applied.
+  CHECK(host_reports[0].mods == mod_bits);
+
+  host_num_reports = 0;
+  host_key_event(0, 1, true, 0);
+  run_tasks();
+  const int count = host_num_reports;
+  CHECK(count >= 3 && count <= HOST_MAX_REPORTS);
+  const host_report_t* tap = &host_reports[count - 3];
+  CHECK(tap->mods == 0 && tap->keys[0] == tap_key);
+  CHECK(host_reports[count - 2].mods == 0 && !host_reports[count - 2].keys[0]);
+  CHECK(host_reports[count - 1].mods == 0 &&
+        host_reports[count - 1].keys[0] == KC_B);
+
+  host_key_event(0, 1, false, 0);
+  host_key_event(0, mt_col, false, 0);
+  run_tasks();
+  CHECK(event_queue_is_empty());
+  return count;
+}
+
+// Presses LALT_T(KC_C), not eager, then a combo sending KC_B.
+static void check_combo_hold(void) {
+  eager = false;
+  host_reset(1000);
+  host_key_event(0, 2, true, 0);
+  run_tasks();
+  CHECK(host_num_reports == 0);  // Unsettled.
+
+  keyrecord_t combo = {0};
+  combo.event = MAKE_KEYEVENT(0, 5, true);
+  combo.event.type = COMBO_EVENT;
+  combo.keycode = KC_B;
+  process_record(&combo);
+  run_tasks();
+  CHECK(host_num_reports == 2);
+  CHECK(host_reports[0].mods == MOD_BIT_LALT && !host_reports[0].keys[0]);
+  CHECK(host_reports[1].mods == MOD_BIT_LALT &&
+        host_reports[1].keys[0] == KC_B);
+
+  combo.event.pressed = false;
+  process_record(&combo);
+  host_key_event(0, 2, false, 0);
+  run_tasks();
+  CHECK(event_queue_is_empty());
+  CHECK(host_num_reports == 4);
+  CHECK(host_reports[3].mods == 0 && !host_reports[3].keys[0]);
+  eager = true;
+}
+
+// Returns the misfire count of LALT_T(KC_C).
+static uint16_t misfires(void) {
+  keypos_t key;
+  uint16_t counts[ACHORDION_NUM_STATS];
+  for (uint8_t i = 0; achordion_stats_get(i, &key, counts); ++i) {
+    if (key.row == 0 && key.col == 2) {
+      return counts[ACHORDION_STAT_MISFIRE];
+    }
+  }
+  return 0;
+}
+
+// Holds LALT_T(KC_C), not eager, until settled by the timeout, and taps
+// Backspace before and after releasing it.
+static void check_misfire(void) {
+  eager = false;
+  host_reset(1000);
+  achordion_stats_clear();
+  host_key_event(0, 2, true, 0);
+  for (int i = 0; i < 200 && !host_num_reports; ++i) {
+    run_tasks();
+  }
+  CHECK(host_num_reports == 1 && host_reports[0].mods == MOD_BIT_LALT);
+
+  // Alt + Backspace, right after the hold is settled.
+  host_key_event(0, 3, true, 0);
+  host_key_event(0, 3, false, 0);
+  run_tasks();
+  CHECK(misfires() == 0);
+
+  host_key_event(0, 2, false, 0);
+  run_tasks();
+  host_key_event(0, 3, true, 0);
+  host_key_event(0, 3, false, 0);
+  run_tasks();
+  CHECK(misfires() == 1);
+  CHECK(event_queue_is_empty());
+  eager = true;
+}
+
+int main(void) {
+  // Shift: tap press (mods released in the same report), tap release, B.
+  const int shift_reports = count_settle_reports(0, KC_A, MOD_BIT_LSHIFT);
+  CHECK(shift_reports == 3);
+
+  // Alt: mods release, tap press, tap release, B.
+  const int alt_reports = count_settle_reports(2, KC_C, MOD_BIT_LALT);
+  CHECK(alt_reports == 4);
+
+  check_combo_hold();
+  check_misfire();
+
+  printf("achordion_test: Shift settle %d reports, Alt settle %d. PASS\n",
+         shift_reports, alt_reports);
+  return 0;
+}
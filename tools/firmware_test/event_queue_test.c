@@ -0,0 +1,138 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file event_queue_test.c
+ * @brief Sends real key events to a full event queue.
+ *
+ * The queue is filled with delayed synthetic taps and deferred real events.
+ * The next real release, and then the next real press, find no room. Neither
+ * may be lost: the pending events are flushed, in order, and the real event is
+ * processed after them.
+ */
+
+#include "event_queue.h"
+#include "qmk_host.h"
+
+static uint16_t keymap[MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {KC_A, KC_B, KC_C, KC_D},
+};
+
+uint16_t host_keymap(keypos_t key) { return keymap[key.row][key.col]; }
+
+bool process_record_user(uint16_t keycode, keyrecord_t* record) {
+  if (!process_event_queue(keycode, record)) { return false; }
+  return true;
+}
+
+// Queues `n` taps of KC_A, each event delayed by 10 ms.
+static void push_taps(int n) {
+  keyrecord_t record = {0};
+  record.keycode = KC_A;
+  for (int i = 0; i < n; ++i) {
+    record.event.pressed = true;
+    CHECK(event_queue_push(&record, EVENT_QUEUE_SOURCE_REPEAT_KEY, 0, 0, 10));
+    record.event.pressed = false;
+    CHECK(event_queue_push(&record, EVENT_QUEUE_SOURCE_REPEAT_KEY, 0, 0, 10));
+  }
+}
+
+// Fills the queue with taps of KC_A, then a deferred tap of KC_B.
+static void fill_queue(void) {
+  const int taps = (EVENT_QUEUE_SIZE - 2) / 2;
+  CHECK(event_queue_free() >= 2 * taps - 1);
+  push_taps(taps);
+  host_key_event(0, 1, true, 0);
+  host_key_event(0, 1, false, 0);
+}
+
+// Checks that report `i` holds only `key`, or no key if `key` is KC_NO.
+static void check_report(int i, uint8_t key) {
+  CHECK(i < host_num_reports);
+  CHECK(host_reports[i].mods == 0 && host_reports[i].keys[0] == key);
+  for (int k = 1; k < 6; ++k) {
+    CHECK(!host_reports[i].keys[k]);
+  }
+}
+
+// Checks the reports of the flushed queue from report `i` on: the taps of
+// KC_A, then the tap of KC_B. Returns the index after them.
+static int check_flushed(int i) {
+  for (int k = 0; k < (EVENT_QUEUE_SIZE - 2) / 2; ++k) {
+    check_report(i++, KC_A);
+    check_report(i++, KC_NO);
+  }
+  check_report(i++, KC_B);
+  check_report(i++, KC_NO);
+  return i;
+}
+
+int main(void) {
+  host_reset(1000);
+
+  // A real release on a full queue. KC_C was pressed before the queue filled.
+  host_key_event(0, 2, true, 0);
+  check_report(0, KC_C);
+  host_num_reports = 0;
+  fill_queue();
+  CHECK(host_num_reports == 0);
+  host_key_event(0, 2, false, 0);
+  CHECK(event_queue_is_empty());
+  // The flushed taps are sent while KC_C is still held.
+  for (int k = 0; k < (EVENT_QUEUE_SIZE - 2) / 2; ++k) {
+    CHECK(host_reports[2 * k].keys[0] == KC_C &&
+          host_reports[2 * k].keys[1] == KC_A);
+    CHECK(host_reports[2 * k + 1].keys[0] == KC_C &&
+          !host_reports[2 * k + 1].keys[1]);
+  }
+  const int c_release = EVENT_QUEUE_SIZE - 2;
+  CHECK(host_reports[c_release].keys[0] == KC_C &&
+        host_reports[c_release].keys[1] == KC_B);
+  CHECK(host_reports[c_release + 1].keys[0] == KC_C &&
+        !host_reports[c_release + 1].keys[1]);
+  check_report(c_release + 2, KC_NO);  // KC_C released, not stuck.
+  CHECK(host_num_reports == c_release + 3);
+
+  // A real press on a full queue.
+  host_num_reports = 0;
+  fill_queue();
+  host_key_event(0, 3, true, 0);
+  CHECK(event_queue_is_empty());
+  int i = check_flushed(0);
+  check_report(i++, KC_D);  // Pressed, not lost.
+  host_key_event(0, 3, false, 0);
+  check_report(i++, KC_NO);
+  CHECK(host_num_reports == i);
+
+  // With room in the queue, real events still wait for the delays.
+  host_num_reports = 0;
+  push_taps(1);
+  host_key_event(0, 3, true, 0);
+  host_key_event(0, 3, false, 0);
+  event_queue_task();
+  CHECK(host_num_reports == 0);
+  for (int ms = 0; ms < 100 && !event_queue_is_empty(); ++ms) {
+    host_advance(1);
+    event_queue_task();
+  }
+  CHECK(event_queue_is_empty());
+  check_report(0, KC_A);
+  check_report(1, KC_NO);
+  check_report(2, KC_D);
+  check_report(3, KC_NO);
+  CHECK(host_num_reports == 4);
+
+  printf("event_queue_test: PASS\n");
+  return 0;
+}
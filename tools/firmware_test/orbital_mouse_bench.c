@@ -0,0 +1,131 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file orbital_mouse_bench.c
+ * @brief Accuracy and speed of Orbital Mouse's fixed-point sine.
+ *
+ * orbital_mouse.c is included directly, so that its static `scaled_sin()` is
+ * measured as built. It is compared with the half-wave table lookup it
+ * replaced, copied below as `scaled_sin_coarse()`, which ignored the fraction
+ * of the heading angle. Prints
+ *
+ *  - the number of whole angles where the two differ, which must be 0 so that
+ *    default steering is unchanged,
+ *  - the largest error against the exact sine over all 64 * 256 headings, in
+ *    pixels at the full 63.75 px amplitude,
+ *  - the time per call of each, and per step of `orbital_mouse_task()` while
+ *    moving and steering.
+ *
+ * Times are in TSC cycles on x86, elsewhere in ns. Run with
+ *
+ *   make -C tools/firmware_test bench
+ */
+
+#include <math.h>
+#include <time.h>
+
+#include "orbital_mouse.c"
+#include "qmk_host.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TICK_UNIT "cycles"
+static uint64_t ticks(void) { return __rdtsc(); }
+#else
+#define TICK_UNIT "ns"
+static uint64_t ticks(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+#endif
+
+// The sine before interpolation: a half-wave table indexed by whole angle.
+static int16_t scaled_sin_coarse(uint8_t amplitude, uint8_t phase) {
+  static const uint8_t lut[NUM_ANGLES / 2] PROGMEM = {
+      0,   25,  50,  74,  98,  120, 142, 162, 180, 197, 212,
+      225, 236, 244, 250, 254, 255, 254, 250, 244, 236, 225,
+      212, 197, 180, 162, 142, 120, 98,  74,  50,  25};
+  const uint8_t sine = pgm_read_byte(lut + (phase & (NUM_ANGLES / 2 - 1)));
+  int16_t value = (int16_t)(((uint16_t)amplitude * sine + 2) >> 2);
+  return ((NUM_ANGLES / 2) & phase) == 0 ? value : -value;
+}
+
+static volatile int16_t sink;
+
+static void press(uint16_t keycode, bool pressed) {
+  keyrecord_t record = {0};
+  record.event.pressed = pressed;
+  record.event.time = timer_read();
+  process_orbital_mouse(keycode, &record);
+}
+
+int main(void) {
+  int mismatches = 0;
+  for (int amplitude = 1; amplitude < 256; amplitude += 7) {
+    for (int angle = 0; angle < NUM_ANGLES; ++angle) {
+      if (scaled_sin_coarse(amplitude, angle) !=
+          scaled_sin(amplitude, angle << 8)) {
+        ++mismatches;
+      }
+    }
+  }
+  printf("mismatches at whole angles: %d\n", mismatches);
+  CHECK(mismatches == 0);
+
+  double max_err_coarse = 0.0;
+  double max_err = 0.0;
+  for (uint32_t phase = 0; phase < NUM_ANGLES * 256; ++phase) {
+    const double exact =
+        255 * 64 * sin(phase * 2 * M_PI / (NUM_ANGLES * 256));  // Q6.8.
+    const double err_coarse = fabs(scaled_sin_coarse(255, phase >> 8) - exact);
+    const double err = fabs(scaled_sin(255, phase) - exact);
+    if (err_coarse > max_err_coarse) { max_err_coarse = err_coarse; }
+    if (err > max_err) { max_err = err; }
+  }
+  printf("max error at 63.75 px amplitude: coarse %.2f px, interpolated "
+         "%.2f px\n", max_err_coarse / 256, max_err / 256);
+  CHECK(max_err < max_err_coarse);
+
+  enum { NUM_CALLS = 20000000, NUM_STEPS = 2000000 };
+  for (int rep = 0; rep < 3; ++rep) {
+    const uint64_t t0 = ticks();
+    for (int k = 0; k < NUM_CALLS; ++k) {
+      sink = scaled_sin_coarse((uint8_t)k, (uint8_t)(k >> 3));
+    }
+    const uint64_t t1 = ticks();
+    for (int k = 0; k < NUM_CALLS; ++k) {
+      sink = scaled_sin((uint8_t)k, (uint16_t)(k >> 3));
+    }
+    const uint64_t t2 = ticks();
+    printf("scaled_sin: coarse %.1f, interpolated %.1f " TICK_UNIT "/call\n",
+           (double)(t1 - t0) / NUM_CALLS, (double)(t2 - t1) / NUM_CALLS);
+  }
+
+  host_reset(1000);
+  press(OM_U, true);
+  press(OM_L, true);
+  uint64_t task_ticks = 0;
+  for (int k = 0; k < NUM_STEPS; ++k) {
+    host_advance(ORBITAL_MOUSE_INTERVAL_MS);  // Every call is a step.
+    const uint64_t t0 = ticks();
+    orbital_mouse_task();
+    task_ticks += ticks() - t0;
+  }
+  printf("orbital_mouse_task, moving and steering: %.1f " TICK_UNIT
+         "/step\n", (double)task_ticks / NUM_STEPS);
+  CHECK(host_num_mouse_reports > 0);
+  return 0;
+}
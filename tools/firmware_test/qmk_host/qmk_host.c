@@ -0,0 +1,311 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file qmk_host.c
+ * @brief Host stand-in for the parts of QMK that features call.
+ *
+ * Actions are reduced to what QMK does for basic keys, mods, and mod-tap keys:
+ * each press or release updates the report and sends it, so the recorded
+ * reports are the ones a host would see.
+ */
+
+#include "qmk_host.h"
+
+bool debug_enable = false;
+
+host_report_t host_reports[HOST_MAX_REPORTS];
+int host_num_reports = 0;
+report_mouse_t host_mouse_report;
+int host_num_mouse_reports = 0;
+host_tone_t host_tones[HOST_MAX_TONES];
+int host_num_tones = 0;
+
+// Maximum number of deferred callbacks at once.
+#define HOST_MAX_DEFERRED 4
+
+static uint32_t now = 0;
+static uint8_t real_mods = 0;
+static uint8_t weak_mods = 0;
+static uint8_t keys[6];
+static struct {
+  deferred_token token;
+  uint32_t trigger_time;
+  deferred_exec_callback callback;
+  void* cb_arg;
+} deferred[HOST_MAX_DEFERRED];
+static deferred_token last_token = INVALID_DEFERRED_TOKEN;
+static uint32_t last_deferred_check = 0;
+static uint8_t tempo = 120;
+
+void host_reset(uint32_t time) {
+  now = time;
+  real_mods = 0;
+  weak_mods = 0;
+  memset(keys, 0, sizeof(keys));
+  host_num_reports = 0;
+  memset(&host_mouse_report, 0, sizeof(host_mouse_report));
+  host_num_mouse_reports = 0;
+  memset(deferred, 0, sizeof(deferred));
+  last_deferred_check = time;
+  host_num_tones = 0;
+  tempo = 120;
+}
+
+void host_advance(uint32_t ms) { now += ms; }
+
+void host_key_event(uint8_t row, uint8_t col, bool pressed,
+                    uint8_t tap_count) {
+  keyrecord_t record = {0};
+  record.event = MAKE_KEYEVENT(row, col, pressed);
+  record.tap.count = tap_count;
+  process_record(&record);
+}
+
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback,
+                          void* cb_arg) {
+  if (!delay_ms || !callback) {
+    return INVALID_DEFERRED_TOKEN;
+  }
+  for (int i = 0; i < HOST_MAX_DEFERRED; ++i) {
+    if (deferred[i].token == INVALID_DEFERRED_TOKEN) {
+      if (++last_token == INVALID_DEFERRED_TOKEN) {
+        ++last_token;
+      }
+      deferred[i].token = last_token;
+      deferred[i].trigger_time = now + delay_ms;
+      deferred[i].callback = callback;
+      deferred[i].cb_arg = cb_arg;
+      return last_token;
+    }
+  }
+  return INVALID_DEFERRED_TOKEN;
+}
+
+bool extend_deferred_exec(deferred_token token, uint32_t delay_ms) {
+  for (int i = 0; i < HOST_MAX_DEFERRED; ++i) {
+    if (token != INVALID_DEFERRED_TOKEN && deferred[i].token == token) {
+      deferred[i].trigger_time = now + delay_ms;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool cancel_deferred_exec(deferred_token token) {
+  for (int i = 0; i < HOST_MAX_DEFERRED; ++i) {
+    if (token != INVALID_DEFERRED_TOKEN && deferred[i].token == token) {
+      deferred[i].token = INVALID_DEFERRED_TOKEN;
+      return true;
+    }
+  }
+  return false;
+}
+
+void host_deferred_exec_task(void) {
+  if (now == last_deferred_check) {
+    return;  // Like QMK, check at most once per ms.
+  }
+  last_deferred_check = now;
+  for (int i = 0; i < HOST_MAX_DEFERRED; ++i) {
+    if (deferred[i].token != INVALID_DEFERRED_TOKEN &&
+        timer_expired32(now, deferred[i].trigger_time)) {
+      const deferred_token token = deferred[i].token;
+      const uint32_t delay_ms =
+          deferred[i].callback(deferred[i].trigger_time, deferred[i].cb_arg);
+      // The callback may have canceled itself.
+      if (deferred[i].token == token) {
+        if (delay_ms) {
+          deferred[i].trigger_time = now + delay_ms;
+        } else {
+          deferred[i].token = INVALID_DEFERRED_TOKEN;
+        }
+      }
+    }
+  }
+}
+
+uint16_t timer_read(void) { return (uint16_t)now; }
+uint32_t timer_read32(void) { return now; }
+uint16_t timer_elapsed(uint16_t last) { return (uint16_t)(now - last); }
+uint32_t timer_elapsed32(uint32_t last) { return now - last; }
+
+void send_keyboard_report(void) {
+  if (host_num_reports < HOST_MAX_REPORTS) {
+    host_report_t* report = &host_reports[host_num_reports];
+    report->time = now;
+    report->mods = real_mods | weak_mods;
+    memcpy(report->keys, keys, sizeof(keys));
+  }
+  ++host_num_reports;
+}
+
+void host_mouse_send(report_mouse_t* report) {
+  host_mouse_report = *report;
+  ++host_num_mouse_reports;
+}
+
+static void record_tone(float hz, bool on) {
+  if (host_num_tones < HOST_MAX_TONES) {
+    host_tones[host_num_tones] = (host_tone_t){.time = now, .hz = hz, .on = on};
+  }
+  ++host_num_tones;
+}
+
+void audio_play_tone(float pitch) { record_tone(pitch, true); }
+void audio_stop_tone(float pitch) { record_tone(pitch, false); }
+void audio_set_tempo(uint8_t new_tempo) { tempo = new_tempo; }
+
+// As in QMK's audio.c, `duration_bpm` is in 1/64ths of a beat.
+uint16_t audio_duration_to_ms(uint16_t duration_bpm) {
+  return ((uint32_t)duration_bpm * 60 * 1000) / (64 * tempo);
+}
+
+static void add_key(uint8_t kc) {
+  for (int i = 0; i < 6; ++i) {
+    if (keys[i] == kc) { return; }
+  }
+  for (int i = 0; i < 6; ++i) {
+    if (!keys[i]) {
+      keys[i] = kc;
+      return;
+    }
+  }
+}
+
+static void del_key(uint8_t kc) {
+  for (int i = 0; i < 6; ++i) {
+    if (keys[i] == kc) { keys[i] = 0; }
+  }
+}
+
+void register_code(uint8_t kc) {
+  if (kc >= KC_LCTL) {
+    real_mods |= MOD_BIT(kc);
+  } else {
+    add_key(kc);
+  }
+  send_keyboard_report();
+}
+
+void unregister_code(uint8_t kc) {
+  if (kc >= KC_LCTL) {
+    real_mods &= ~MOD_BIT(kc);
+  } else {
+    del_key(kc);
+  }
+  send_keyboard_report();
+}
+
+void register_code16(uint16_t kc) { register_code(kc & 0xff); }
+void unregister_code16(uint16_t kc) { unregister_code(kc & 0xff); }
+
+uint8_t get_mods(void) { return real_mods; }
+void add_mods(uint8_t mods) { real_mods |= mods; }
+void del_mods(uint8_t mods) { real_mods &= ~mods; }
+void set_mods(uint8_t mods) { real_mods = mods; }
+void clear_mods(void) { real_mods = 0; }
+
+void register_mods(uint8_t mods) {
+  add_mods(mods);
+  send_keyboard_report();
+}
+
+void unregister_mods(uint8_t mods) {
+  del_mods(mods);
+  send_keyboard_report();
+}
+
+uint8_t get_weak_mods(void) { return weak_mods; }
+void add_weak_mods(uint8_t mods) { weak_mods |= mods; }
+void del_weak_mods(uint8_t mods) { weak_mods &= ~mods; }
+void clear_weak_mods(void) { weak_mods = 0; }
+
+void register_weak_mods(uint8_t mods) {
+  add_weak_mods(mods);
+  send_keyboard_report();
+}
+
+void unregister_weak_mods(uint8_t mods) {
+  del_weak_mods(mods);
+  send_keyboard_report();
+}
+
+action_t action_for_keycode(uint16_t keycode) {
+  action_t action;
+  if (IS_QK_MOD_TAP(keycode)) {
+    action.code = ACTION_MODS_TAP_KEY(QK_MOD_TAP_GET_MODS(keycode),
+                                      QK_MOD_TAP_GET_TAP_KEYCODE(keycode));
+  } else {
+    action.code = ACTION_MODS_KEY(0, keycode & 0xff);
+  }
+  return action;
+}
+
+// Like QMK's ACT_LMODS, ACT_RMODS, ACT_LMODS_TAP, and ACT_RMODS_TAP actions.
+// Bits 8-11 are the mods, bit 12 selects the right-hand mods, and bit 13 makes
+// the action a mod-tap, which sends the key when tapped and the mods if not.
+void process_action(keyrecord_t* record, action_t action) {
+  const uint8_t mods4 = (action.code >> 8) & 0x0f;
+  const uint8_t mods = (action.code & 0x1000) ? mods4 << 4 : mods4;
+  const uint8_t key = action.code & 0xff;
+  const bool pressed = record->event.pressed;
+
+  if (action.code & 0x2000) {  // Mod-tap.
+    if (record->tap.count > 0) {
+      if (pressed) {
+        register_code(key);
+      } else {
+        unregister_code(key);
+      }
+    } else if (pressed) {
+      register_mods(mods);
+    } else {
+      unregister_mods(mods);
+    }
+    return;
+  }
+
+  if (pressed) {
+    add_mods(mods);
+    if (key) {
+      register_code(key);
+    } else {
+      send_keyboard_report();
+    }
+  } else {
+    del_mods(mods);
+    if (key) {
+      unregister_code(key);
+    } else {
+      send_keyboard_report();
+    }
+  }
+}
+
+// Defaults for tests that don't send key events.
+__attribute__((weak)) uint16_t host_keymap(keypos_t key) { return KC_NO; }
+
+__attribute__((weak)) bool process_record_user(uint16_t keycode,
+                                               keyrecord_t* record) {
+  return true;
+}
+
+void process_record(keyrecord_t* record) {
+  const uint16_t keycode =
+      record->keycode ? record->keycode : host_keymap(record->event.key);
+  if (process_record_user(keycode, record)) {
+    process_action(record, action_for_keycode(keycode));
+  }
+}
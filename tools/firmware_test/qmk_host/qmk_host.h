@@ -0,0 +1,108 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file qmk_host.h
+ * @brief Test controls for the host stand-in of QMK.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "quantum.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** A keyboard report as sent to the host, and the time it was sent. */
+typedef struct {
+  uint32_t time;
+  uint8_t mods;
+  uint8_t keys[6];
+} host_report_t;
+
+/** Maximum number of reports recorded. Later reports are counted only. */
+#ifndef HOST_MAX_REPORTS
+#define HOST_MAX_REPORTS 64
+#endif  // HOST_MAX_REPORTS
+
+/** Reports sent since the last `host_reset()`. */
+extern host_report_t host_reports[HOST_MAX_REPORTS];
+extern int host_num_reports;
+
+/** The last mouse report sent, and the number sent. */
+extern report_mouse_t host_mouse_report;
+extern int host_num_mouse_reports;
+
+/** A tone started or stopped by the audio functions. */
+typedef struct {
+  uint32_t time;
+  float hz;
+  bool on;
+} host_tone_t;
+
+/** Maximum number of tone events recorded. Later events are counted only. */
+#define HOST_MAX_TONES 256
+
+/** Tone events since the last `host_reset()`. */
+extern host_tone_t host_tones[HOST_MAX_TONES];
+extern int host_num_tones;
+
+/**
+ * Clears the reports, tones, mods, held keys, and deferred callbacks, resets
+ * the tempo to 120, and sets the clock to `time`.
+ */
+void host_reset(uint32_t time);
+
+/** Advances the clock by `ms`. */
+void host_advance(uint32_t ms);
+
+/**
+ * Runs the deferred execution callbacks that are due, as QMK's main loop does
+ * on each pass: at most once per ms, with the next call of a callback
+ * scheduled from the current time plus the delay it returns.
+ */
+void host_deferred_exec_task(void);
+
+/**
+ * Keymap for the test, returning the keycode at `key`. Tests that send key
+ * events define this, and `process_record()` uses it for records without a
+ * `.keycode`.
+ */
+uint16_t host_keymap(keypos_t key);
+
+/**
+ * Handler the test may define, called by `process_record()` like QMK calls
+ * `process_record_user()`. Returning false skips the default action.
+ */
+bool process_record_user(uint16_t keycode, keyrecord_t* record);
+
+/** Sends a key event, as the matrix scan would, at the current time. */
+void host_key_event(uint8_t row, uint8_t col, bool pressed, uint8_t tap_count);
+
+#define CHECK(cond)                                                \
+  do {                                                             \
+    if (!(cond)) {                                                 \
+      fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__,      \
+              __LINE__, #cond);                                    \
+      exit(1);                                                     \
+    }                                                              \
+  } while (0)
+
+#ifdef __cplusplus
+}
+#endif
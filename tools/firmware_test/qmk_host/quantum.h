@@ -0,0 +1,238 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file quantum.h
+ * @brief Host stand-in for QMK's quantum.h, enough to run features on a PC.
+ *
+ * Keycodes, keyrecords, and actions follow QMK's definitions, reduced to what
+ * the features under test use. The functions are implemented in qmk_host.c
+ * with a simulated clock and keyboard report, so that tests can step time and
+ * inspect every report that a feature sends.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_float(p) (*(const float*)(p))
+
+#define MATRIX_ROWS 12
+#define MATRIX_COLS 7
+#ifndef TAP_CODE_DELAY
+#define TAP_CODE_DELAY 0
+#endif  // TAP_CODE_DELAY
+#ifndef TAPPING_TERM
+#define TAPPING_TERM 200
+#endif  // TAPPING_TERM
+
+// Key events and records.
+typedef struct {
+  uint8_t col;
+  uint8_t row;
+} keypos_t;
+typedef enum { TICK_EVENT = 0, KEY_EVENT = 1, COMBO_EVENT = 4 } keyevent_type_t;
+typedef struct {
+  keypos_t key;
+  uint16_t time;
+  keyevent_type_t type;
+  bool pressed;
+} keyevent_t;
+typedef struct {
+  bool interrupted : 1;
+  bool reserved2 : 1;
+  bool reserved1 : 1;
+  bool reserved0 : 1;
+  uint8_t count : 4;
+} tap_t;
+typedef struct {
+  keyevent_t event;
+  tap_t tap;
+  uint16_t keycode;
+} keyrecord_t;
+#define IS_KEYEVENT(event) ((event).type == KEY_EVENT)
+#define MAKE_KEYEVENT(row_num, col_num, press)                       \
+  ((keyevent_t){.key = ((keypos_t){.row = (row_num), .col = (col_num)}), \
+                .pressed = (press),                                   \
+                .time = timer_read(),                                 \
+                .type = KEY_EVENT})
+
+// Actions. Only mods, keys, and mod-tap keys are modeled.
+typedef union {
+  uint16_t code;
+} action_t;
+#define ACTION_MODS_KEY(mods, key) ((uint16_t)(((mods) << 8) | (key)))
+#define ACTION_MODS(mods) ACTION_MODS_KEY(mods, 0)
+#define ACTION_MODS_TAP_KEY(mods, key) \
+  ((uint16_t)(0x2000 | ((mods) << 8) | (key)))
+action_t action_for_keycode(uint16_t keycode);
+void process_action(keyrecord_t* record, action_t action);
+void process_record(keyrecord_t* record);
+
+// Timers, on the simulated clock.
+uint16_t timer_read(void);
+uint32_t timer_read32(void);
+uint16_t timer_elapsed(uint16_t last);
+uint32_t timer_elapsed32(uint32_t last);
+#define timer_expired(current, future) \
+  ((uint16_t)((current) - (future)) < UINT16_MAX / 2)
+#define timer_expired32(current, future) \
+  ((uint32_t)((current) - (future)) < UINT32_MAX / 2)
+
+// Deferred execution. Callbacks run from `host_deferred_exec_task()`.
+typedef uint8_t deferred_token;
+#define INVALID_DEFERRED_TOKEN 0
+typedef uint32_t (*deferred_exec_callback)(uint32_t trigger_time,
+                                           void* cb_arg);
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback,
+                          void* cb_arg);
+bool extend_deferred_exec(deferred_token token, uint32_t delay_ms);
+bool cancel_deferred_exec(deferred_token token);
+
+// Keyboard report.
+void send_keyboard_report(void);
+void register_code(uint8_t kc);
+void unregister_code(uint8_t kc);
+void register_code16(uint16_t kc);
+void unregister_code16(uint16_t kc);
+uint8_t get_mods(void);
+void add_mods(uint8_t mods);
+void del_mods(uint8_t mods);
+void set_mods(uint8_t mods);
+void clear_mods(void);
+void register_mods(uint8_t mods);
+void unregister_mods(uint8_t mods);
+uint8_t get_weak_mods(void);
+void add_weak_mods(uint8_t mods);
+void del_weak_mods(uint8_t mods);
+void clear_weak_mods(void);
+void register_weak_mods(uint8_t mods);
+void unregister_weak_mods(uint8_t mods);
+static inline uint8_t mod_config(uint8_t mod) { return mod; }
+
+// Mouse report.
+typedef struct {
+  uint8_t buttons;
+  int8_t x;
+  int8_t y;
+  int8_t v;
+  int8_t h;
+} report_mouse_t;
+void host_mouse_send(report_mouse_t* report);
+
+// Audio. Tones are recorded by qmk_host.c rather than played.
+#define NOTE_C8 4186.01f
+#define NOTE_CS8 4434.92f
+#define NOTE_D8 4698.63f
+#define NOTE_DS8 4978.03f
+#define NOTE_E8 5274.04f
+#define NOTE_F8 5587.65f
+#define NOTE_FS8 5919.91f
+#define NOTE_G8 6271.93f
+#define NOTE_GS8 6644.88f
+#define NOTE_A8 7040.00f
+#define NOTE_AS8 7458.62f
+#define NOTE_B8 7902.13f
+void audio_play_tone(float pitch);
+void audio_stop_tone(float pitch);
+void audio_set_tempo(uint8_t tempo);
+uint16_t audio_duration_to_ms(uint16_t duration_bpm);
+
+// Debug printing, enabled by `debug_enable`.
+extern bool debug_enable;
+#undef dprintf
+#define dprintf(...) \
+  do { if (debug_enable) { printf(__VA_ARGS__); } } while (0)
+#define dprint(s) dprintf("%s", s)
+#define dprintln(s) dprintf("%s\n", s)
+
+// Mods.
+enum {
+  MOD_LCTL = 0x01, MOD_LSFT = 0x02, MOD_LALT = 0x04, MOD_LGUI = 0x08,
+  MOD_RCTL = 0x11, MOD_RSFT = 0x12, MOD_RALT = 0x14, MOD_RGUI = 0x18,
+};
+enum {
+  MOD_BIT_LCTRL = 0x01, MOD_BIT_LSHIFT = 0x02, MOD_BIT_LALT = 0x04,
+  MOD_BIT_LGUI = 0x08, MOD_BIT_RCTRL = 0x10, MOD_BIT_RSHIFT = 0x20,
+  MOD_BIT_RALT = 0x40, MOD_BIT_RGUI = 0x80,
+};
+#define MOD_BIT(code) (1 << ((code) & 0x07))
+#define MOD_MASK_CTRL (MOD_BIT_LCTRL | MOD_BIT_RCTRL)
+#define MOD_MASK_GUI (MOD_BIT_LGUI | MOD_BIT_RGUI)
+#define MOD_MASK_CG (MOD_MASK_CTRL | MOD_MASK_GUI)
+
+// Keycodes.
+// clang-format off
+enum {
+  KC_NO = 0x00,
+  KC_A = 0x04, KC_B, KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J, KC_K,
+  KC_L, KC_M, KC_N, KC_O, KC_P, KC_Q, KC_R, KC_S, KC_T, KC_U, KC_V, KC_W,
+  KC_X, KC_Y, KC_Z,
+  KC_ENT = 0x28, KC_ESC, KC_BSPC, KC_TAB, KC_SPC,
+  KC_QUOT = 0x34, KC_GRV, KC_COMM, KC_DOT,
+  KC_LCTL = 0xE0, KC_LSFT, KC_LALT, KC_LGUI, KC_RCTL, KC_RSFT, KC_RALT,
+  KC_RGUI,
+};
+// Mouse keys.
+enum {
+  MS_UP = 0xCD, MS_DOWN, MS_LEFT, MS_RGHT, MS_BTN1, MS_BTN2, MS_BTN3, MS_BTN4,
+  MS_BTN5, MS_BTN6, MS_BTN7, MS_BTN8, MS_WHLU, MS_WHLD, MS_WHLL, MS_WHLR,
+  MS_ACL0, MS_ACL1, MS_ACL2,
+};
+// clang-format on
+#define KC_MS_BTN1 MS_BTN1
+#define IS_MOUSE_KEYCODE(kc) ((kc) >= MS_UP && (kc) <= MS_ACL2)
+#define KC_COMMA KC_COMM
+#define KC_QUOTE KC_QUOT
+#define KC_SPACE KC_SPC
+
+#define QK_USER 0x7E40
+#define QK_USER_MAX 0x7FFF
+#define SAFE_RANGE QK_USER
+#define QK_UNICODE 0x8000
+#define QK_UNICODE_MAX 0xFFFF
+#define UC(c) (QK_UNICODE | (c))
+
+#define QK_MOD_TAP 0x2000
+#define QK_MOD_TAP_MAX 0x3FFF
+#define QK_LAYER_TAP 0x4000
+#define QK_LAYER_TAP_MAX 0x4FFF
+#define IS_QK_MOD_TAP(kc) ((kc) >= QK_MOD_TAP && (kc) <= QK_MOD_TAP_MAX)
+#define IS_QK_LAYER_TAP(kc) ((kc) >= QK_LAYER_TAP && (kc) <= QK_LAYER_TAP_MAX)
+#define QK_MOD_TAP_GET_MODS(kc) (((kc) >> 8) & 0x1F)
+#define QK_MOD_TAP_GET_TAP_KEYCODE(kc) ((kc) & 0xFF)
+#define QK_LAYER_TAP_GET_LAYER(kc) (((kc) >> 8) & 0xF)
+#define QK_LAYER_TAP_GET_TAP_KEYCODE(kc) ((kc) & 0xFF)
+#define MT(mod, kc) (QK_MOD_TAP | (((mod) & 0x1F) << 8) | ((kc) & 0xFF))
+#define LT(layer, kc) (QK_LAYER_TAP | (((layer) & 0xF) << 8) | ((kc) & 0xFF))
+#define LSFT_T(kc) MT(MOD_LSFT, kc)
+#define LCTL_T(kc) MT(MOD_LCTL, kc)
+#define LALT_T(kc) MT(MOD_LALT, kc)
+#define RSFT_T(kc) MT(MOD_RSFT, kc)
+
+#ifdef __cplusplus
+}
+#endif
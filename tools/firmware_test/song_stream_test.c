@@ -0,0 +1,89 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file song_stream_test.c
+ * @brief Plays a compact song with Song Stream and checks every tone.
+ *
+ * The song is the compact encoding of REPEATING_SONG_CODE from
+ * tools/qmk_song_player/song_test.ts, as pinned there by "compact song
+ * encoding", with repeats and ties. The tones the firmware player starts and
+ * stops are checked against the notes of the `float` song: each note starts
+ * when QMK would start it, at the sum of the preceding durations from
+ * `audio_duration_to_ms()`, and its tone stops SONG_STREAM_NOTE_GAP_MS before
+ * the next note, so that the repeated C5 notes are separate.
+ */
+
+#include <math.h>
+
+#include "qmk_host.h"
+#include "song_stream.h"
+
+enum { E4 = 52, G4 = 55, A4 = 57, C5 = 60, B3 = 47 };
+
+static const uint8_t song[] PROGMEM = {
+    SONG_NOTE(E4, 8), SONG_NOTE(G4, 8), SONG_REPEAT(2, 2),
+    SONG_REST(4),
+    SONG_NOTE(A4, 255), SONG_TIE(255), SONG_TIE(90),
+    SONG_NOTE(C5, 16), SONG_REPEAT(1, 2),
+    SONG_NOTE(B3, 255), SONG_TIE(45),
+    SONG_NOTE(E4, 8), SONG_NOTE(G4, 8),
+};
+
+// The notes of the `float` song, as [pitch, duration].
+static const uint16_t expected_notes[][2] = {
+    {E4, 8},  {G4, 8},  {E4, 8},  {G4, 8},  {E4, 8},
+    {G4, 8},  {SONG_PITCH_REST, 4}, {A4, 600}, {C5, 16}, {C5, 16},
+    {C5, 16}, {B3, 300}, {E4, 8},  {G4, 8},
+};
+#define NUM_NOTES (sizeof(expected_notes) / sizeof(*expected_notes))
+
+static void check_song(uint8_t tempo) {
+  host_reset(1000);
+  audio_set_tempo(tempo);
+  song_stream_play(song, sizeof(song));
+  for (int ms = 0; song_stream_is_playing(); ++ms) {
+    CHECK(ms < 60000);
+    host_advance(1);
+    host_deferred_exec_task();
+  }
+  CHECK(host_num_tones <= HOST_MAX_TONES);
+
+  uint32_t onset = 1000;
+  int i = 0;
+  for (size_t k = 0; k < NUM_NOTES; ++k) {
+    const uint8_t pitch = expected_notes[k][0];
+    const uint16_t ms = audio_duration_to_ms(expected_notes[k][1]);
+    if (pitch != SONG_PITCH_REST) {
+      const float hz = 440.0f * powf(2.0f, (pitch - 57) / 12.0f);
+      const uint32_t end = onset + ms - SONG_STREAM_NOTE_GAP_MS;
+      CHECK(i + 1 < host_num_tones);
+      CHECK(host_tones[i].on && host_tones[i].time == onset);
+      CHECK(fabsf(host_tones[i].hz - hz) < hz * 1e-3f);
+      CHECK(!host_tones[i + 1].on && host_tones[i + 1].time == end);
+      i += 2;
+    }
+    onset += ms;
+  }
+  CHECK(i == host_num_tones);
+}
+
+int main(void) {
+  const uint8_t tempos[] = {120, 97, 255};
+  for (size_t i = 0; i < sizeof(tempos); ++i) {
+    check_song(tempos[i]);
+  }
+  printf("song_stream_test: PASS\n");
+  return 0;
+}
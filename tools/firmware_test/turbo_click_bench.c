@@ -0,0 +1,112 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file turbo_click_bench.c
+ * @brief Click rate and jitter of Mouse Turbo Click under main loop stalls.
+ *
+ * Holds the Turbo Click key for 60 s of simulated time. The main loop is
+ * emulated on a 1 ms tick, where each pass runs the deferred execution
+ * callbacks that are due. A given percentage of passes instead stall for a
+ * random 1 ms up to a maximum, as a macro or an RGB frame would. For each
+ * scenario, prints the clicks per second, the mean click period, and the rms
+ * and max deviation of the periods from the configured one.
+ *
+ * The rate is set at build time: the Makefile builds this with
+ * `MOUSE_TURBO_CLICK_PERIOD=80` as turbo_click_bench, and with
+ * `MOUSE_TURBO_CLICK_CPS=30` as turbo_click_bench_cps30. Run both with
+ *
+ *   make -C tools/firmware_test bench
+ *
+ * To measure another version of mouse_turbo_click.c, such as the one before
+ * edges were scheduled against absolute deadlines, pass it as TURBO_CLICK_C:
+ *
+ *   git show 69e10f5^:features/mouse_turbo_click.c > /tmp/turbo_click_old.c
+ *   make -C tools/firmware_test -B turbo_click_bench \
+ *       TURBO_CLICK_C=/tmp/turbo_click_old.c
+ *   tools/firmware_test/turbo_click_bench
+ */
+
+#include <math.h>
+
+#include "mouse_turbo_click.h"
+#include "qmk_host.h"
+
+#ifdef MOUSE_TURBO_CLICK_CPS
+#define IDEAL_PERIOD_MS (1000.0 / (MOUSE_TURBO_CLICK_CPS))
+#else
+#define IDEAL_PERIOD_MS ((double)(MOUSE_TURBO_CLICK_PERIOD))
+#endif  // MOUSE_TURBO_CLICK_CPS
+
+enum {
+  TURBO = SAFE_RANGE,
+  DURATION_MS = 60000,
+};
+
+static void press(bool pressed) {
+  keyrecord_t record = {0};
+  record.event.pressed = pressed;
+  record.event.time = timer_read();
+  process_mouse_turbo_click(TURBO, &record, TURBO);
+}
+
+static void run(int stall_percent, int stall_max_ms) {
+  srand(1);
+  host_reset(1000);
+  press(true);
+  for (uint32_t t = 0; t < DURATION_MS;) {
+    host_deferred_exec_task();
+    const uint32_t step = (rand() % 100 < stall_percent)
+                              ? 1 + rand() % stall_max_ms
+                              : 1;
+    host_advance(step);
+    t += step;
+  }
+  press(false);
+  CHECK(host_num_reports <= HOST_MAX_REPORTS);
+
+  // Each click is a report with the button pressed.
+  uint32_t click_times[HOST_MAX_REPORTS];
+  int clicks = 0;
+  for (int i = 0; i < host_num_reports; ++i) {
+    if (host_reports[i].keys[0] == MS_BTN1) {
+      click_times[clicks++] = host_reports[i].time;
+    }
+  }
+  CHECK(clicks > 1);
+
+  double sum_sq = 0.0;
+  double max_dev = 0.0;
+  for (int k = 1; k < clicks; ++k) {
+    const double dev = (click_times[k] - click_times[k - 1]) - IDEAL_PERIOD_MS;
+    sum_sq += dev * dev;
+    if (fabs(dev) > max_dev) { max_dev = fabs(dev); }
+  }
+  printf("stalls %2d%% x 1-%2d ms: %.3f cps, period mean %.3f ms, "
+         "rms jitter %.2f ms, max %.0f ms\n",
+         stall_percent, stall_max_ms, clicks / (DURATION_MS / 1000.0),
+         (double)(click_times[clicks - 1] - click_times[0]) / (clicks - 1),
+         sqrt(sum_sq / (clicks - 1)), max_dev);
+}
+
+int main(void) {
+#ifdef MOUSE_TURBO_CLICK_CPS
+  printf("turbo_click_bench, %d cps:\n", MOUSE_TURBO_CLICK_CPS);
+#else
+  printf("turbo_click_bench, period %d ms:\n", MOUSE_TURBO_CLICK_PERIOD);
+#endif  // MOUSE_TURBO_CLICK_CPS
+  run(5, 12);
+  run(10, 3);
+  return 0;
+}
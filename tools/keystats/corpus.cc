@@ -0,0 +1,127 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "corpus.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+namespace keystats {
+namespace {
+
+constexpr size_t kShardSize = size_t{4} << 20;  // 4 MiB.
+
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& file_name) {
+    const int fd = open(file_name.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+      std::fprintf(stderr, "Error: Can't read %s: %s\n", file_name.c_str(),
+                   std::strerror(errno));
+      std::exit(1);
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+      void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        std::fprintf(stderr, "Error: Can't map %s: %s\n", file_name.c_str(),
+                     std::strerror(errno));
+        std::exit(1);
+      }
+      madvise(data, size_, MADV_SEQUENTIAL);
+      data_ = static_cast<const char*>(data);
+    }
+    close(fd);
+  }
+
+  ~MappedFile() {
+    if (data_) {
+      munmap(const_cast<char*>(data_), size_);
+    }
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace
+
+int DefaultNumThreads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ForEachShard(const std::vector<std::string>& file_names, int num_threads,
+                  const std::function<void(const Shard&, int)>& fn) {
+  std::vector<std::unique_ptr<MappedFile>> files;
+  std::vector<Shard> shards;
+  for (size_t i = 0; i < file_names.size(); ++i) {
+    files.push_back(std::make_unique<MappedFile>(file_names[i]));
+    const char* data = files.back()->data();
+    const size_t size = files.back()->size();
+    for (size_t offset = 0; offset < size; offset += kShardSize) {
+      shards.push_back({data + offset, data + std::min(size, offset + kShardSize),
+                        data + size, static_cast<int>(i)});
+    }
+  }
+
+  std::atomic<size_t> next_shard{0};
+  auto worker = [&](int thread) {
+    for (size_t i; (i = next_shard++) < shards.size();) {
+      fn(shards[i], thread);
+    }
+  };
+
+  num_threads = std::max(1, num_threads);
+  std::vector<std::thread> threads;
+  for (int thread = 1; thread < num_threads; ++thread) {
+    threads.emplace_back(worker, thread);
+  }
+  worker(0);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+bool ParseOption(const std::string& arg, std::string* name,
+                 std::string* value) {
+  if (arg.size() < 3 || arg.compare(0, 2, "--") != 0) {
+    return false;
+  }
+  const size_t eq = arg.find('=');
+  *name = arg.substr(0, eq);
+  *value = (eq == std::string::npos) ? "" : arg.substr(eq + 1);
+  return true;
+}
+
+}  // namespace keystats
@@ -0,0 +1,64 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file corpus.h
+ * @brief Memory-mapped text corpora, processed in parallel shards.
+ *
+ * Corpus files are memory mapped and split into shards of a few megabytes,
+ * which are handed out to worker threads. A shard is the range [begin, end) of
+ * a file, but the worker may read past `end` up to `limit`, the end of the
+ * file. This way, a worker counting n-grams that *start* in its shard sees each
+ * n-gram whole, and the per-thread counts sum exactly to the whole-file counts.
+ *
+ * Typical use, with per-thread state merged at the end:
+ *
+ *     std::vector<Counts> counts(num_threads);
+ *     ForEachShard(file_names, num_threads,
+ *                  [&](const Shard& shard, int thread) {
+ *                    Count(shard, &counts[thread]);
+ *                  });
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace keystats {
+
+struct Shard {
+  const char* begin;
+  const char* end;
+  const char* limit;  // End of the file, limit for reading past `end`.
+  int file_index;
+};
+
+/** Gets the default number of worker threads, the hardware concurrency. */
+int DefaultNumThreads();
+
+/**
+ * Calls `fn(shard, thread)` for every shard of the files `file_names`, using
+ * `num_threads` threads. `thread` is the index of the calling thread, in
+ * [0, num_threads). Exits with an error message if a file can't be read.
+ */
+void ForEachShard(const std::vector<std::string>& file_names, int num_threads,
+                  const std::function<void(const Shard&, int)>& fn);
+
+/** Parses a command line option of the form "--name=value". */
+bool ParseOption(const std::string& arg, std::string* name, std::string* value);
+
+}  // namespace keystats
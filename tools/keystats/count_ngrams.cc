@@ -0,0 +1,349 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file count_ngrams.cc
+ * @brief Counts char and n-gram frequencies, and keystroke costs on a keymap.
+ *
+ * This replaces count_chars.py. Besides single chars, it counts bigrams,
+ * trigrams, skipgrams (chars two apart), and symbol pairs. Given a keymap, it
+ * computes same-finger bigrams and skipgrams, layer switches, and keystrokes
+ * per char from the n-gram counts.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "corpus.h"
+#include "keymap.h"
+#include "ngrams.h"
+
+namespace keystats {
+namespace {
+
+constexpr char kHelpText[] = R"(Count char and n-gram frequencies.
+Use: count_ngrams [options] file [file2 ...]
+
+Reads the specified files and counts how often each char, bigram, trigram,
+skipgram (two chars with one in between), and pair of symbols occurs. Letters
+are counted as lowercase. Non-ASCII and control chars other than newline and
+tab are not counted and break n-grams.
+
+Options:
+  --chars   Which chars to display results for in the chars table:
+            --chars=symbols          Only symbols !"#$%& etc.
+            --chars=digits           Only digits 0123456789
+            --chars=letters          Only letters a-z
+            --chars=symbols+digits   Symbols and digits (default)
+            --chars=all              All characters
+  --tables  Comma-separated list of tables to print, from chars, bigrams,
+            trigrams, skipgrams, symbol_pairs. Default all.
+  --top     Number of rows to print in n-gram tables, default 40.
+  --keymap  Path of a keymap.c, like
+            keyboards/zsa/voyager/keymaps/getreuer/keymap.c. If specified,
+            prints same-finger bigrams, layer switches, and keystrokes per
+            char typing the files on the keymap.
+  --layer   Name of the base layer, default the first layer.
+  --threads Number of threads, default the number of cores.
+)";
+
+constexpr char kSymbols[] = "!\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~";
+
+bool IsSymbol(char c) {
+  return c != '\0' && std::string(kSymbols).find(c) != std::string::npos;
+}
+
+struct Counts {
+  Counts() : chars(1), bigrams(2), trigrams(3), skipgrams(2) {}
+
+  void Merge(const Counts& other) {
+    chars.Merge(other.chars);
+    bigrams.Merge(other.bigrams);
+    trigrams.Merge(other.trigrams);
+    skipgrams.Merge(other.skipgrams);
+  }
+
+  NgramTable chars;
+  NgramTable bigrams;
+  NgramTable trigrams;
+  NgramTable skipgrams;  // Chars i and i + 2, keyed as a bigram.
+};
+
+void CountShard(const Shard& shard, Counts* counts) {
+  // Symbols at p, p + 1, p + 2, where p + 1 and p + 2 may be past the shard's
+  // end but within the file.
+  auto symbol_at = [&](const char* p) -> uint8_t {
+    return (p < shard.limit) ? Symbol(*p) : 0;
+  };
+  uint8_t c1 = symbol_at(shard.begin);
+  uint8_t c2 = symbol_at(shard.begin + 1);
+  for (const char* p = shard.begin; p < shard.end; ++p) {
+    const uint8_t c0 = c1;
+    c1 = c2;
+    c2 = symbol_at(p + 2);
+    if (!c0) { continue; }
+
+    counts->chars.Add(c0);
+    if (c1) {
+      counts->bigrams.Add(c0 << 7 | c1);
+      if (c2) {
+        counts->trigrams.Add(c0 << 14 | c1 << 7 | c2);
+        counts->skipgrams.Add(c0 << 7 | c2);
+      }
+    }
+  }
+}
+
+// Prints the top n-grams of `table`, optionally only those accepted by
+// `filter`.
+template <typename Filter>
+void PrintTable(const char* title, const NgramTable& table, size_t top,
+                Filter filter) {
+  std::vector<std::pair<uint64_t, uint32_t>> ranked;
+  uint64_t total = 0;
+  table.ForEach([&](uint32_t key, uint64_t count) {
+    total += count;
+    if (filter(Unpack(key, table.n()))) { ranked.push_back({count, key}); }
+  });
+  std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+    return a.first > b.first || (a.first == b.first && a.second < b.second);
+  });
+  if (top > 0 && ranked.size() > top) { ranked.resize(top); }
+
+  std::printf("%s\nRank  %7s %8s %8s\n", title,
+              (table.n() == 1) ? "char" : "ngram", "count", "%");
+  for (size_t i = 0; i < ranked.size(); ++i) {
+    const double percent = (100.0 / total) * ranked[i].first;
+    std::printf("#%-4zu %7s %8llu %8.3f\n", i + 1,
+                FormatNgram(Unpack(ranked[i].second, table.n())).c_str(),
+                static_cast<unsigned long long>(ranked[i].first), percent);
+  }
+  std::printf("\ntotal: %llu\n\n", static_cast<unsigned long long>(total));
+}
+
+// Parses the `--chars` command line option, returning false if invalid.
+bool ParseCharsOption(const std::string& value, std::string* chars) {
+  chars->clear();
+  size_t start = 0;
+  while (start <= value.size()) {
+    const size_t end = std::min(value.find('+', start), value.size());
+    const std::string name = value.substr(start, end - start);
+    if (name == "symbols") {
+      *chars += kSymbols;
+    } else if (name == "digits") {
+      *chars += "0123456789";
+    } else if (name == "letters") {
+      *chars += "abcdefghijklmnopqrstuvwxyz";
+    } else {
+      std::printf("Invalid char set: %s\n", name.c_str());
+      return false;
+    }
+    start = end + 1;
+  }
+  return true;
+}
+
+// Prints keystroke costs of typing the counted text on `keymap`.
+void PrintKeymapStats(const Keymap& keymap, int base_layer,
+                      const Counts& counts) {
+  Keymap::Stroke strokes[128];
+  bool typeable[128] = {false};
+  for (int c = 1; c < 128; ++c) {
+    typeable[c] = keymap.FindStroke(base_layer, static_cast<char>(c),
+                                    &strokes[c]);
+  }
+  auto finger = [&](int c) { return keymap.position(strokes[c].key).finger; };
+  // Whether chars a and b are typed with the same finger on different keys.
+  auto same_finger = [&](int a, int b) {
+    return typeable[a] && typeable[b] && strokes[a].key != strokes[b].key &&
+           finger(a) == finger(b);
+  };
+
+  uint64_t total_chars = 0;
+  uint64_t untypeable = 0;
+  uint64_t keystrokes = 0;
+  std::vector<uint64_t> finger_load(kNumFingers);
+  std::vector<uint64_t> layer_chars(keymap.num_layers());
+  counts.chars.ForEach([&](uint32_t c, uint64_t count) {
+    total_chars += count;
+    if (!typeable[c]) {
+      untypeable += count;
+      return;
+    }
+    keystrokes += count * (1 + strokes[c].shift + (strokes[c].layer_key >= 0));
+    finger_load[finger(c)] += count;
+    layer_chars[strokes[c].layer] += count;
+  });
+
+  uint64_t total_bigrams = 0;
+  uint64_t sfbs = 0;
+  uint64_t layer_switches = 0;
+  counts.bigrams.ForEach([&](uint32_t key, uint64_t count) {
+    const int a = key >> 7;
+    const int b = key & 0x7f;
+    total_bigrams += count;
+    if (same_finger(a, b)) { sfbs += count; }
+    if (typeable[a] && typeable[b] && strokes[a].layer != strokes[b].layer) {
+      layer_switches += count;
+    }
+  });
+  uint64_t total_skipgrams = 0;
+  uint64_t sfss = 0;
+  counts.skipgrams.ForEach([&](uint32_t key, uint64_t count) {
+    total_skipgrams += count;
+    if (same_finger(key >> 7, key & 0x7f)) { sfss += count; }
+  });
+
+  auto percent = [](uint64_t part, uint64_t whole) {
+    return whole ? (100.0 * part) / whole : 0.0;
+  };
+  std::printf("Keymap stats, base layer %s\n",
+              keymap.layer_name(base_layer).c_str());
+  std::printf("keystrokes per char:    %8.3f\n",
+              total_chars ? static_cast<double>(keystrokes) / total_chars
+                          : 0.0);
+  std::printf("same-finger bigrams:    %8.3f%%\n", percent(sfbs, total_bigrams));
+  std::printf("same-finger skipgrams:  %8.3f%%\n",
+              percent(sfss, total_skipgrams));
+  std::printf("layer switches:         %8.3f%% of bigrams\n",
+              percent(layer_switches, total_bigrams));
+  std::printf("untypeable chars:       %8.3f%%\n\n",
+              percent(untypeable, total_chars));
+
+  std::printf("Layer          chars        %%\n");
+  for (int layer = 0; layer < keymap.num_layers(); ++layer) {
+    if (layer_chars[layer]) {
+      std::printf("%-10s %9llu %8.3f\n", keymap.layer_name(layer).c_str(),
+                  static_cast<unsigned long long>(layer_chars[layer]),
+                  percent(layer_chars[layer], total_chars));
+    }
+  }
+  std::printf("\nFinger         chars        %%\n");
+  for (int f = 0; f < kNumFingers; ++f) {
+    std::printf("%-10s %9llu %8.3f\n", FingerName(f),
+                static_cast<unsigned long long>(finger_load[f]),
+                percent(finger_load[f], total_chars));
+  }
+  std::printf("\n");
+}
+
+int Main(int argc, char** argv) {
+  std::string chars;
+  ParseCharsOption("symbols+digits", &chars);
+  std::set<std::string> tables = {"chars", "bigrams", "trigrams",
+                                  "skipgrams", "symbol_pairs"};
+  size_t top = 40;
+  std::string keymap_file;
+  std::string layer_name;
+  int num_threads = DefaultNumThreads();
+  std::vector<std::string> input_file_names;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string name, value;
+    if (!ParseOption(argv[i], &name, &value)) {
+      input_file_names.push_back(argv[i]);
+    } else if (name == "--chars") {
+      if (value == "all") {
+        chars.clear();
+      } else if (!ParseCharsOption(value, &chars)) {
+        return 1;
+      }
+    } else if (name == "--tables") {
+      tables.clear();
+      for (size_t start = 0; start <= value.size();) {
+        const size_t end = std::min(value.find(',', start), value.size());
+        tables.insert(value.substr(start, end - start));
+        start = end + 1;
+      }
+    } else if (name == "--top") {
+      top = std::atoi(value.c_str());
+    } else if (name == "--keymap") {
+      keymap_file = value;
+    } else if (name == "--layer") {
+      layer_name = value;
+    } else if (name == "--threads") {
+      num_threads = std::atoi(value.c_str());
+    } else {
+      std::printf("Invalid option: %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  if (input_file_names.empty()) {  // No input given; show help text and exit.
+    std::printf("%s", kHelpText);
+    return 1;
+  }
+
+  Keymap keymap;
+  int layer = 0;
+  if (!keymap_file.empty()) {
+    std::string error;
+    if (!keymap.Load(keymap_file, &error)) {
+      std::printf("Error: %s\n", error.c_str());
+      return 1;
+    }
+    layer = layer_name.empty() ? 0 : keymap.FindLayer(layer_name);
+    if (layer < 0) {
+      std::printf("Error: No layer %s in %s\n", layer_name.c_str(),
+                  keymap_file.c_str());
+      return 1;
+    }
+  }
+
+  num_threads = std::max(1, num_threads);
+  std::vector<Counts> counts(num_threads);
+  ForEachShard(input_file_names, num_threads,
+               [&](const Shard& shard, int thread) {
+                 CountShard(shard, &counts[thread]);
+               });
+  for (int thread = 1; thread < num_threads; ++thread) {
+    counts[0].Merge(counts[thread]);
+  }
+
+  if (tables.count("chars")) {
+    PrintTable("Chars", counts[0].chars, 0, [&](const std::string& s) {
+      return chars.empty() || chars.find(s[0]) != std::string::npos;
+    });
+  }
+  const auto all = [](const std::string&) { return true; };
+  if (tables.count("bigrams")) {
+    PrintTable("Bigrams", counts[0].bigrams, top, all);
+  }
+  if (tables.count("trigrams")) {
+    PrintTable("Trigrams", counts[0].trigrams, top, all);
+  }
+  if (tables.count("skipgrams")) {
+    PrintTable("Skipgrams", counts[0].skipgrams, top, all);
+  }
+  if (tables.count("symbol_pairs")) {
+    PrintTable("Symbol pairs", counts[0].bigrams, top,
+               [](const std::string& s) {
+                 return IsSymbol(s[0]) && IsSymbol(s[1]);
+               });
+  }
+  if (!keymap_file.empty()) {
+    PrintKeymapStats(keymap, layer, counts[0]);
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace keystats
+
+int main(int argc, char** argv) { return keystats::Main(argc, argv); }
@@ -0,0 +1,157 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "keycodes.h"
+
+#include <cctype>
+
+namespace keystats {
+namespace {
+
+struct BasicKey {
+  const char* name;
+  char base;
+  char shifted;
+  const char* shifted_name;  // Shifted alias, or nullptr.
+};
+
+// Basic keys that type chars, in the order of their HID usage codes.
+constexpr BasicKey kBasicKeys[] = {
+    {"KC_1", '1', '!', "KC_EXLM"},   {"KC_2", '2', '@', "KC_AT"},
+    {"KC_3", '3', '#', "KC_HASH"},   {"KC_4", '4', '$', "KC_DLR"},
+    {"KC_5", '5', '%', "KC_PERC"},   {"KC_6", '6', '^', "KC_CIRC"},
+    {"KC_7", '7', '&', "KC_AMPR"},   {"KC_8", '8', '*', "KC_ASTR"},
+    {"KC_9", '9', '(', "KC_LPRN"},   {"KC_0", '0', ')', "KC_RPRN"},
+    {"KC_ENT", '\n', '\n', nullptr}, {"KC_TAB", '\t', '\t', nullptr},
+    {"KC_SPC", ' ', ' ', nullptr},   {"KC_MINS", '-', '_', "KC_UNDS"},
+    {"KC_EQL", '=', '+', "KC_PLUS"}, {"KC_LBRC", '[', '{', "KC_LCBR"},
+    {"KC_RBRC", ']', '}', "KC_RCBR"}, {"KC_BSLS", '\\', '|', "KC_PIPE"},
+    {"KC_SCLN", ';', ':', "KC_COLN"}, {"KC_QUOT", '\'', '"', "KC_DQUO"},
+    {"KC_GRV", '`', '~', "KC_TILD"}, {"KC_COMM", ',', '<', "KC_LABK"},
+    {"KC_DOT", '.', '>', "KC_RABK"}, {"KC_SLSH", '/', '?', "KC_QUES"},
+};
+
+// Long names and other aliases of basic keys.
+constexpr const char* kAliases[][2] = {
+    {"KC_ENTER", "KC_ENT"},        {"KC_SPACE", "KC_SPC"},
+    {"KC_MINUS", "KC_MINS"},       {"KC_EQUAL", "KC_EQL"},
+    {"KC_LEFT_BRACKET", "KC_LBRC"}, {"KC_RIGHT_BRACKET", "KC_RBRC"},
+    {"KC_BACKSLASH", "KC_BSLS"},   {"KC_SEMICOLON", "KC_SCLN"},
+    {"KC_QUOTE", "KC_QUOT"},       {"KC_GRAVE", "KC_GRV"},
+    {"KC_COMMA", "KC_COMM"},       {"KC_SLASH", "KC_SLSH"},
+    {"KC_KP_1", "KC_1"},           {"KC_KP_2", "KC_2"},
+    {"KC_KP_3", "KC_3"},           {"KC_KP_4", "KC_4"},
+    {"KC_KP_5", "KC_5"},           {"KC_KP_6", "KC_6"},
+    {"KC_KP_7", "KC_7"},           {"KC_KP_8", "KC_8"},
+    {"KC_KP_9", "KC_9"},           {"KC_KP_0", "KC_0"},
+    {"KC_KP_DOT", "KC_DOT"},       {"KC_KP_SLASH", "KC_SLSH"},
+    {"KC_KP_MINUS", "KC_MINS"},    {"KC_KP_ENTER", "KC_ENT"},
+    {"KC_KP_EQUAL", "KC_EQL"},     {"KC_PSLS", "KC_SLSH"},
+    {"KC_PMNS", "KC_MINS"},        {"KC_PDOT", "KC_DOT"},
+};
+
+// Keypad keys typing a shifted char on the main block.
+constexpr const char* kShiftedAliases[][2] = {
+    {"KC_KP_PLUS", "KC_PLUS"},     {"KC_PPLS", "KC_PLUS"},
+    {"KC_KP_ASTERISK", "KC_ASTR"}, {"KC_PAST", "KC_ASTR"},
+    {"KC_EXCLAIM", "KC_EXLM"},     {"KC_DOUBLE_QUOTE", "KC_DQUO"},
+    {"KC_UNDERSCORE", "KC_UNDS"},  {"KC_QUESTION", "KC_QUES"},
+};
+
+}  // namespace
+
+bool ResolveBasicKeycode(std::string_view name, std::string* basic,
+                         bool* shifted) {
+  // Letters KC_A through KC_Z.
+  if (name.size() == 4 && name.substr(0, 3) == "KC_" &&
+      'A' <= name[3] && name[3] <= 'Z') {
+    *basic = std::string(name);
+    *shifted = false;
+    return true;
+  }
+
+  for (const auto& alias : kAliases) {
+    if (name == alias[0]) {
+      name = alias[1];
+      break;
+    }
+  }
+  for (const auto& alias : kShiftedAliases) {
+    if (name == alias[0]) {
+      name = alias[1];
+      break;
+    }
+  }
+
+  for (const BasicKey& key : kBasicKeys) {
+    if (name == key.name) {
+      *basic = key.name;
+      *shifted = false;
+      return true;
+    } else if (key.shifted_name && name == key.shifted_name) {
+      *basic = key.name;
+      *shifted = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+char KeycodeChar(std::string_view basic, bool shifted) {
+  if (basic.size() == 4 && basic.substr(0, 3) == "KC_" &&
+      'A' <= basic[3] && basic[3] <= 'Z') {
+    return shifted ? basic[3] : std::tolower(basic[3]);
+  }
+  for (const BasicKey& key : kBasicKeys) {
+    if (basic == key.name) {
+      return shifted ? key.shifted : key.base;
+    }
+  }
+  return '\0';
+}
+
+bool CharKeycode(char c, std::string* basic, bool* shifted) {
+  if (std::isalpha(static_cast<unsigned char>(c))) {
+    *basic = std::string("KC_") +
+             static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    *shifted = std::isupper(static_cast<unsigned char>(c));
+    return true;
+  }
+  for (const BasicKey& key : kBasicKeys) {
+    if (c == key.base || c == key.shifted) {
+      *basic = key.name;
+      *shifted = (c != key.base);
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string CharKeycodeExpr(char c) {
+  std::string basic;
+  bool shifted;
+  if (!CharKeycode(c, &basic, &shifted)) {
+    return "";
+  } else if (!shifted) {
+    return basic;
+  }
+  for (const BasicKey& key : kBasicKeys) {
+    if (basic == key.name && key.shifted_name) {
+      return key.shifted_name;
+    }
+  }
+  return "S(" + basic + ")";
+}
+
+}  // namespace keystats
@@ -0,0 +1,56 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file keycodes.h
+ * @brief Mapping between QMK basic keycode names and the chars they type.
+ *
+ * Chars are as typed on a US layout. Shifted aliases like KC_EXLM are resolved
+ * to their basic keycode with Shift.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace keystats {
+
+/**
+ * Resolves basic keycode `name`, e.g. "KC_A" or "KC_EXLM", to its canonical
+ * basic keycode name and whether it implies Shift. Returns false if `name` is
+ * not a known basic keycode that types a char.
+ */
+bool ResolveBasicKeycode(std::string_view name, std::string* basic,
+                         bool* shifted);
+
+/**
+ * Gets the char typed by canonical basic keycode `basic`, optionally with
+ * Shift. Returns '\0' if the key does not type a char.
+ */
+char KeycodeChar(std::string_view basic, bool shifted);
+
+/**
+ * Finds the canonical basic keycode that types `c` and whether it needs Shift.
+ * Returns false if no key types `c`.
+ */
+bool CharKeycode(char c, std::string* basic, bool* shifted);
+
+/**
+ * Gets a keycode expression typing `c`, like "KC_A" or "S(KC_1)", or an empty
+ * string if no key types `c`.
+ */
+std::string CharKeycodeExpr(char c);
+
+}  // namespace keystats
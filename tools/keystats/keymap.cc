@@ -0,0 +1,588 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "keymap.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <regex>
+#include <sstream>
+
+#include "keycodes.h"
+
+namespace keystats {
+namespace {
+
+constexpr int kVoyagerNumKeys = 52;
+
+std::string_view Trim(std::string_view s) {
+  while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) {
+    s.remove_prefix(1);
+  }
+  while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) {
+    s.remove_suffix(1);
+  }
+  return s;
+}
+
+bool IsIdentifier(std::string_view s) {
+  if (s.empty() || std::isdigit(static_cast<unsigned char>(s[0]))) {
+    return false;
+  }
+  return std::all_of(s.begin(), s.end(), [](char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+  });
+}
+
+// Replaces comments with spaces, keeping newlines and string literals.
+std::string StripComments(const std::string& text) {
+  std::string result;
+  result.reserve(text.size());
+  for (size_t i = 0; i < text.size(); ++i) {
+    const char c = text[i];
+    if (c == '"' || c == '\'') {  // String or char literal.
+      const size_t start = i;
+      for (++i; i < text.size() && text[i] != c && text[i] != '\n'; ++i) {
+        if (text[i] == '\\') { ++i; }
+      }
+      result.append(text, start, i - start + 1);
+    } else if (c == '/' && i + 1 < text.size() && text[i + 1] == '/') {
+      while (i + 1 < text.size() && text[i + 1] != '\n') { ++i; }
+    } else if (c == '/' && i + 1 < text.size() && text[i + 1] == '*') {
+      result += ' ';
+      for (i += 2; i + 1 < text.size() &&
+                   !(text[i] == '*' && text[i + 1] == '/'); ++i) {
+        if (text[i] == '\n') { result += '\n'; }
+      }
+      ++i;
+    } else {
+      result += c;
+    }
+  }
+  return result;
+}
+
+// Finds the bracket closing the one at `open`, or npos.
+size_t FindMatching(std::string_view text, size_t open) {
+  int depth = 0;
+  for (size_t i = open; i < text.size(); ++i) {
+    switch (text[i]) {
+      case '"':
+      case '\'': {
+        const char quote = text[i];
+        for (++i; i < text.size() && text[i] != quote; ++i) {
+          if (text[i] == '\\') { ++i; }
+        }
+        break;
+      }
+      case '(': case '[': case '{':
+        ++depth;
+        break;
+      case ')': case ']': case '}':
+        if (--depth == 0) { return i; }
+        break;
+    }
+  }
+  return std::string_view::npos;
+}
+
+// Splits `text` on commas that are not nested in brackets.
+std::vector<std::string> SplitArgs(std::string_view text) {
+  std::vector<std::string> args;
+  size_t start = 0;
+  for (size_t i = 0; i <= text.size(); ++i) {
+    if (i == text.size() || text[i] == ',') {
+      args.emplace_back(Trim(text.substr(start, i - start)));
+      start = i + 1;
+    } else if (text[i] == '(' || text[i] == '[' || text[i] == '{' ||
+               text[i] == '"' || text[i] == '\'') {
+      const size_t close = (text[i] == '"' || text[i] == '\'')
+          ? text.find(text[i], i + 1) : FindMatching(text, i);
+      if (close == std::string_view::npos) { break; }
+      i = close;
+    }
+  }
+  if (args.size() == 1 && args[0].empty()) { args.clear(); }
+  return args;
+}
+
+// Parses mod names like "MOD_LSFT | MOD_LCTL", "LSFT", or "C_S" to mod bits.
+uint8_t ParseMods(std::string_view text) {
+  uint8_t mods = 0;
+  std::string token;
+  auto flush = [&]() {
+    std::string_view t = token;
+    if (t.substr(0, 4) == "MOD_") { t.remove_prefix(4); }
+    if (t.size() == 4 && (t[0] == 'L' || t[0] == 'R')) { t.remove_prefix(1); }
+    if (t == "C" || t == "CTL" || t == "CTRL") {
+      mods |= kModCtrl;
+    } else if (t == "S" || t == "SFT" || t == "SHIFT") {
+      mods |= kModShift;
+    } else if (t == "A" || t == "ALT" || t == "OPT") {
+      mods |= kModAlt;
+    } else if (t == "G" || t == "GUI" || t == "CMD" || t == "WIN") {
+      mods |= kModGui;
+    } else if (t == "MEH") {
+      mods |= kModCtrl | kModShift | kModAlt;
+    } else if (t == "HYPR" || t == "ALL") {
+      mods |= kModCtrl | kModShift | kModAlt | kModGui;
+    }
+    token.clear();
+  };
+  for (char c : text) {
+    if (std::isalnum(static_cast<unsigned char>(c)) ||
+        (c == '_' && token.substr(0, 4) == "MOD")) {
+      token += c;
+    } else {
+      flush();
+    }
+  }
+  flush();
+  return mods;
+}
+
+// Gets the mods applied by a mod wrapper function like S() or LCTL(), or 0.
+uint8_t ModWrapperMods(std::string_view fn) {
+  static const std::map<std::string_view, uint8_t> kWrappers = {
+      {"S", kModShift}, {"LSFT", kModShift}, {"RSFT", kModShift},
+      {"C", kModCtrl},  {"LCTL", kModCtrl},  {"RCTL", kModCtrl},
+      {"A", kModAlt},   {"LALT", kModAlt},   {"RALT", kModAlt},
+      {"LOPT", kModAlt}, {"ROPT", kModAlt},
+      {"G", kModGui},   {"LGUI", kModGui},   {"RGUI", kModGui},
+      {"LCMD", kModGui}, {"RCMD", kModGui},  {"LWIN", kModGui},
+      {"RWIN", kModGui},
+  };
+  const auto it = kWrappers.find(fn);
+  return (it != kWrappers.end()) ? it->second : 0;
+}
+
+// Key positions and fingers of the Voyager's LAYOUT_LR: per hand, 4 rows of 6
+// keys then 2 thumb keys, left hand first.
+std::vector<KeyPosition> VoyagerPositions() {
+  constexpr int kLeftFingers[6] = {kLeftPinky, kLeftPinky, kLeftRing,
+                                   kLeftMiddle, kLeftIndex, kLeftIndex};
+  constexpr int kRightFingers[6] = {kRightIndex, kRightIndex, kRightMiddle,
+                                    kRightRing, kRightPinky, kRightPinky};
+  std::vector<KeyPosition> positions;
+  for (int hand = 0; hand < 2; ++hand) {
+    for (int row = 0; row < 4; ++row) {
+      for (int col = 0; col < 6; ++col) {
+        positions.push_back({row, 6 * hand + col,
+                             hand ? kRightFingers[col] : kLeftFingers[col]});
+      }
+    }
+    for (int col = 0; col < 2; ++col) {
+      positions.push_back({4, hand ? 6 + col : 4 + col,
+                           hand ? kRightThumb : kLeftThumb});
+    }
+  }
+  return positions;
+}
+
+// Finds the opening brace of the initializer of the array declaration matched
+// by `pattern`, like "custom_shift_keys[] = {", or npos.
+size_t FindInitializer(const std::string& source, const char* pattern) {
+  std::smatch match;
+  if (!std::regex_search(source, match, std::regex(pattern))) {
+    return std::string::npos;
+  }
+  return match.position(0) + match.length(0) - 1;
+}
+
+std::string Unescape(std::string_view s) {
+  std::string result;
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (s[i] == '\\' && i + 1 < s.size()) {
+      switch (s[++i]) {
+        case 'n': result += '\n'; break;
+        case 't': result += '\t'; break;
+        default: result += s[i];
+      }
+    } else {
+      result += s[i];
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+const char* FingerName(int finger) {
+  static const char* kNames[kNumFingers] = {
+      "L-pinky", "L-ring",  "L-middle", "L-index", "L-thumb",
+      "R-thumb", "R-index", "R-middle", "R-ring",  "R-pinky",
+  };
+  return (0 <= finger && finger < kNumFingers) ? kNames[finger] : "?";
+}
+
+bool Keymap::Load(const std::string& file_name, std::string* error) {
+  if (!ReadFile(file_name, 0, error)) {
+    return false;
+  }
+  ParseEnums();
+  ParseCustomShiftKeys();
+  ParseMagicStrings();
+  return ParseKeymaps(error);
+}
+
+bool Keymap::ReadFile(const std::string& file_name, int depth,
+                      std::string* error) {
+  if (std::find(files_read_.begin(), files_read_.end(), file_name) !=
+      files_read_.end()) {
+    return true;  // Already read.
+  }
+  std::ifstream file(file_name);
+  if (!file) {
+    *error = "Can't read " + file_name;
+    return false;
+  }
+  files_read_.push_back(file_name);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  std::string text = StripComments(buffer.str());
+
+  // Join continued lines.
+  for (size_t i; (i = text.find("\\\n")) != std::string::npos;) {
+    text.replace(i, 2, " ");
+  }
+
+  const size_t slash = file_name.rfind('/');
+  const std::string dir =
+      (slash == std::string::npos) ? "." : file_name.substr(0, slash);
+
+  std::istringstream lines(text);
+  for (std::string line; std::getline(lines, line);) {
+    std::string_view s = Trim(line);
+    if (s.empty() || s[0] != '#') {
+      source_ += line;
+      source_ += '\n';
+      continue;
+    }
+
+    s = Trim(s.substr(1));
+    if (s.substr(0, 7) == "include") {
+      // Follow `#include "file"`, searching the including file's directory
+      // and its parents, as QMK does for userspace files. Other includes,
+      // like QMK's own headers, are skipped.
+      s = Trim(s.substr(7));
+      if (s.size() < 2 || s[0] != '"') { continue; }
+      const std::string name(s.substr(1, s.find('"', 1) - 1));
+      std::string search = dir;
+      for (int level = 0; level < 6; ++level) {
+        const std::string path = search + "/" + name;
+        if (std::ifstream(path)) {
+          if (!ReadFile(path, depth + 1, error)) { return false; }
+          break;
+        }
+        search += "/..";
+      }
+    } else if (s.substr(0, 6) == "define") {
+      s = Trim(s.substr(6));
+      size_t end = 0;
+      while (end < s.size() && (std::isalnum(static_cast<unsigned char>(s[end]))
+                                || s[end] == '_')) {
+        ++end;
+      }
+      if (end < s.size() && s[end] == '(') { continue; }  // Function-like.
+      defines_[std::string(s.substr(0, end))] = std::string(Trim(s.substr(end)));
+    }
+  }
+  return true;
+}
+
+void Keymap::ParseEnums() {
+  static const std::regex kEnum(R"(\benum\s*\w*\s*\{([^}]*)\})");
+  for (std::sregex_iterator it(source_.begin(), source_.end(), kEnum), end;
+       it != end; ++it) {
+    long value = 0;
+    bool known = true;
+    for (const std::string& item : SplitArgs((*it)[1].str())) {
+      if (item.empty()) { continue; }
+      const size_t eq = item.find('=');
+      const std::string name(Trim(std::string_view(item).substr(0, eq)));
+      if (eq != std::string::npos) {
+        const std::string rhs(Trim(std::string_view(item).substr(eq + 1)));
+        char* parse_end;
+        value = std::strtol(rhs.c_str(), &parse_end, 0);
+        known = !rhs.empty() && *parse_end == '\0';
+      }
+      if (known && IsIdentifier(name)) {
+        enum_values_[name] = static_cast<int>(value);
+      }
+      ++value;
+    }
+  }
+}
+
+bool Keymap::ParseKeymaps(std::string* error) {
+  const size_t open = FindInitializer(
+      source_, R"(\bkeymaps\s*\[\s*\](\s*\[[^\]]*\])*\s*=\s*\{)");
+  const size_t close = (open == std::string::npos)
+                           ? open : FindMatching(source_, open);
+  if (close == std::string::npos) {
+    *error = "Keymap has no keymaps[] array";
+    return false;
+  }
+
+  const std::string_view body =
+      std::string_view(source_).substr(open + 1, close - open - 1);
+  for (size_t i = 0; (i = body.find('[', i)) != std::string_view::npos;) {
+    const size_t name_end = FindMatching(body, i);
+    const size_t args_open = body.find('(', name_end);
+    const size_t args_close = (args_open == std::string_view::npos)
+                                  ? args_open : FindMatching(body, args_open);
+    if (name_end == std::string_view::npos ||
+        args_close == std::string_view::npos) {
+      break;
+    }
+
+    const std::string name(Trim(body.substr(i + 1, name_end - i - 1)));
+    const auto it = enum_values_.find(name);
+    const int layer = (it != enum_values_.end())
+                          ? it->second : static_cast<int>(layers_.size());
+    const std::vector<std::string> args =
+        SplitArgs(body.substr(args_open + 1, args_close - args_open - 1));
+    if (args.size() != kVoyagerNumKeys) {
+      *error = "Layer " + name + " has " + std::to_string(args.size()) +
+               " keys; only the Voyager LAYOUT_LR with " +
+               std::to_string(kVoyagerNumKeys) + " keys is supported";
+      return false;
+    }
+
+    if (layer >= num_layers()) {
+      layers_.resize(layer + 1, std::vector<Keycode>(kVoyagerNumKeys));
+      layer_names_.resize(layer + 1);
+    }
+    layer_names_[layer] = name;
+    for (int key = 0; key < kVoyagerNumKeys; ++key) {
+      layers_[layer][key] = ParseKeycode(args[key]);
+    }
+    i = args_close;
+  }
+
+  if (layers_.empty()) {
+    *error = "Keymap has no layers";
+    return false;
+  }
+  positions_ = VoyagerPositions();
+  return true;
+}
+
+void Keymap::ParseCustomShiftKeys() {
+  const size_t open = FindInitializer(
+      source_, R"(\bcustom_shift_keys\s*\[\s*\]\s*=\s*\{)");
+  const size_t close = (open == std::string::npos)
+                           ? open : FindMatching(source_, open);
+  if (close == std::string::npos) { return; }
+
+  for (const std::string& entry :
+       SplitArgs(std::string_view(source_).substr(open + 1, close - open - 1))) {
+    if (entry.size() < 2 || entry.front() != '{' || entry.back() != '}') {
+      continue;
+    }
+    const std::vector<std::string> pair =
+        SplitArgs(std::string_view(entry).substr(1, entry.size() - 2));
+    if (pair.size() == 2) {
+      const Keycode base = ParseKeycode(pair[0]);
+      if (base.kind == Keycode::Kind::kKey && base.mods == 0) {
+        custom_shift_keys_[base.name] = ParseKeycode(pair[1]);
+      }
+    }
+  }
+}
+
+void Keymap::ParseMagicStrings() {
+  static const std::regex kMagicString(
+      R"re(case\s+(\w+)\s*:\s*MAGIC_STRING\(\s*"((?:[^"\\]|\\.)*)"\s*,\s*(\w+))re");
+  for (std::sregex_iterator it(source_.begin(), source_.end(), kMagicString),
+       end; it != end; ++it) {
+    magic_strings_[(*it)[1].str()] = {Unescape((*it)[2].str()), (*it)[3].str()};
+  }
+}
+
+const std::string* Keymap::FindDefine(std::string_view name) const {
+  const auto it = defines_.find(name);
+  return (it != defines_.end()) ? &it->second : nullptr;
+}
+
+std::string Keymap::Expand(std::string_view expr, int depth) const {
+  expr = Trim(expr);
+  // Strip redundant outer parentheses.
+  while (expr.size() >= 2 && expr.front() == '(' &&
+         FindMatching(expr, 0) == expr.size() - 1) {
+    expr = Trim(expr.substr(1, expr.size() - 2));
+  }
+  if (depth > 16) { return std::string(expr); }
+
+  const size_t paren = expr.find('(');
+  if (paren == std::string_view::npos || expr.back() != ')') {
+    const std::string* body = IsIdentifier(expr) ? FindDefine(expr) : nullptr;
+    if (body && !body->empty() && *body != expr) {
+      return Expand(*body, depth + 1);
+    }
+    return std::string(expr);
+  }
+
+  std::string result = Expand(expr.substr(0, paren), depth + 1) + "(";
+  const std::vector<std::string> args =
+      SplitArgs(expr.substr(paren + 1, expr.size() - paren - 2));
+  for (size_t i = 0; i < args.size(); ++i) {
+    result += (i ? ", " : "") + Expand(args[i], depth + 1);
+  }
+  return result + ")";
+}
+
+Keycode Keymap::ParseKeycode(std::string_view expr) const {
+  const std::string expanded = Expand(expr, 0);
+  Keycode k;
+  k.expr = expanded;
+
+  const size_t paren = expanded.find('(');
+  if (paren == std::string::npos) {
+    if (expanded == "_______" || expanded == "KC_TRNS" ||
+        expanded == "KC_TRANSPARENT") {
+      k.kind = Keycode::Kind::kTransparent;
+    } else if (expanded == "XXXXXXX" || expanded == "KC_NO") {
+      k.kind = Keycode::Kind::kNone;
+    } else if (IsIdentifier(expanded)) {
+      bool shifted = false;
+      k.kind = Keycode::Kind::kKey;
+      if (!ResolveBasicKeycode(expanded, &k.name, &shifted)) {
+        k.name = expanded;
+      }
+      k.mods = shifted ? kModShift : 0;
+    } else {
+      k.kind = Keycode::Kind::kOther;
+    }
+    return k;
+  }
+
+  const std::string fn = expanded.substr(0, paren);
+  const std::vector<std::string> args = SplitArgs(
+      std::string_view(expanded).substr(paren + 1,
+                                        expanded.size() - paren - 2));
+  auto layer_index = [&](const std::string& name) {
+    const auto it = enum_values_.find(name);
+    return (it != enum_values_.end()) ? it->second
+                                      : std::atoi(name.c_str());
+  };
+
+  if (fn == "LT" && args.size() == 2) {  // Layer-tap.
+    k = ParseKeycode(args[1]);
+    k.hold_layer = layer_index(args[0]);
+  } else if (fn == "MT" && args.size() == 2) {  // Mod-tap.
+    k = ParseKeycode(args[1]);
+    k.hold_mods = ParseMods(args[0]);
+  } else if (fn.size() > 2 && fn.compare(fn.size() - 2, 2, "_T") == 0 &&
+             args.size() == 1) {  // Mod-tap shorthand like LSFT_T(kc).
+    k = ParseKeycode(args[0]);
+    k.hold_mods = ParseMods(fn.substr(0, fn.size() - 2));
+  } else if ((fn == "MO" || fn == "TO" || fn == "TG" || fn == "OSL" ||
+              fn == "TT" || fn == "DF" || fn == "PDF") && args.size() == 1) {
+    k.kind = Keycode::Kind::kLayer;
+    k.name = fn;
+    k.layer = layer_index(args[0]);
+  } else if (ModWrapperMods(fn) && args.size() == 1) {  // Like S(kc).
+    k = ParseKeycode(args[0]);
+    k.mods |= ModWrapperMods(fn);
+  } else {
+    k.kind = Keycode::Kind::kOther;
+  }
+  k.expr = expanded;
+  return k;
+}
+
+int Keymap::FindLayer(std::string_view name) const {
+  for (int layer = 0; layer < num_layers(); ++layer) {
+    if (layer_names_[layer] == name) { return layer; }
+  }
+  return -1;
+}
+
+int Keymap::FindKey(int layer, std::string_view name) const {
+  for (int key = 0; key < num_keys(); ++key) {
+    const Keycode& k = keycode(layer, key);
+    if (k.kind == Keycode::Kind::kKey && k.name == name) { return key; }
+  }
+  return -1;
+}
+
+void Keymap::SwapKeys(int layer, int a, int b) {
+  std::swap(layers_[layer][a], layers_[layer][b]);
+}
+
+const Keycode& Keymap::ResolvedKeycode(int layer, int base_layer,
+                                       int key) const {
+  const Keycode& k = layers_[layer][key];
+  return (k.kind == Keycode::Kind::kTransparent) ? layers_[base_layer][key] : k;
+}
+
+char Keymap::TypedChar(const Keycode& k, bool shift_held) const {
+  if (k.kind != Keycode::Kind::kKey ||
+      (k.mods & (kModCtrl | kModAlt | kModGui)) != 0) {
+    return '\0';
+  }
+  if (shift_held && (k.mods & kModShift) == 0) {
+    const auto it = custom_shift_keys_.find(k.name);
+    if (it != custom_shift_keys_.end()) {
+      return TypedChar(it->second, false);
+    }
+  }
+  return KeycodeChar(k.name, shift_held || (k.mods & kModShift) != 0);
+}
+
+bool Keymap::FindStroke(int base_layer, char c, Stroke* stroke,
+                        bool allow_shift) const {
+  // Try in order of the number of keys: a base layer key alone, with Shift,
+  // on another layer, then on another layer with Shift.
+  for (int pass = 0; pass < 4; ++pass) {
+    const bool on_layer = (pass >= 2);
+    const bool shift = (pass % 2 == 1);
+    if (shift && !allow_shift) { continue; }
+
+    if (!on_layer) {
+      for (int key = 0; key < num_keys(); ++key) {
+        if (TypedChar(keycode(base_layer, key), shift) == c) {
+          *stroke = {key, -1, base_layer, shift};
+          return true;
+        }
+      }
+      continue;
+    }
+
+    for (int layer_key = 0; layer_key < num_keys(); ++layer_key) {
+      const Keycode& lk = keycode(base_layer, layer_key);
+      int layer = lk.hold_layer;
+      if (lk.kind == Keycode::Kind::kLayer &&
+          (lk.name == "MO" || lk.name == "OSL" || lk.name == "TT")) {
+        layer = lk.layer;
+      }
+      if (layer < 0 || layer >= num_layers() || layer == base_layer) {
+        continue;
+      }
+      for (int key = 0; key < num_keys(); ++key) {
+        if (key != layer_key &&
+            TypedChar(ResolvedKeycode(layer, base_layer, key), shift) == c) {
+          *stroke = {key, layer_key, layer, shift};
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+}  // namespace keystats
@@ -0,0 +1,191 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file keymap.h
+ * @brief Loads the layers of a keymap.c in this repo for host-side analysis.
+ *
+ * This is not a C preprocessor, but enough of one to read the keymaps here:
+ * comments are stripped, `#include "..."` of userspace files is followed (so
+ * that keymap.c pulls in getreuer.c), object-like `#define`s are expanded, and
+ * `enum`s are numbered to resolve layer names. Each `[LAYER] = LAYOUT_LR(...)`
+ * entry of the `keymaps` array is then parsed into a Keycode per key.
+ *
+ * Key positions and finger assignments are built in for the ZSA Voyager's
+ * LAYOUT_LR, which has 52 keys.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace keystats {
+
+enum Finger {
+  kLeftPinky,
+  kLeftRing,
+  kLeftMiddle,
+  kLeftIndex,
+  kLeftThumb,
+  kRightThumb,
+  kRightIndex,
+  kRightMiddle,
+  kRightRing,
+  kRightPinky,
+  kNumFingers,
+};
+
+/** Gets a short name for `finger`, like "L-index". */
+const char* FingerName(int finger);
+
+// Modifier bits, in the same 4-bit format as QMK's MOD_LCTL, etc.
+constexpr uint8_t kModCtrl = 1;
+constexpr uint8_t kModShift = 2;
+constexpr uint8_t kModAlt = 4;
+constexpr uint8_t kModGui = 8;
+
+struct Keycode {
+  enum class Kind {
+    kNone,         // KC_NO or XXXXXXX.
+    kTransparent,  // KC_TRNS or _______.
+    kKey,          // A basic or custom keycode, possibly a tap-hold key.
+    kLayer,        // Layer switching key like MO(layer) or TO(layer).
+    kOther,        // Anything else.
+  };
+
+  Kind kind = Kind::kNone;
+  // For kKey, the canonical basic keycode name like "KC_A", or the name of a
+  // non-char or custom keycode like "KC_BSPC" or "M_ION". For tap-hold keys,
+  // this is the tapping keycode. For kLayer, the function like "MO".
+  std::string name;
+  uint8_t mods = 0;       // Mods applied with the key, as in S(KC_1) or C(KC_C).
+  int hold_layer = -1;    // Layer while held, for layer-tap keys.
+  uint8_t hold_mods = 0;  // Mods while held, for mod-tap keys.
+  int layer = -1;         // Target layer of a kLayer key.
+  std::string expr;       // Keycode expression after macro expansion.
+};
+
+/** A string typed by a MAGIC_STRING() macro. */
+struct MagicString {
+  std::string text;
+  // Keycode the Repeat Key types next, the second arg to MAGIC_STRING().
+  std::string repeat_keycode;
+};
+
+struct KeyPosition {
+  int row;
+  int col;
+  int finger;
+};
+
+class Keymap {
+ public:
+  /**
+   * Loads keymap.c at `file_name`. On failure, returns false and sets `error`.
+   */
+  bool Load(const std::string& file_name, std::string* error);
+
+  int num_keys() const { return static_cast<int>(positions_.size()); }
+  int num_layers() const { return static_cast<int>(layers_.size()); }
+  const std::string& layer_name(int layer) const { return layer_names_[layer]; }
+  const KeyPosition& position(int key) const { return positions_[key]; }
+  const Keycode& keycode(int layer, int key) const {
+    return layers_[layer][key];
+  }
+
+  /** Finds a layer by name, e.g. "GRAPHITE", or returns -1. */
+  int FindLayer(std::string_view name) const;
+
+  /** Finds the first key on `layer` with kKey keycode `name`, or -1. */
+  int FindKey(int layer, std::string_view name) const;
+
+  /** Replaces the keycode of `key` on `layer`. */
+  void SetKeycode(int layer, int key, const Keycode& k) {
+    layers_[layer][key] = k;
+  }
+
+  /** Swaps the keycodes of keys `a` and `b` on `layer`. */
+  void SwapKeys(int layer, int a, int b);
+
+  /**
+   * Gets the keycode of `key` on `layer`, resolving transparent keys through
+   * to `base_layer`.
+   */
+  const Keycode& ResolvedKeycode(int layer, int base_layer, int key) const;
+
+  /**
+   * Gets the char typed by tapping keycode `k`, with Shift held or not, or
+   * '\0' if it doesn't type a char. Custom shift keys are taken into account.
+   */
+  char TypedChar(const Keycode& k, bool shift_held) const;
+
+  /** Gets the expansion of object-like `#define name`, or nullptr. */
+  const std::string* FindDefine(std::string_view name) const;
+
+  /** Parses and resolves a keycode expression, e.g. "LT(NUM, KC_R)". */
+  Keycode ParseKeycode(std::string_view expr) const;
+
+  /** Source code read, with comments and preprocessor lines removed. */
+  const std::string& source() const { return source_; }
+
+  /**
+   * Strings typed by MAGIC_STRING() macros in process_record_user(), keyed by
+   * custom keycode, e.g. {"M_ION", {"on", "KC_S"}}.
+   */
+  const std::map<std::string, MagicString>& magic_strings() const {
+    return magic_strings_;
+  }
+
+  /** How to type a char: a key, possibly with a layer key and Shift held. */
+  struct Stroke {
+    int key = -1;
+    int layer_key = -1;  // Key held to reach the layer, or -1 for base layer.
+    int layer = -1;
+    bool shift = false;  // Whether Shift is held.
+  };
+
+  /**
+   * Finds how to type `c` starting from `base_layer` with the fewest keys:
+   * a key on the base layer, possibly with Shift, or a key on a layer reached
+   * by holding a layer or layer-tap key on the base layer. If `allow_shift` is
+   * false, only strokes without Shift are considered. Returns false if `c`
+   * can't be typed.
+   */
+  bool FindStroke(int base_layer, char c, Stroke* stroke,
+                  bool allow_shift = true) const;
+
+ private:
+  bool ReadFile(const std::string& file_name, int depth, std::string* error);
+  void ParseEnums();
+  bool ParseKeymaps(std::string* error);
+  void ParseCustomShiftKeys();
+  void ParseMagicStrings();
+  std::string Expand(std::string_view expr, int depth) const;
+
+  std::map<std::string, std::string, std::less<>> defines_;
+  std::map<std::string, int, std::less<>> enum_values_;
+  std::vector<std::string> files_read_;
+  std::string source_;
+  std::vector<std::string> layer_names_;
+  std::vector<std::vector<Keycode>> layers_;
+  std::vector<KeyPosition> positions_;
+  std::map<std::string, Keycode> custom_shift_keys_;
+  std::map<std::string, MagicString> magic_strings_;
+};
+
+}  // namespace keystats
@@ -0,0 +1,443 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file magic_optimizer.cc
+ * @brief Chooses Magic key rules from text corpora.
+ *
+ * For each context of the last 1 to --max_context typed chars, this program
+ * scores every candidate Magic key output: any single key, and the strings
+ * typed by the keymap's MAGIC_STRING() macros. A candidate's value per use is
+ * the keystrokes it saves, plus --sfb_weight for each same-finger bigram it
+ * removes on the given layer. The best candidate is kept for each single-char
+ * context. A longer context gets its own rule only if it beats the rule it
+ * would otherwise inherit from its suffix by at least --min_gain of the
+ * corpus, as rules with the longest matching context win in the firmware.
+ *
+ * The rules are written in the syntax of features/magic_key_dict.txt, from
+ * which features/make_magic_key_data.py generates the firmware's table.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "corpus.h"
+#include "keycodes.h"
+#include "keymap.h"
+#include "ngrams.h"
+
+namespace keystats {
+namespace {
+
+constexpr char kHelpText[] = R"(Chooses Magic key rules from text corpora.
+Use: magic_optimizer [options] corpus.txt [corpus2.txt ...]
+
+Counts n-grams in the corpus files and prints the Magic key rules that save
+the most keystrokes and same-finger bigrams (SFBs) on the given keymap layer.
+
+Options:
+  --keymap       Path of keymap.c, default
+                 keyboards/zsa/voyager/keymaps/getreuer/keymap.c
+  --layer        Name of the base layer, default the first layer.
+  --max_context  Max number of chars of context, 1 to 3, default 2.
+  --sfb_weight   Value of removing an SFB, relative to saving a keystroke,
+                 default 1.
+  --min_gain     Min gain, as a fraction of corpus chars, to add a rule with
+                 longer context, default 0.0001.
+  --threads      Number of threads, default the number of cores.
+  --output       Write the rules to this file, in the syntax of
+                 features/magic_key_dict.txt.
+)";
+
+constexpr int kMaxContext = 3;
+
+// Key for Counts::string_hits of a packed context of length k.
+uint32_t StringHitKey(uint32_t context, int k) { return context | (k << 21); }
+
+struct Counts {
+  Counts(int max_n, size_t num_strings) : string_hits(num_strings) {
+    for (int n = 1; n <= max_n; ++n) { ngrams.emplace_back(n); }
+  }
+
+  void Merge(const Counts& other) {
+    for (size_t n = 0; n < ngrams.size(); ++n) {
+      ngrams[n].Merge(other.ngrams[n]);
+    }
+    for (size_t i = 0; i < string_hits.size(); ++i) {
+      for (const auto& [key, count] : other.string_hits[i]) {
+        string_hits[i][key] += count;
+      }
+    }
+  }
+
+  // ngrams[n - 1] counts n-grams.
+  std::vector<NgramTable> ngrams;
+  // string_hits[i][context] counts `context` followed by the ith string.
+  std::vector<std::unordered_map<uint32_t, uint64_t>> string_hits;
+};
+
+// Counts n-grams up to length max_context + 1 that start in `shard`, and
+// occurrences of each of `strings` following up to max_context chars.
+void CountShard(const Shard& shard, int max_context,
+                const std::vector<std::string>& strings, Counts* counts) {
+  const int max_n = max_context + 1;
+  std::vector<size_t> by_first_char[128];
+  for (size_t i = 0; i < strings.size(); ++i) {
+    by_first_char[static_cast<uint8_t>(strings[i][0])].push_back(i);
+  }
+
+  for (const char* p = shard.begin; p < shard.end; ++p) {
+    uint32_t keys[kMaxContext + 1];  // keys[n - 1] is the n-gram at p.
+    uint32_t key = 0;
+    int n = 0;
+    for (; n < max_n && p + n < shard.limit; ++n) {
+      const uint8_t c = Symbol(p[n]);
+      if (!c) { break; }
+      key = (key << 7) | c;
+      keys[n] = key;
+      counts->ngrams[n].Add(key);
+    }
+
+    // Here, the first `n` symbols from p are valid. Check for each string
+    // following a context of k = 1 to max_context chars.
+    for (int k = 1; k <= std::min(n, max_context); ++k) {
+      const char* s = p + k;
+      if (s >= shard.limit) { break; }
+      for (size_t i : by_first_char[Symbol(s[0]) & 0x7f]) {
+        const std::string& str = strings[i];
+        if (s + str.size() > shard.limit) { continue; }
+        size_t j = 1;
+        while (j < str.size() && Symbol(s[j]) == str[j]) { ++j; }
+        if (j == str.size()) {
+          ++counts->string_hits[i][StringHitKey(keys[k - 1], k)];
+        }
+      }
+    }
+  }
+}
+
+struct Candidate {
+  std::string keycode;  // Keycode expression to output.
+  std::string text;     // Text typed by the output.
+};
+
+struct Rule {
+  std::string context;
+  const Candidate* output = nullptr;
+  uint64_t hits = 0;
+  double keys_saved = 0.0;
+  double sfbs_removed = 0.0;
+  double gain = 0.0;
+};
+
+class Optimizer {
+ public:
+  Optimizer(const Keymap& keymap, int layer, const Counts& counts,
+            const std::vector<Candidate>& strings, int max_context,
+            double sfb_weight)
+      : keymap_(keymap), layer_(layer), counts_(counts), strings_(strings),
+        max_context_(max_context), sfb_weight_(sfb_weight) {
+    // The Magic key's finger, if it is on the layer.
+    for (int key = 0; key < keymap_.num_keys(); ++key) {
+      const Keycode& k = keymap_.keycode(layer_, key);
+      if (k.kind == Keycode::Kind::kKey && k.name == "QK_AREP") {
+        magic_finger_ = keymap_.position(key).finger;
+      }
+    }
+    for (int c = 1; c < 128; ++c) {
+      chars_[c].keycode = CharKeycodeExpr(static_cast<char>(c));
+      chars_[c].text = std::string(1, static_cast<char>(c));
+    }
+  }
+
+  uint64_t total_chars() const { return counts_.ngrams[0].Total(); }
+
+  bool magic_key_on_layer() const { return magic_finger_ >= 0; }
+
+  std::vector<Rule> Run(double min_gain) {
+    const double min_gain_count = min_gain * total_chars();
+    std::vector<Rule> rules;
+    std::map<std::string, const Rule*> by_context;
+
+    for (int k = 1; k <= max_context_; ++k) {
+      // Collect the candidates for each context of length k.
+      std::map<std::string, std::vector<const Candidate*>> contexts;
+      counts_.ngrams[k].ForEach([&](uint32_t key, uint64_t) {
+        const std::string ngram = Unpack(key, k + 1);
+        if (!chars_[static_cast<uint8_t>(ngram[k])].keycode.empty()) {
+          contexts[ngram.substr(0, k)].push_back(
+              &chars_[static_cast<uint8_t>(ngram[k])]);
+        }
+      });
+      for (size_t i = 0; i < strings_.size(); ++i) {
+        for (const auto& [key, count] : counts_.string_hits[i]) {
+          if ((key >> 21) == static_cast<uint32_t>(k)) {
+            contexts[Unpack(key & ((1 << 21) - 1), k)].push_back(&strings_[i]);
+          }
+        }
+      }
+
+      std::vector<Rule> level;
+      for (const auto& [context, candidates] : contexts) {
+        // The rule this context would inherit from its longest suffix.
+        const Rule* inherited = nullptr;
+        for (size_t i = 1; i < context.size() && !inherited; ++i) {
+          const auto it = by_context.find(context.substr(i));
+          if (it != by_context.end()) { inherited = it->second; }
+        }
+        const double baseline =
+            inherited ? Score(context, *inherited->output).gain : 0.0;
+
+        Rule best;
+        for (const Candidate* candidate : candidates) {
+          Rule rule = Score(context, *candidate);
+          if (rule.gain > best.gain) { best = rule; }
+        }
+        if (!best.output || best.gain <= 0.0 ||
+            (inherited && best.output == inherited->output) ||
+            (k > 1 && best.gain - baseline < min_gain_count)) {
+          continue;
+        }
+        best.gain -= baseline;
+        level.push_back(best);
+      }
+
+      for (const Rule& rule : level) { rules.push_back(rule); }
+      for (const Rule& rule : rules) { by_context[rule.context] = &rule; }
+    }
+    return rules;
+  }
+
+ private:
+  // Scores `candidate` as the Magic key output after `context`.
+  Rule Score(const std::string& context, const Candidate& candidate) const {
+    Rule rule;
+    rule.context = context;
+    rule.output = &candidate;
+
+    const int k = context.size();
+    if (candidate.text.size() == 1) {
+      rule.hits = counts_.ngrams[k].Get(Pack(context + candidate.text));
+    } else {
+      const size_t i = &candidate - strings_.data();
+      const auto it = counts_.string_hits[i].find(
+          StringHitKey(Pack(context), k));
+      rule.hits = (it != counts_.string_hits[i].end()) ? it->second : 0;
+    }
+
+    // Typing the Magic key replaces typing the output text, which may itself
+    // take several keys per char for shifted or layer chars.
+    rule.keys_saved = rule.hits * (Keystrokes(candidate.text) - 1.0);
+    const int before = Sfb(context.back(), candidate.text[0]);
+    const int after = (magic_finger_ >= 0 &&
+                       Finger(context.back()) == magic_finger_);
+    rule.sfbs_removed = static_cast<double>(rule.hits) * (before - after);
+    rule.gain = rule.keys_saved + sfb_weight_ * rule.sfbs_removed;
+    return rule;
+  }
+
+  int Finger(char c) const {
+    Keymap::Stroke stroke;
+    return keymap_.FindStroke(layer_, c, &stroke)
+               ? keymap_.position(stroke.key).finger : -1;
+  }
+
+  // Whether typing `a` then `b` is a same-finger bigram on different keys.
+  int Sfb(char a, char b) const {
+    Keymap::Stroke sa, sb;
+    return keymap_.FindStroke(layer_, a, &sa) &&
+           keymap_.FindStroke(layer_, b, &sb) && sa.key != sb.key &&
+           keymap_.position(sa.key).finger == keymap_.position(sb.key).finger;
+  }
+
+  // Number of key presses to type `text`, counting Shift and layer keys.
+  int Keystrokes(const std::string& text) const {
+    int total = 0;
+    for (char c : text) {
+      Keymap::Stroke stroke;
+      total += keymap_.FindStroke(layer_, c, &stroke)
+                   ? 1 + stroke.shift + (stroke.layer_key >= 0) : 1;
+    }
+    return total;
+  }
+
+  const Keymap& keymap_;
+  const int layer_;
+  const Counts& counts_;
+  const std::vector<Candidate>& strings_;
+  const int max_context_;
+  const double sfb_weight_;
+  int magic_finger_ = -1;
+  Candidate chars_[128];
+};
+
+// Formats `context` in the dict syntax of features/magic_key_dict.txt.
+std::string FormatContext(const std::string& context) {
+  std::string result;
+  for (char c : context) {
+    switch (c) {
+      case ' ': result += "\\s"; break;
+      case '\n': result += "\\n"; break;
+      case '\t': result += "\\t"; break;
+      case '#': result += "\\#"; break;
+      case '\\': result += "\\\\"; break;
+      default: result += c;
+    }
+  }
+  return result;
+}
+
+int Main(int argc, char** argv) {
+  std::string keymap_file = "keyboards/zsa/voyager/keymaps/getreuer/keymap.c";
+  std::string layer_name;
+  std::string output_file;
+  int max_context = 2;
+  double sfb_weight = 1.0;
+  double min_gain = 0.0001;
+  int num_threads = DefaultNumThreads();
+  std::vector<std::string> input_file_names;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string name, value;
+    if (!ParseOption(argv[i], &name, &value)) {
+      input_file_names.push_back(argv[i]);
+    } else if (name == "--keymap") {
+      keymap_file = value;
+    } else if (name == "--layer") {
+      layer_name = value;
+    } else if (name == "--max_context") {
+      max_context = std::clamp(std::atoi(value.c_str()), 1, kMaxContext);
+    } else if (name == "--sfb_weight") {
+      sfb_weight = std::atof(value.c_str());
+    } else if (name == "--min_gain") {
+      min_gain = std::atof(value.c_str());
+    } else if (name == "--threads") {
+      num_threads = std::atoi(value.c_str());
+    } else if (name == "--output") {
+      output_file = value;
+    } else {
+      std::printf("Invalid option: %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  if (input_file_names.empty()) {  // No input given; show help text and exit.
+    std::printf("%s", kHelpText);
+    return 1;
+  }
+
+  Keymap keymap;
+  std::string error;
+  if (!keymap.Load(keymap_file, &error)) {
+    std::printf("Error: %s\n", error.c_str());
+    return 1;
+  }
+  const int layer = layer_name.empty() ? 0 : keymap.FindLayer(layer_name);
+  if (layer < 0) {
+    std::printf("Error: No layer %s in %s\n", layer_name.c_str(),
+                keymap_file.c_str());
+    return 1;
+  }
+
+  // Candidate outputs besides single keys: the keymap's MAGIC_STRING macros.
+  std::vector<Candidate> strings;
+  std::vector<std::string> string_texts;
+  for (const auto& [keycode, magic_string] : keymap.magic_strings()) {
+    const std::string& text = magic_string.text;
+    std::string folded;
+    for (char c : text) { folded += Symbol(c); }
+    if (text.size() >= 2 && folded.find('\0') == std::string::npos) {
+      strings.push_back({keycode, folded});
+      string_texts.push_back(folded);
+    }
+  }
+
+  std::vector<Counts> counts(num_threads,
+                             Counts(max_context + 1, strings.size()));
+  ForEachShard(input_file_names, num_threads,
+               [&](const Shard& shard, int thread) {
+                 CountShard(shard, max_context, string_texts, &counts[thread]);
+               });
+  for (int thread = 1; thread < num_threads; ++thread) {
+    counts[0].Merge(counts[thread]);
+  }
+
+  Optimizer optimizer(keymap, layer, counts[0], strings, max_context,
+                      sfb_weight);
+  std::vector<Rule> rules = optimizer.Run(min_gain);
+  std::sort(rules.begin(), rules.end(), [](const Rule& a, const Rule& b) {
+    return a.gain > b.gain;
+  });
+
+  const uint64_t total_chars = optimizer.total_chars();
+  double keys_saved = 0.0;
+  double sfbs_removed = 0.0;
+  std::printf("Magic key rules for layer %s, from %llu chars\n\n",
+              keymap.layer_name(layer).c_str(),
+              static_cast<unsigned long long>(total_chars));
+  std::printf("context  output        text       hits   keys saved"
+              "  SFBs removed   gain %%\n");
+  for (const Rule& rule : rules) {
+    std::string text = FormatContext(rule.output->text);
+    std::printf("%-8s %-13s %-8s %6llu %12.0f %13.0f %8.3f\n",
+                FormatContext(rule.context).c_str(),
+                rule.output->keycode.c_str(), text.c_str(),
+                static_cast<unsigned long long>(rule.hits), rule.keys_saved,
+                rule.sfbs_removed, (100.0 * rule.gain) / total_chars);
+    keys_saved += rule.keys_saved;
+    sfbs_removed += rule.sfbs_removed;
+  }
+  std::printf("\ntotal: %.3f%% keystrokes saved, %.3f%% of chars are SFBs "
+              "removed\n", (100.0 * keys_saved) / total_chars,
+              (100.0 * sfbs_removed) / total_chars);
+  if (!optimizer.magic_key_on_layer()) {
+    std::printf("(No QK_AREP on the layer; assuming the Magic key is on a "
+                "finger not typing the context.)\n");
+  }
+
+  if (!output_file.empty()) {
+    FILE* file = std::fopen(output_file.c_str(), "wt");
+    if (!file) {
+      std::printf("Error: Can't write %s\n", output_file.c_str());
+      return 1;
+    }
+    std::fprintf(file,
+                 "# Magic key rules generated by magic_optimizer for layer "
+                 "%s, from %llu chars.\n"
+                 "# Generate magic_key_data.h from this file with "
+                 "make_magic_key_data.py.\n\n",
+                 keymap.layer_name(layer).c_str(),
+                 static_cast<unsigned long long>(total_chars));
+    std::sort(rules.begin(), rules.end(), [](const Rule& a, const Rule& b) {
+      return a.context < b.context;
+    });
+    for (const Rule& rule : rules) {
+      std::fprintf(file, "%-6s -> %s\n", FormatContext(rule.context).c_str(),
+                   rule.output->keycode.c_str());
+    }
+    std::fclose(file);
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace keystats
+
+int main(int argc, char** argv) { return keystats::Main(argc, argv); }
@@ -0,0 +1,130 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file ngrams.h
+ * @brief N-gram count tables over 7-bit ASCII symbols.
+ *
+ * Text is mapped to symbols with Symbol(), which folds letters to lowercase
+ * and maps bytes that break an n-gram (control chars other than newline and
+ * tab, and non-ASCII bytes) to 0. An n-gram of n symbols is packed into 7n
+ * bits. Up to 3-grams are counted in a dense table of 2^21 counts, longer
+ * n-grams in a hash map.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace keystats {
+
+/** Maps a byte to a symbol, or 0 if it breaks the n-gram. */
+inline uint8_t Symbol(char byte) {
+  const unsigned char c = static_cast<unsigned char>(byte);
+  if ('A' <= c && c <= 'Z') {
+    return c - 'A' + 'a';
+  } else if ((0x20 <= c && c < 0x7f) || c == '\n' || c == '\t') {
+    return c;
+  }
+  return 0;
+}
+
+/** Packs a string of symbols into an n-gram key. */
+inline uint32_t Pack(const std::string& s) {
+  uint32_t key = 0;
+  for (char c : s) { key = (key << 7) | static_cast<uint8_t>(c); }
+  return key;
+}
+
+/** Unpacks an n-gram key of `n` symbols into a string. */
+inline std::string Unpack(uint32_t key, int n) {
+  std::string s(n, '\0');
+  for (int i = n - 1; i >= 0; --i, key >>= 7) { s[i] = key & 0x7f; }
+  return s;
+}
+
+/**
+ * Formats a string of symbols for display, quoted and with newline, tab and
+ * backslash escaped.
+ */
+inline std::string FormatNgram(const std::string& s) {
+  std::string result = "'";
+  for (char c : s) {
+    switch (c) {
+      case '\n': result += "\\n"; break;
+      case '\t': result += "\\t"; break;
+      case '\\': result += "\\\\"; break;
+      default: result += c;
+    }
+  }
+  return result + "'";
+}
+
+class NgramTable {
+ public:
+  static constexpr int kDenseMaxN = 3;
+
+  explicit NgramTable(int n) : n_(n) {
+    if (n_ <= kDenseMaxN) { dense_.resize(size_t{1} << (7 * n_)); }
+  }
+
+  int n() const { return n_; }
+
+  void Add(uint32_t key, uint64_t count = 1) {
+    if (n_ <= kDenseMaxN) {
+      dense_[key] += count;
+    } else {
+      sparse_[key] += count;
+    }
+  }
+
+  uint64_t Get(uint32_t key) const {
+    if (n_ <= kDenseMaxN) { return dense_[key]; }
+    const auto it = sparse_.find(key);
+    return (it != sparse_.end()) ? it->second : 0;
+  }
+
+  void Merge(const NgramTable& other) {
+    for (size_t i = 0; i < other.dense_.size(); ++i) {
+      dense_[i] += other.dense_[i];
+    }
+    for (const auto& [key, count] : other.sparse_) { sparse_[key] += count; }
+  }
+
+  /** Calls `fn(key, count)` for each n-gram with nonzero count. */
+  template <typename Fn>
+  void ForEach(Fn fn) const {
+    for (size_t i = 0; i < dense_.size(); ++i) {
+      if (dense_[i]) { fn(static_cast<uint32_t>(i), dense_[i]); }
+    }
+    for (const auto& [key, count] : sparse_) { fn(key, count); }
+  }
+
+  /** Sum of all counts. */
+  uint64_t Total() const {
+    uint64_t total = 0;
+    ForEach([&](uint32_t, uint64_t count) { total += count; });
+    return total;
+  }
+
+ private:
+  int n_;
+  std::vector<uint64_t> dense_;
+  std::unordered_map<uint32_t, uint64_t> sparse_;
+};
+
+}  // namespace keystats
@@ -0,0 +1,795 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file typing_sim.cc
+ * @brief Simulates typing text corpora on the full keymap.
+ *
+ * Text is typed on the base layer with the cheapest sequence of key presses,
+ * found by dynamic programming over text positions. At each position, the next
+ * chars may be typed by:
+ *
+ *  - Their keys, holding a layer key and Shift as needed. Custom shift keys are
+ *    taken into account, and a layer key or Shift held for consecutive chars is
+ *    pressed once.
+ *  - The Repeat Key, if the char is the one it would type, with Shift
+ *    forgotten on letters as in remember_last_key_user().
+ *  - The Magic key, if the rule of features/magic_key_dict.txt matching the
+ *    preceding text types the next char or MAGIC_STRING() text. Rules like
+ *    "\mo" apply after a char typed by the Magic key. The few rules left in
+ *    get_alt_repeat_key_keycode_user() are for hotkeys and custom-shifted
+ *    punctuation and are not simulated.
+ *
+ * The Magic and Repeat keys are the layer's QK_AREP and QK_REP keys, or the
+ * keys given by --magic_key and --repeat_key. If the layer lacks one and no
+ * key is given, the simulator stops rather than type without it.
+ *  - Caps Word, turned on by double tapping Shift, for a run of capitals that
+ *    continues by the same rules as caps_word_press_user().
+ *
+ * A press costs 1 and a same-finger bigram (SFB) --sfb_weight more. Text is
+ * simulated in segments of up to 64K chars, each continuing from the state the
+ * previous one ended in, so that memory stays small. Shards of the corpus are
+ * simulated in parallel.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "corpus.h"
+#include "keycodes.h"
+#include "keymap.h"
+
+namespace keystats {
+namespace {
+
+constexpr char kHelpText[] = R"(Simulates typing text corpora on the keymap.
+Use: typing_sim [options] corpus.txt [corpus2.txt ...]
+
+Types the corpus files on the given keymap layer with the fewest keystrokes,
+using Repeat, Magic key rules, MAGIC_STRING macros and Caps Word, and prints
+the finger load, same-finger bigram (SFB) rate, layer churn and hit rates.
+
+Options:
+  --keymap      Path of keymap.c, default
+                keyboards/zsa/voyager/keymaps/getreuer/keymap.c
+  --layer       Name of the base layer, default the first layer.
+  --dict        Magic key rules, default features/magic_key_dict.txt. Use
+                --dict= to simulate without Magic key rules.
+  --magic_key   Key that is the Magic key (QK_AREP), as a key index 0-51 or a
+                keycode on the layer like LEFT_THUMB_BIG, or "none". Default
+                the layer's QK_AREP key; it is an error if there is none.
+  --repeat_key  Key that is the Repeat Key (QK_REP), like --magic_key.
+  --swap        Swap two keys on the layer, like --swap=G_MOD,LAY_WIN1. May
+                be given more than once.
+  --sfb_weight  Cost of an SFB, relative to a keystroke, default 1.
+  --threads     Number of threads, default the number of cores.
+)";
+
+constexpr int kMaxSegment = 1 << 16;
+
+enum Kind : uint8_t {
+  kTyped,        // Last char typed by its key.
+  kRepeated,     // Typed by the Repeat Key.
+  kMagicChar,    // Typed by the Magic key.
+  kMagicString,  // Chars typed by the Magic key with a MAGIC_STRING macro.
+  kCapsWord,     // Run of chars typed in Caps Word.
+  kNumKinds,
+};
+
+// State at a text position, after some way of typing the text before it.
+struct State {
+  double cost = std::numeric_limits<double>::infinity();
+  int32_t prev = -1;        // Index of the previous state in the segment.
+  int8_t last_key = -1;     // Last key tapped.
+  int8_t layer_key = -1;    // Layer key held, or -1 on the base layer.
+  int8_t shift_key = -1;    // Shift key held, or -1.
+  char repeat = '\0';       // Char the Repeat Key types, or '\0'.
+  int16_t magic_rule = -1;  // Magic rule after a char typed by Magic, or -1.
+};
+
+struct MagicRule {
+  std::string context;
+  std::string output;  // Keycode expression.
+  std::string text;    // Text typed, or empty if not modeled.
+  char repeat = '\0';  // Char the Repeat Key types after this rule.
+};
+
+struct Stats {
+  explicit Stats(size_t num_rules) : rule_hits(num_rules) {}
+
+  void Merge(const Stats& other) {
+    chars += other.chars;
+    untypeable += other.untypeable;
+    presses += other.presses;
+    taps += other.taps;
+    sfbs += other.sfbs;
+    layer_presses += other.layer_presses;
+    shift_presses += other.shift_presses;
+    repeat_hits += other.repeat_hits;
+    magic_hits += other.magic_hits;
+    magic_chars += other.magic_chars;
+    caps_words += other.caps_words;
+    caps_word_chars += other.caps_word_chars;
+    for (int f = 0; f < kNumFingers; ++f) { finger[f] += other.finger[f]; }
+    for (size_t i = 0; i < rule_hits.size(); ++i) {
+      rule_hits[i] += other.rule_hits[i];
+    }
+  }
+
+  uint64_t chars = 0;
+  uint64_t untypeable = 0;
+  uint64_t presses = 0;
+  uint64_t taps = 0;  // Consecutive pairs of tapped keys.
+  uint64_t sfbs = 0;
+  uint64_t layer_presses = 0;
+  uint64_t shift_presses = 0;
+  uint64_t repeat_hits = 0;
+  uint64_t magic_hits = 0;
+  uint64_t magic_chars = 0;
+  uint64_t caps_words = 0;
+  uint64_t caps_word_chars = 0;
+  uint64_t finger[kNumFingers] = {};
+  std::vector<uint64_t> rule_hits;
+};
+
+// Stands for the Magic key in a parsed context, written \m in the dict.
+constexpr char kMagicKeyChar = '\x01';
+
+// Parses the context of a rule in magic_key_dict.txt, resolving escapes.
+bool ParseContext(const std::string& text, std::string* context) {
+  context->clear();
+  for (size_t i = 0; i < text.size(); ++i) {
+    char c = text[i];
+    if (c == '\\') {
+      if (++i >= text.size()) { return false; }
+      switch (text[i]) {
+        case 's': c = ' '; break;
+        case 'n': c = '\n'; break;
+        case 't': c = '\t'; break;
+        case '#': c = '#'; break;
+        case '\\': c = '\\'; break;
+        case 'm': c = kMagicKeyChar; break;
+        default: return false;
+      }
+    }
+    *context += c;
+  }
+  return !context->empty();
+}
+
+std::string Trim(const std::string& s) {
+  const size_t begin = s.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos) { return ""; }
+  return s.substr(begin, s.find_last_not_of(" \t\r\n") - begin + 1);
+}
+
+// Whether Repeat forgets Shift on `c`, as in remember_last_key_user().
+bool ForgetsShift(char c) {
+  return ('A' <= c && c <= 'H') || ('K' <= c && c <= 'M') ||
+         ('O' <= c && c <= 'U');
+}
+
+class Simulator {
+ public:
+  Simulator(const Keymap& keymap, int layer, int magic_key, int repeat_key,
+            double sfb_weight)
+      : keymap_(keymap), layer_(layer), magic_key_(magic_key),
+        repeat_key_(repeat_key), sfb_weight_(sfb_weight) {
+    std::fill(std::begin(magic_after_), std::end(magic_after_), -1);
+    // Shift keys on the layer, either plain or mod-tap.
+    std::vector<int> shift_keys;
+    for (int key = 0; key < keymap_.num_keys(); ++key) {
+      const Keycode& k = keymap_.keycode(layer_, key);
+      const bool plain = k.kind == Keycode::Kind::kKey &&
+                         (k.name == "KC_LSFT" || k.name == "KC_RSFT");
+      if (plain || (k.hold_mods & kModShift)) { shift_keys.push_back(key); }
+      if (plain && caps_word_key_ < 0) { caps_word_key_ = key; }
+    }
+    // Shift is held on the opposite hand of the key it shifts if possible.
+    for (int key = 0; key < keymap_.num_keys(); ++key) {
+      shift_for_key_.push_back(shift_keys.empty() ? -1 : shift_keys[0]);
+      for (int shift_key : shift_keys) {
+        if (IsLeft(shift_key) != IsLeft(key)) {
+          shift_for_key_.back() = shift_key;
+          break;
+        }
+      }
+    }
+
+    for (int c = 1; c < 128; ++c) {
+      const char ch = static_cast<char>(c);
+      Keymap::Stroke& stroke = strokes_[c];
+      typeable_[c] = keymap_.FindStroke(layer_, ch, &stroke);
+      if (!typeable_[c]) { continue; }
+      // The Magic key's context records the key and Shift state, as the char
+      // the key types on a US layout.
+      const Keycode& k = keymap_.ResolvedKeycode(stroke.layer, layer_,
+                                                 stroke.key);
+      tokens_[c] = KeycodeChar(k.name, stroke.shift || (k.mods & kModShift));
+      repeats_[c] = (stroke.shift && ForgetsShift(ch)) ? std::tolower(ch) : ch;
+
+      // Chars continuing Caps Word: letters, shifted by Caps Word, digits and
+      // KC_UNDS, if typed without Shift.
+      const char base = std::isupper(c) ? std::tolower(c) : ch;
+      if (std::isalnum(c) || c == '_') {
+        caps_word_[c] =
+            keymap_.FindStroke(layer_, base, &caps_word_strokes_[c], false) &&
+            (c != '_' || keymap_.ResolvedKeycode(caps_word_strokes_[c].layer,
+                                                 layer_,
+                                                 caps_word_strokes_[c].key)
+                                 .name == "KC_UNDS");
+      }
+    }
+  }
+
+  /** Loads Magic key rules from `file_name`. */
+  bool LoadRules(const std::string& file_name, std::string* error) {
+    std::ifstream file(file_name);
+    if (!file) {
+      *error = "Can't read " + file_name;
+      return false;
+    }
+    nodes_.assign(1, Node());
+    std::fill(std::begin(magic_after_), std::end(magic_after_), -1);
+    std::string line;
+    for (int line_number = 1; std::getline(file, line); ++line_number) {
+      line = Trim(line);
+      if (line.empty() || line[0] == '#') { continue; }
+      const size_t arrow = line.rfind("->");
+      MagicRule rule;
+      if (arrow == std::string::npos ||
+          !ParseContext(Trim(line.substr(0, arrow)), &rule.context) ||
+          (rule.output = Trim(line.substr(arrow + 2))).empty()) {
+        *error = file_name + ":" + std::to_string(line_number) +
+                 ": Invalid rule: " + line;
+        return false;
+      }
+
+      const Keycode k = keymap_.ParseKeycode(rule.output);
+      const auto it = keymap_.magic_strings().find(rule.output);
+      if (const char c = keymap_.TypedChar(k, false)) {
+        rule.text = std::string(1, c);
+        rule.repeat = c;
+      } else if (it != keymap_.magic_strings().end()) {
+        rule.text = it->second.text;
+        rule.repeat = keymap_.TypedChar(
+            keymap_.ParseKeycode(it->second.repeat_keycode), false);
+      }
+
+      // A rule for a char typed by Magic applies in place of the trie's.
+      if (rule.context.find(kMagicKeyChar) != std::string::npos) {
+        if (rule.context.size() != 2 || rule.context[0] != kMagicKeyChar) {
+          *error = file_name + ":" + std::to_string(line_number) +
+                   ": Only \\m followed by one char is simulated: " + line;
+          return false;
+        }
+        magic_after_[static_cast<uint8_t>(rule.context[1]) & 0x7f] =
+            static_cast<int16_t>(rules_.size());
+        rules_.push_back(rule);
+        continue;
+      }
+
+      // Add the context to the trie, newest char first.
+      int node = 0;
+      for (auto c = rule.context.rbegin(); c != rule.context.rend(); ++c) {
+        int16_t& child = nodes_[node].children[static_cast<uint8_t>(*c) & 0x7f];
+        if (child < 0) {
+          child = static_cast<int16_t>(nodes_.size());
+          nodes_.emplace_back();
+        }
+        node = child;
+      }
+      nodes_[node].rule = static_cast<int16_t>(rules_.size());
+      max_context_ = std::max(max_context_,
+                              static_cast<int>(rule.context.size()));
+      rules_.push_back(rule);
+    }
+    return true;
+  }
+
+  const std::vector<MagicRule>& rules() const { return rules_; }
+  bool has_caps_word() const { return caps_word_key_ >= 0; }
+
+  /** Simulates typing [shard.begin, shard.end). */
+  void Run(const Shard& shard, Stats* stats) const {
+    Workspace ws;
+    State start = Start();
+    for (const char* p = shard.begin; p < shard.end;) {
+      if (!Typeable(*p)) {
+        ++stats->chars;
+        ++stats->untypeable;
+        start = Start();
+        ++p;
+        continue;
+      }
+      const char* q = p;
+      while (q < shard.end && q - p < kMaxSegment && Typeable(*q)) { ++q; }
+      start = RunSegment(shard.begin, p, static_cast<int>(q - p), start, &ws,
+                         stats);
+      p = q;
+    }
+  }
+
+ private:
+  struct Node {
+    Node() { std::fill(std::begin(children), std::end(children), -1); }
+    int16_t children[128];
+    int16_t rule = -1;
+  };
+
+  struct Workspace {
+    std::vector<State> states;
+    std::vector<int16_t> magic_rules;  // Magic rule at each position.
+    std::vector<int32_t> caps_word_ends;  // End of Caps Word run, or -1.
+    std::vector<int32_t> path;
+  };
+
+  static State Start() {
+    State state;
+    state.cost = 0.0;
+    return state;
+  }
+
+  bool IsLeft(int key) const {
+    return keymap_.position(key).finger <= kLeftThumb;
+  }
+
+  bool Typeable(char c) const {
+    return static_cast<unsigned char>(c) < 128 && typeable_[static_cast<int>(c)];
+  }
+
+  // Looks up the Magic key rule after the text before `p`, or -1.
+  int Lookup(const char* begin, const char* p) const {
+    if (nodes_.empty()) { return -1; }
+    int node = 0;
+    int rule = -1;
+    for (const char* q = p - 1; q >= begin && p - q <= max_context_; --q) {
+      if (!Typeable(*q)) { break; }
+      const char token = tokens_[static_cast<int>(*q)];
+      int child = nodes_[node].children[static_cast<int>(token)];
+      // A rule with a lowercase letter also matches it typed with Shift.
+      if (child < 0 && std::isupper(token)) {
+        child = nodes_[node].children[std::tolower(token)];
+      }
+      if (child < 0) { break; }
+      node = child;
+      if (nodes_[node].rule >= 0) { rule = nodes_[node].rule; }
+    }
+    return rule;
+  }
+
+  // Presses and releases `key`, or holds it if `mod`.
+  void Press(State* s, int key, bool mod, Stats* stats) const {
+    s->cost += 1.0;
+    const int finger = (key >= 0) ? keymap_.position(key).finger : -1;
+    if (!mod && s->last_key >= 0) {
+      const bool sfb = s->last_key != key &&
+                       keymap_.position(s->last_key).finger == finger;
+      if (sfb) { s->cost += sfb_weight_; }
+      if (stats) {
+        ++stats->taps;
+        stats->sfbs += sfb;
+      }
+    }
+    if (!mod) { s->last_key = static_cast<int8_t>(key); }
+    if (stats) {
+      ++stats->presses;
+      if (finger >= 0) { ++stats->finger[finger]; }
+    }
+  }
+
+  // Taps `stroke`, holding a layer key and Shift as needed.
+  void Tap(State* s, const Keymap::Stroke& stroke, Stats* stats) const {
+    if (stroke.layer_key != s->layer_key) {
+      s->layer_key = static_cast<int8_t>(stroke.layer_key);
+      if (stroke.layer_key >= 0) {
+        Press(s, stroke.layer_key, true, stats);
+        if (stats) { ++stats->layer_presses; }
+      }
+    }
+    const int shift_key = stroke.shift ? shift_for_key_[stroke.key] : -1;
+    if (!stroke.shift || shift_key != s->shift_key || shift_key < 0) {
+      s->shift_key = static_cast<int8_t>(shift_key);
+      if (stroke.shift) {
+        Press(s, shift_key, true, stats);
+        if (stats) { ++stats->shift_presses; }
+      }
+    }
+    Press(s, stroke.key, false, stats);
+  }
+
+  // Taps base layer `key`, releasing any layer key and Shift.
+  void TapKey(State* s, int key, Stats* stats) const {
+    Keymap::Stroke stroke;
+    stroke.key = key;
+    stroke.layer = layer_;
+    Tap(s, stroke, stats);
+  }
+
+  // Types the text at position `i` of the segment as `kind`, from state `s`.
+  // Returns the end position, or -1 if `kind` can't type the text here.
+  int Step(const char* text, int i, int n, Kind kind, const Workspace& ws,
+           State* s, Stats* stats) const {
+    const int c = text[i];
+    const int magic_rule = s->magic_rule;
+    s->magic_rule = -1;
+    switch (kind) {
+      case kTyped:
+        Tap(s, strokes_[c], stats);
+        s->repeat = repeats_[c];
+        return i + 1;
+
+      case kRepeated:
+        if (repeat_key_ < 0 || s->repeat != c) { return -1; }
+        TapKey(s, repeat_key_, stats);
+        if (stats) { ++stats->repeat_hits; }
+        return i + 1;
+
+      case kMagicChar:
+      case kMagicString: {
+        const int r = (magic_rule >= 0) ? magic_rule : ws.magic_rules[i];
+        if (magic_key_ < 0 || r < 0) { return -1; }
+        const std::string& out = rules_[r].text;
+        if (out.empty() || (out.size() == 1) != (kind == kMagicChar) ||
+            static_cast<int>(out.size()) > n - i ||
+            std::memcmp(text + i, out.data(), out.size()) != 0) {
+          return -1;
+        }
+        TapKey(s, magic_key_, stats);
+        s->repeat = rules_[r].repeat;
+        if (kind == kMagicChar) {
+          s->magic_rule = magic_after_[std::tolower(out[0]) & 0x7f];
+        }
+        if (stats) {
+          ++stats->magic_hits;
+          stats->magic_chars += out.size();
+          ++stats->rule_hits[r];
+        }
+        return i + static_cast<int>(out.size());
+      }
+
+      case kCapsWord: {
+        const int end = ws.caps_word_ends[i];
+        if (end < 0) { return -1; }
+        TapKey(s, caps_word_key_, stats);  // Double tap Shift.
+        TapKey(s, caps_word_key_, stats);
+        for (int j = i; j < end; ++j) {
+          Tap(s, caps_word_strokes_[static_cast<int>(text[j])], stats);
+        }
+        s->repeat = text[end - 1];
+        if (stats) {
+          ++stats->caps_words;
+          stats->caps_word_chars += end - i;
+        }
+        return end;
+      }
+
+      default:
+        return -1;
+    }
+  }
+
+  // Finds where a Caps Word run starting at each position of the segment
+  // ends, or -1. A run starts at the beginning of a word, contains a capital
+  // and ends before a char that isn't a letter and turns Caps Word off.
+  void FindCapsWords(const char* text, int n, Workspace* ws) const {
+    ws->caps_word_ends.assign(n, -1);
+    if (caps_word_key_ < 0) { return; }
+    auto continues = [&](char c) {
+      return Typeable(c) && caps_word_[static_cast<int>(c)] &&
+             !std::islower(static_cast<unsigned char>(c));
+    };
+    for (int i = 0; i < n;) {
+      if (!continues(text[i])) {
+        ++i;
+        continue;
+      }
+      int end = i;
+      bool capital = false;
+      while (end < n && continues(text[end])) {
+        capital |= std::isupper(static_cast<unsigned char>(text[end])) != 0;
+        ++end;
+      }
+      if (capital && (end == n || !std::isalpha(static_cast<unsigned char>(
+                                       text[end])))) {
+        ws->caps_word_ends[i] = end;
+      }
+      i = end;
+    }
+  }
+
+  // Simulates typing the `n` typeable chars at `text`, from state `start`.
+  // Returns the state at the end.
+  State RunSegment(const char* begin, const char* text, int n, State start,
+                   Workspace* ws, Stats* stats) const {
+    ws->states.assign(static_cast<size_t>(n + 1) * kNumKinds, State());
+    ws->magic_rules.resize(n);
+    for (int i = 0; i < n; ++i) { ws->magic_rules[i] = Lookup(begin, text + i); }
+    FindCapsWords(text, n, ws);
+
+    start.prev = -1;
+    ws->states[kTyped] = start;
+    for (int i = 0; i < n; ++i) {
+      for (int from_kind = 0; from_kind < kNumKinds; ++from_kind) {
+        const int from = i * kNumKinds + from_kind;
+        if (!(ws->states[from].cost < std::numeric_limits<double>::infinity())) {
+          continue;
+        }
+        for (int kind = 0; kind < kNumKinds; ++kind) {
+          State s = ws->states[from];
+          const int end = Step(text, i, n, static_cast<Kind>(kind), *ws, &s,
+                               nullptr);
+          if (end < 0) { continue; }
+          State& to = ws->states[end * kNumKinds + kind];
+          if (s.cost < to.cost) {
+            to = s;
+            to.prev = from;
+          }
+        }
+      }
+    }
+
+    // Trace back the cheapest path, then replay it to collect stats.
+    int best = n * kNumKinds;
+    for (int kind = 1; kind < kNumKinds; ++kind) {
+      if (ws->states[n * kNumKinds + kind].cost < ws->states[best].cost) {
+        best = n * kNumKinds + kind;
+      }
+    }
+    ws->path.clear();
+    for (int index = best; index >= 0; index = ws->states[index].prev) {
+      ws->path.push_back(index);
+    }
+    State s = start;
+    for (size_t j = ws->path.size() - 1; j > 0; --j) {
+      const int i = ws->path[j] / kNumKinds;
+      const Kind kind = static_cast<Kind>(ws->path[j - 1] % kNumKinds);
+      Step(text, i, n, kind, *ws, &s, stats);
+    }
+    stats->chars += n;
+    s.cost = 0.0;
+    return s;
+  }
+
+  const Keymap& keymap_;
+  const int layer_;
+  const int magic_key_;
+  const int repeat_key_;
+  const double sfb_weight_;
+  int caps_word_key_ = -1;
+  std::vector<int> shift_for_key_;
+  bool typeable_[128] = {};
+  Keymap::Stroke strokes_[128];
+  char tokens_[128] = {};
+  char repeats_[128] = {};
+  bool caps_word_[128] = {};
+  Keymap::Stroke caps_word_strokes_[128];
+  std::vector<Node> nodes_;
+  std::vector<MagicRule> rules_;
+  int16_t magic_after_[128];  // Rule for "\m" + char, or -1.
+  int max_context_ = 0;
+};
+
+// Finds the key on `layer` given as an index or a keycode, or returns -1.
+int FindKeyArg(const Keymap& keymap, int layer, const std::string& arg) {
+  if (!arg.empty() && std::all_of(arg.begin(), arg.end(), ::isdigit)) {
+    const int key = std::atoi(arg.c_str());
+    return (key < keymap.num_keys()) ? key : -1;
+  }
+  const std::string expr = keymap.ParseKeycode(arg).expr;
+  for (int key = 0; key < keymap.num_keys(); ++key) {
+    if (keymap.keycode(layer, key).expr == expr) { return key; }
+  }
+  return -1;
+}
+
+int Main(int argc, char** argv) {
+  std::string keymap_file = "keyboards/zsa/voyager/keymaps/getreuer/keymap.c";
+  std::string dict_file = "features/magic_key_dict.txt";
+  std::string layer_name;
+  std::string magic_key_arg;
+  std::string repeat_key_arg;
+  std::vector<std::string> swaps;
+  double sfb_weight = 1.0;
+  int num_threads = DefaultNumThreads();
+  std::vector<std::string> input_file_names;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string name, value;
+    if (!ParseOption(argv[i], &name, &value)) {
+      input_file_names.push_back(argv[i]);
+    } else if (name == "--keymap") {
+      keymap_file = value;
+    } else if (name == "--layer") {
+      layer_name = value;
+    } else if (name == "--dict") {
+      dict_file = value;
+    } else if (name == "--magic_key") {
+      magic_key_arg = value;
+    } else if (name == "--repeat_key") {
+      repeat_key_arg = value;
+    } else if (name == "--swap") {
+      swaps.push_back(value);
+    } else if (name == "--sfb_weight") {
+      sfb_weight = std::atof(value.c_str());
+    } else if (name == "--threads") {
+      num_threads = std::max(1, std::atoi(value.c_str()));
+    } else {
+      std::printf("Invalid option: %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  if (input_file_names.empty()) {  // No input given; show help text and exit.
+    std::printf("%s", kHelpText);
+    return 1;
+  }
+
+  Keymap keymap;
+  std::string error;
+  if (!keymap.Load(keymap_file, &error)) {
+    std::printf("Error: %s\n", error.c_str());
+    return 1;
+  }
+  const int layer = layer_name.empty() ? 0 : keymap.FindLayer(layer_name);
+  if (layer < 0) {
+    std::printf("Error: No layer %s in %s\n", layer_name.c_str(),
+                keymap_file.c_str());
+    return 1;
+  }
+
+  for (const std::string& swap : swaps) {
+    const size_t comma = swap.find(',');
+    const int a = FindKeyArg(keymap, layer, swap.substr(0, comma));
+    const int b = (comma == std::string::npos)
+                      ? -1 : FindKeyArg(keymap, layer, swap.substr(comma + 1));
+    if (a < 0 || b < 0) {
+      std::printf("Error: Invalid --swap=%s\n", swap.c_str());
+      return 1;
+    }
+    keymap.SwapKeys(layer, a, b);
+  }
+
+  // Place the Magic and Repeat keys, replacing whatever the keys were. A
+  // keymap may reach them from a layer, a combo or a macro rather than from a
+  // base layer key, which the simulation doesn't follow, so without the key on
+  // the layer, it must be given.
+  auto place_key = [&](const std::string& arg, const char* keycode,
+                       const char* option, int* key) {
+    if (arg == "none") {
+      *key = -1;
+      return true;
+    }
+    *key = arg.empty() ? keymap.FindKey(layer, keycode)
+                       : FindKeyArg(keymap, layer, arg);
+    if (*key < 0) {
+      if (arg.empty()) {
+        std::printf("Error: Layer %s has no %s key. Give a keycode on the "
+                    "layer or a key index with %s=KEY, or %s=none to "
+                    "simulate without it.\n", keymap.layer_name(layer).c_str(),
+                    keycode, option, option);
+      } else {
+        std::printf("Error: Invalid %s=%s\n", option, arg.c_str());
+      }
+      return false;
+    }
+    keymap.SetKeycode(layer, *key, keymap.ParseKeycode(keycode));
+    return true;
+  };
+  int magic_key = -1;
+  int repeat_key = -1;
+  if (!place_key(magic_key_arg, "QK_AREP", "--magic_key", &magic_key) ||
+      !place_key(repeat_key_arg, "QK_REP", "--repeat_key", &repeat_key)) {
+    return 1;
+  }
+
+  Simulator simulator(keymap, layer, magic_key, repeat_key, sfb_weight);
+  if (!dict_file.empty() && !simulator.LoadRules(dict_file, &error)) {
+    std::printf("Error: %s\n", error.c_str());
+    return 1;
+  }
+
+  const auto start_time = std::chrono::steady_clock::now();
+  std::vector<Stats> stats(num_threads, Stats(simulator.rules().size()));
+  ForEachShard(input_file_names, num_threads,
+               [&](const Shard& shard, int thread) {
+                 simulator.Run(shard, &stats[thread]);
+               });
+  for (int thread = 1; thread < num_threads; ++thread) {
+    stats[0].Merge(stats[thread]);
+  }
+  const double seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start_time).count();
+  const Stats& total = stats[0];
+
+  auto percent = [](uint64_t part, uint64_t whole) {
+    return whole ? (100.0 * part) / whole : 0.0;
+  };
+  const uint64_t typed = total.chars - total.untypeable;
+  std::printf("Typing simulation, base layer %s\n",
+              keymap.layer_name(layer).c_str());
+  std::printf("Magic key: %s, Repeat Key: %s, Caps Word: %s\n\n",
+              (magic_key >= 0) ? std::to_string(magic_key).c_str() : "none",
+              (repeat_key >= 0) ? std::to_string(repeat_key).c_str() : "none",
+              simulator.has_caps_word() ? "double tap Shift" : "none");
+  std::printf("chars:                  %12llu\n",
+              static_cast<unsigned long long>(total.chars));
+  std::printf("untypeable chars:       %8.3f%%\n",
+              percent(total.untypeable, total.chars));
+  std::printf("keystrokes per char:    %8.3f\n",
+              typed ? static_cast<double>(total.presses) / typed : 0.0);
+  std::printf("same-finger bigrams:    %8.3f%%\n",
+              percent(total.sfbs, total.taps));
+  std::printf("layer key presses:      %8.3f%% of chars\n",
+              percent(total.layer_presses, typed));
+  std::printf("Shift presses:          %8.3f%% of chars\n",
+              percent(total.shift_presses, typed));
+  std::printf("Repeat Key:             %8.3f%% of chars\n",
+              percent(total.repeat_hits, typed));
+  std::printf("Magic key:              %8.3f%% of chars, %.3f%% of presses\n",
+              percent(total.magic_chars, typed),
+              percent(total.magic_hits, total.presses));
+  std::printf("Caps Word:              %8.3f%% of chars, %llu words\n\n",
+              percent(total.caps_word_chars, typed),
+              static_cast<unsigned long long>(total.caps_words));
+
+  std::printf("Finger       presses        %%\n");
+  for (int f = 0; f < kNumFingers; ++f) {
+    std::printf("%-10s %9llu %8.3f\n", FingerName(f),
+                static_cast<unsigned long long>(total.finger[f]),
+                percent(total.finger[f], total.presses));
+  }
+
+  std::vector<size_t> order;
+  for (size_t i = 0; i < simulator.rules().size(); ++i) {
+    if (total.rule_hits[i]) { order.push_back(i); }
+  }
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return total.rule_hits[a] > total.rule_hits[b];
+  });
+  if (!order.empty()) {
+    std::printf("\ncontext  output           hits   %% of Magic\n");
+    for (size_t i : order) {
+      const MagicRule& rule = simulator.rules()[i];
+      std::string context;
+      for (char c : rule.context) {
+        context += (c == ' ') ? "\\s" : (c == '\n') ? "\\n"
+                 : (c == '\t') ? "\\t" : (c == kMagicKeyChar) ? "\\m"
+                 : std::string(1, c);
+      }
+      std::printf("%-8s %-13s %8llu %8.3f\n", context.c_str(),
+                  rule.output.c_str(),
+                  static_cast<unsigned long long>(total.rule_hits[i]),
+                  percent(total.rule_hits[i], total.magic_hits));
+    }
+  }
+
+  std::printf("\nSimulated in %.2f s, %.1f M chars/s\n", seconds,
+              seconds > 0.0 ? total.chars / seconds * 1e-6 : 0.0);
+  return 0;
+}
+
+}  // namespace
+}  // namespace keystats
+
+int main(int argc, char** argv) { return keystats::Main(argc, argv); }
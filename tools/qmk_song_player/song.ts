@@ -66,8 +66,8 @@ export class SongPlayer {
     this.overallGain.gain.value = 0.0;
     this.overallGain.connect(this.lowpass);
     this.lowpass.type = "lowpass";
-    this.lowpass.frequency.value = 2000.0;
-    this.lowpass.Q.value = 0.7;
+    this.lowpass.frequency.value = SongPlayer.LOWPASS_HZ;
+    this.lowpass.Q.value = SongPlayer.LOWPASS_Q_DB;
     this.lowpass.connect(this.context.destination);
 
     this.oscillator.start();
@@ -79,21 +79,25 @@ export class SongPlayer {
     this.stopTrackTimeout();
     this.playbackActive = true;
     // Schedule playback to begin 20 ms from now.
-    let t = this.context.currentTime + 0.02;
+    const start = this.context.currentTime + 0.02;
+    let t = start;
     this.overallGain.gain.cancelScheduledValues(t);
     this.noteEnvelope.gain.cancelScheduledValues(t);
     this.oscillator.frequency.cancelScheduledValues(t);
     this.noteEnvelope.gain.setValueAtTime(0.0, t);
     this.overallGain.gain.linearRampToValueAtTime(0.0, t);
-    this.overallGain.gain.linearRampToValueAtTime(this.gain, t + 0.005);
+    this.overallGain.gain.linearRampToValueAtTime(
+      this.gain, t + SongPlayer.FADE_IN_S);
 
-    let noteStartTimes: number[] = [t];
+    const noteStartTimes = playerSchedule(song, this.tempo).map(
+      (s) => start + s);
     const bpmToSeconds = 60.0 / (64 * this.tempo);
 
     for (let i = 0; i < song.notes.length; i++) {
       // Schedule playback of the ith note.
       const f = song.notes[i].frequency;
       const d = bpmToSeconds * song.notes[i].duration;
+      t = noteStartTimes[i];
       this.noteEnvelope.gain.setValueAtTime(0.0, t);
 
       if (f > 0.0) {
@@ -105,11 +109,9 @@ export class SongPlayer {
         this.noteEnvelope.gain.linearRampToValueAtTime(
           0.0, t + d - SongPlayer.NOTE_GAP_S);
       }
-
-      t += d;
-      noteStartTimes.push(t);
     }
-    this.overallGain.gain.setValueAtTime(0.0, t);
+    this.overallGain.gain.setValueAtTime(
+      0.0, noteStartTimes[song.notes.length]);
 
     let noteIndex = 0;
     this.trackTimeout = setInterval(() => {
@@ -158,9 +160,153 @@ export class SongPlayer {
   }
 
   static readonly DEFAULT_TEMPO_BPM = 120;
-  private static readonly NOTE_ATTACK_S = 0.003;
-  private static readonly NOTE_RELEASE_S = 0.003;
-  private static readonly NOTE_GAP_S = 0.0018;
+  static readonly NOTE_ATTACK_S = 0.003;
+  static readonly NOTE_RELEASE_S = 0.003;
+  static readonly NOTE_GAP_S = 0.0018;
+  static readonly FADE_IN_S = 0.005;
+  static readonly LOWPASS_HZ = 2000.0;
+  static readonly LOWPASS_Q_DB = 0.7;
+}
+
+/**
+ * Times in s at which `SongPlayer` starts each note of `song`, relative to the
+ * start of playback, followed by the end of the song. As in the player, the
+ * note durations are accumulated in floating point seconds.
+ */
+export function playerSchedule(song: Song, tempo: number): number[] {
+  const bpmToSeconds = 60.0 / (64 * tempo);
+  let t = 0.0;
+  let times: number[] = [t];
+  for (const note of song.notes) {
+    t += bpmToSeconds * note.duration;
+    times.push(t);
+  }
+  return times;
+}
+
+/** Result of `renderSong()`. */
+export type Rendering = {
+  /** Rendered audio, mono, in [-1, 1]. */
+  samples: Float32Array;
+  sampleRate: number;
+  /** Sample index where each note begins. */
+  onsets: number[];
+  /**
+   * Largest difference, in s, between a note's onset and its start time in
+   * `playerSchedule()`, where `SongPlayer` plays it.
+   */
+  maxOnsetErrorS: number;
+};
+
+/**
+ * Renders a `Song` offline, without Web Audio, e.g. for tests.
+ *
+ * This follows the model of `SongPlayer`: a square wave oscillator, the note
+ * envelope with the same attack, release, and gap, the overall gain fade-in,
+ * and a lowpass biquad with the coefficients Web Audio uses. Unlike Web Audio,
+ * the square wave is not bandlimited, and the rendering begins right away
+ * rather than 20 ms later.
+ *
+ * Note onsets are computed from the running duration in whole 1/64th beats,
+ * so that rounding does not accumulate over a long song. Each onset is checked
+ * against the schedule `SongPlayer` plays, from `playerSchedule()`, and the
+ * largest difference is returned as `maxOnsetErrorS`.
+ */
+export function renderSong(song: Song,
+                           tempo: number = SongPlayer.DEFAULT_TEMPO_BPM,
+                           sampleRate: number = 44100,
+                           gain: number = 0.25): Rendering {
+  const bpmToSeconds = 60.0 / (64 * tempo);
+  const schedule = playerSchedule(song, tempo);
+  let onsets: number[] = [];
+  let maxOnsetErrorS = 0.0;
+  let ticks = 0;
+  for (let i = 0; i <= song.notes.length; i++) {
+    const onset = Math.round(ticks * bpmToSeconds * sampleRate);
+    maxOnsetErrorS = Math.max(maxOnsetErrorS,
+                              Math.abs(onset / sampleRate - schedule[i]));
+    onsets.push(onset);
+    if (i < song.notes.length) { ticks += song.notes[i].duration; }
+  }
+  const numSamples = onsets.pop() as number;
+  let samples = new Float32Array(numSamples);
+
+  // Lowpass biquad, per the Web Audio spec for BiquadFilterNode "lowpass".
+  const w0 = 2 * Math.PI * SongPlayer.LOWPASS_HZ / sampleRate;
+  const alpha =
+    Math.sin(w0) / (2 * Math.pow(10, SongPlayer.LOWPASS_Q_DB / 20));
+  const cosW0 = Math.cos(w0);
+  const a0 = 1 + alpha;
+  const b0 = (1 - cosW0) / (2 * a0);
+  const b1 = (1 - cosW0) / a0;
+  const a1 = -2 * cosW0 / a0;
+  const a2 = (1 - alpha) / a0;
+  let x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+
+  const fadeInSamples = SongPlayer.FADE_IN_S * sampleRate;
+  let phase = 0.0;
+  for (let i = 0; i < song.notes.length; i++) {
+    const f = song.notes[i].frequency;
+    const start = onsets[i];
+    const end = (i + 1 < onsets.length) ? onsets[i + 1] : numSamples;
+    const d = song.notes[i].duration * bpmToSeconds;
+    const phaseStep = f / sampleRate;
+
+    for (let n = start; n < end; n++) {
+      // Note envelope, rising over the attack and falling over the release,
+      // ending a gap before the next note.
+      let env = 0.0;
+      if (f > 0.0) {
+        const t = (n - start) / sampleRate;
+        env = Math.max(0.0, Math.min(
+          t / SongPlayer.NOTE_ATTACK_S, 1.0,
+          (d - SongPlayer.NOTE_GAP_S - t) / SongPlayer.NOTE_RELEASE_S));
+      }
+      const x = ((phase < 0.5) ? 1.0 : -1.0) * env *
+        gain * Math.min(n / fadeInSamples, 1.0);
+      phase += phaseStep;
+      phase -= Math.floor(phase);
+
+      const y = b0 * x + b1 * x1 + b0 * x2 - a1 * y1 - a2 * y2;
+      x2 = x1; x1 = x;
+      y2 = y1; y1 = y;
+      samples[n] = y;
+    }
+  }
+
+  return {samples: samples, sampleRate: sampleRate, onsets: onsets,
+          maxOnsetErrorS: maxOnsetErrorS};
+}
+
+/** Encodes audio samples in [-1, 1] as a mono 16-bit PCM WAV file. */
+export function encodeWav(samples: Float32Array,
+                          sampleRate: number): Uint8Array {
+  let bytes = new Uint8Array(44 + 2 * samples.length);
+  let view = new DataView(bytes.buffer);
+  const writeString = (offset: number, s: string) => {
+    for (let i = 0; i < s.length; i++) {
+      view.setUint8(offset + i, s.charCodeAt(i));
+    }
+  };
+
+  writeString(0, "RIFF");
+  view.setUint32(4, 36 + 2 * samples.length, true);
+  writeString(8, "WAVE");
+  writeString(12, "fmt ");
+  view.setUint32(16, 16, true);  // Size of the fmt chunk.
+  view.setUint16(20, 1, true);  // PCM.
+  view.setUint16(22, 1, true);  // Mono.
+  view.setUint32(24, sampleRate, true);
+  view.setUint32(28, 2 * sampleRate, true);  // Bytes per second.
+  view.setUint16(32, 2, true);  // Bytes per frame.
+  view.setUint16(34, 16, true);  // Bits per sample.
+  writeString(36, "data");
+  view.setUint32(40, 2 * samples.length, true);
+  for (let i = 0; i < samples.length; i++) {
+    const x = Math.max(-1.0, Math.min(samples[i], 1.0));
+    view.setInt16(44 + 2 * i, Math.round(32767 * x), true);
+  }
+  return bytes;
 }
 
 function isSpaceChar(c: string): boolean {
@@ -178,6 +324,22 @@ function findNextNonSpaceChar(s: string, start: number): number {
 }
 
 
+/** Pitch byte of a rest in the compact song encoding. */
+export const COMPACT_REST = 108;
+/** Pitch byte of a tie in the compact song encoding. */
+export const COMPACT_TIE = 109;
+/** Pitch bytes of repeats in the compact song encoding, plus the count. */
+export const COMPACT_REPEAT = 128;
+
+/**
+ * Converts a note duration in 1/64th beats to ms as QMK's
+ * `audio_duration_to_ms()` does with integer math, truncating `float`
+ * durations to `uint16_t` on the way in.
+ */
+export function durationToMs(duration: number, tempo: number): number {
+  return Math.floor((Math.trunc(duration) * 60 * 1000) / (64 * tempo));
+}
+
 /** `Song` represents a song with an array of `Notes`. */
 export class Song {
   notes: Note[] = [];
@@ -332,6 +494,138 @@ export class Song {
     return s;
   }
 
+  /**
+   * Encodes the Song in the compact format played by features/song_stream.c,
+   * as 2-byte events:
+   *
+   *  * note: [pitch, duration], pitch being the note index 0-107, or
+   *    COMPACT_REST for a rest.
+   *  * tie: [COMPACT_TIE, duration], lengthening the previous note or rest,
+   *    for durations over 255.
+   *  * repeat: [COMPACT_REPEAT + times, events], playing the previous `events`
+   *    events `times` more times.
+   *
+   * Durations are truncated to whole 1/64th beats, as QMK does when playing a
+   * `float` song. Repeated passages are found greedily, taking at each note
+   * the repeat that saves the most bytes.
+   */
+  compact(): number[] {
+    // Encode each note as a note event followed by any ties.
+    let units: number[][] = [];
+    for (let i = 0; i < this.notes.length; i++) {
+      const note = this.notes[i];
+      const pitch = (note.frequency > 0.0)
+        ? Math.min(Math.max(Note.hzToIndex(note.frequency), 0), 107)
+        : COMPACT_REST;
+      let remaining = Math.trunc(note.duration);
+      let unit = [pitch, Math.min(remaining, 255)];
+      remaining -= unit[1];
+      while (remaining > 0) {
+        const d = Math.min(remaining, 255);
+        unit.push(COMPACT_TIE, d);
+        remaining -= d;
+      }
+      units.push(unit);
+    }
+
+    const unitsEqual = (a: number, b: number): boolean => (
+      units[a].length == units[b].length &&
+      units[a].every((x, j) => x == units[b][j])
+    );
+
+    let bytes: number[] = [];
+    for (let i = 0; i < units.length;) {
+      // Find the passage of `period` notes starting at i that repeats the
+      // most bytes right after itself.
+      let best = {period: 0, times: 0, events: 0, saved: 0};
+      let events = 0;
+      for (let period = 1; 2 * period <= units.length - i; period++) {
+        events += units[i + period - 1].length / 2;
+        if (events > 255) { break; }
+        let times = 0;
+        while (times < 127 && i + (times + 2) * period <= units.length) {
+          let j = 0;
+          while (j < period &&
+                 unitsEqual(i + j, i + (times + 1) * period + j)) {
+            j++;
+          }
+          if (j < period) { break; }
+          times++;
+        }
+        const saved = 2 * events * times - 2;
+        if (saved > best.saved) {
+          best = {period: period, times: times, events: events, saved: saved};
+        }
+      }
+
+      if (best.saved > 0) {
+        for (let j = 0; j < best.period; j++) {
+          bytes.push(...units[i + j]);
+        }
+        bytes.push(COMPACT_REPEAT + best.times, best.events);
+        i += best.period * (best.times + 1);
+      } else {
+        bytes.push(...units[i]);
+        i++;
+      }
+    }
+    return bytes;
+  }
+
+  /** Formats the compact encoding as a C PROGMEM array. */
+  compactCode(): string {
+    const bytes = this.compact();
+    const name = (this.name || "song").toLowerCase();
+    let s = `// ${this.notes.length} notes in ${bytes.length} bytes ` +
+      `(${this.notes.length * 8} bytes as SONG(...)).\n` +
+      `static const uint8_t ${name}[] PROGMEM = {\n`;
+    for (let i = 0; i < bytes.length; i += 12) {
+      s += "    " + bytes.slice(i, i + 12).join(", ") + ",\n";
+    }
+    return s + "};\n";
+  }
+
+  /**
+   * Decodes the compact encoding into the sequence of notes it plays, as
+   * [pitch, duration] pairs. This follows features/song_stream.c step for
+   * step, expanding repeats and adding up ties.
+   */
+  static playCompact(bytes: number[]): number[][] {
+    let played: number[][] = [];
+    let pos = 0;
+    let repeatPos = -1;
+    let repeatsLeft = 0;
+    while (pos + 1 < bytes.length) {
+      const op = bytes[pos];
+      const arg = bytes[pos + 1];
+
+      if (op >= COMPACT_REPEAT) {
+        if (repeatPos != pos) {  // Start of a repeat.
+          repeatPos = pos;
+          repeatsLeft = op - COMPACT_REPEAT;
+        }
+        if (repeatsLeft > 0) {
+          repeatsLeft--;
+          pos -= 2 * arg;
+        } else {
+          repeatPos = -1;
+          pos += 2;
+        }
+        continue;
+      }
+
+      pos += 2;
+      if (op == COMPACT_TIE) { continue; }
+      let duration = arg;
+      while (pos + 1 < bytes.length && bytes[pos] == COMPACT_TIE) {
+        duration += bytes[pos + 1];
+        pos += 2;
+      }
+      played.push([op, duration]);
+    }
+    return played;
+  }
+
   /** Encodes a song name to bytes. */
   private static encodeName(s: string): number[] {
     if (s.length > Song.MAX_SONG_NAME_LEN) {
@@ -388,7 +682,7 @@ export class Song {
 }
 
 /** `Note` represents a single note, having a frequency and a duration. */
-class Note {
+export class Note {
   /** Pitch frequency in Hz. */
   frequency: number;
   /** Duration in 1/64ths of a beat. */
@@ -1,4 +1,7 @@
-import { Song } from "./song";
+import {
+  COMPACT_REPEAT, COMPACT_REST, COMPACT_TIE, Note, Song, durationToMs,
+  encodeWav, playerSchedule, renderSong
+} from "./song";
 
 const TEST_SONG_CODE = (
   "#define TEST_SONG Q__NOTE(_C0), W__NOTE(_REST), M__NOTE(_CS3, 13)"
@@ -31,3 +34,146 @@ test("song binary round trip", () => {
   expect(recoveredCode).toEqual(TEST_SONG_CODE);
 });
 
+
+// A song with repeated passages and long tied notes.
+const REPEATING_SONG_CODE = (
+  "#define REPEATING_SONG " +
+  "E__NOTE(_E4), E__NOTE(_G4), E__NOTE(_E4), E__NOTE(_G4), " +
+  "E__NOTE(_E4), E__NOTE(_G4), S__NOTE(_REST), M__NOTE(_A4, 600), " +
+  "Q__NOTE(_C5), Q__NOTE(_C5), Q__NOTE(_C5), M__NOTE(_B3, 300), " +
+  "E__NOTE(_E4), E__NOTE(_G4)"
+);
+
+/**
+ * Timeline of a `float` song as QMK plays it: [note index, start ms, ms] for
+ * each note, with rests as COMPACT_REST.
+ */
+function floatTimeline(song: Song, tempo: number): number[][] {
+  let timeline = [];
+  let t = 0;
+  for (const note of song.notes) {
+    const pitch =
+      (note.frequency > 0.0) ? Note.hzToIndex(note.frequency) : COMPACT_REST;
+    const ms = durationToMs(note.duration, tempo);
+    timeline.push([pitch, t, ms]);
+    t += ms;
+  }
+  return timeline;
+}
+
+/** Timeline of a compact song as features/song_stream.c plays it. */
+function compactTimeline(bytes: number[], tempo: number): number[][] {
+  let timeline = [];
+  let t = 0;
+  for (const [pitch, duration] of Song.playCompact(bytes)) {
+    const ms = durationToMs(duration, tempo);
+    timeline.push([pitch, t, ms]);
+    t += ms;
+  }
+  return timeline;
+}
+
+// Test that the compact encoding plays with timing identical to the float song.
+test("compact song timing matches float song", () => {
+  for (const code of [TEST_SONG_CODE, REPEATING_SONG_CODE]) {
+    const song = new Song(code);
+    const bytes = song.compact();
+    for (const tempo of [120, 97, 255]) {
+      expect(compactTimeline(bytes, tempo)).toEqual(floatTimeline(song, tempo));
+    }
+  }
+});
+
+// Test the compact encoding of the repeating song, event by event.
+test("compact song encoding", () => {
+  const bytes = new Song(REPEATING_SONG_CODE).compact();
+  const E4 = 52, G4 = 55, A4 = 57, C5 = 60, B3 = 47;
+
+  expect(bytes).toEqual([
+    E4, 8, G4, 8, COMPACT_REPEAT + 2, 2,  // E4, G4, played 3 times.
+    COMPACT_REST, 4,
+    A4, 255, COMPACT_TIE, 255, COMPACT_TIE, 90,  // 600 = 255 + 255 + 90.
+    C5, 16, COMPACT_REPEAT + 2, 1,
+    B3, 255, COMPACT_TIE, 45,
+    E4, 8, G4, 8,
+  ]);
+  expect(bytes.every((b) => 0 <= b && b <= 255)).toBe(true);
+});
+
+/** RMS of `samples` over [start, end). */
+function rms(samples: Float32Array, start: number, end: number): number {
+  let sum = 0.0;
+  for (let i = start; i < end; i++) {
+    sum += samples[i] * samples[i];
+  }
+  return Math.sqrt(sum / (end - start));
+}
+
+// Audio regression test of rendering TEST_SONG_CODE.
+test("render song", () => {
+  const song = new Song(TEST_SONG_CODE);
+  const rendering = renderSong(song, 120, 8000);
+  const samples = rendering.samples;
+
+  // 16 + 64 + 13 = 93 1/64th beats at 120 bpm is 0.7265625 s.
+  expect(samples.length).toBe(5813);
+  expect(rendering.onsets).toEqual([0, 1000, 5000]);
+  expect(rms(samples, 0, 1000)).toBeCloseTo(0.242681, 5);
+  expect(rms(samples, 1000, 5000)).toBeCloseTo(0.0, 5);  // Rest.
+  expect(rms(samples, 5000, 5813)).toBeCloseTo(0.243374, 5);
+  expect(samples[10]).toBeCloseTo(0.023620, 5);  // Fading in.
+  expect(samples[500]).toBeCloseTo(0.252240, 5);
+  expect(samples[999]).toBeCloseTo(0.0, 4);  // Gap before the rest.
+  expect(samples[5100]).toBeCloseTo(-0.249988, 5);
+  expect(samples[5400]).toBeCloseTo(-0.250000, 5);
+
+  const wav = encodeWav(samples, rendering.sampleRate);
+  const view = new DataView(wav.buffer);
+  expect(String.fromCharCode(...wav.slice(0, 4))).toEqual("RIFF");
+  expect(String.fromCharCode(...wav.slice(8, 16))).toEqual("WAVEfmt ");
+  expect(view.getUint32(24, true)).toBe(8000);
+  expect(view.getUint32(40, true)).toBe(2 * samples.length);
+  expect(wav.length).toBe(44 + 2 * samples.length);
+  expect(view.getInt16(44 + 2 * 500, true))
+    .toBe(Math.round(32767 * samples[500]));
+});
+
+// Test that over a long song, note onsets stay within half a sample of the
+// times SongPlayer plays them, give or take its floating point accumulation.
+test("render timing does not drift", () => {
+  const code = Array(2000).fill("E__NOTE(_A4), S__NOTE(_C5), M__NOTE(_E5, 3)");
+  const song = new Song(code.join(", "));
+
+  for (const [tempo, sampleRate] of [[120, 44100], [97, 48000], [143, 8000]]) {
+    const rendering = renderSong(song, tempo, sampleRate);
+    expect(rendering.onsets.length).toBe(song.notes.length);
+    expect(rendering.maxOnsetErrorS)
+      .toBeLessThanOrEqual(0.5 / sampleRate + 1e-9);
+    // The last onset is at 2000 * (8 + 4 + 3) - 3 1/64th beats.
+    const lastS = (2000 * 15 - 3) * 60.0 / (64 * tempo);
+    expect(rendering.onsets[rendering.onsets.length - 1])
+      .toBe(Math.round(lastS * sampleRate));
+    const schedule = playerSchedule(song, tempo);
+    expect(schedule.length).toBe(song.notes.length + 1);
+    expect(schedule[song.notes.length - 1]).toBeCloseTo(lastS, 9);
+  }
+});
+
+// Benchmark of render throughput, checking that it runs faster than real time.
+test("render throughput", () => {
+  const code = Array(500).fill("E__NOTE(_A4), S__NOTE(_C5), M__NOTE(_E5, 3)");
+  const song = new Song(code.join(", "));
+  const sampleRate = 44100;
+
+  const startMs = performance.now();
+  const rendering = renderSong(song, 120, sampleRate);
+  const elapsedS = (performance.now() - startMs) / 1000;
+
+  const audioS = rendering.samples.length / sampleRate;
+  const samplesPerS = rendering.samples.length / elapsedS;
+  console.log(`Rendered ${audioS.toFixed(1)} s of audio in ` +
+    `${(1000 * elapsedS).toFixed(1)} ms: ` +
+    `${(samplesPerS / 1e6).toFixed(2)} Msamples/s, ` +
+    `${(audioS / elapsedS).toFixed(0)}x real time.`);
+  expect(audioS / elapsedS).toBeGreaterThan(1.0);
+});